@@ -16,25 +16,50 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "rimage.h"
 #include "cse.h"
 #include "manifest.h"
 
+/* is [off, off + size) inside the mapped ELF file ? */
+static int elf_in_file(const struct module *module, uint32_t off,
+		       uint32_t size)
+{
+	uint32_t file_size = module->file_size;
+
+	return off <= file_size && size <= file_size - off;
+}
+
+/* section contents inside the ELF mapping, NULL if out of file bounds */
+const void *elf_section_data(const struct module *module,
+			     const Elf32_Shdr *section)
+{
+	if (!elf_in_file(module, section->off, section->size)) {
+		fprintf(stderr, "error: %s section 0x%x/0x%x outside file\n",
+			module->elf_file, section->off, section->size);
+		return NULL;
+	}
+
+	return module->map + section->off;
+}
+
 static int elf_read_sections(struct image *image, struct module *module)
 {
 	Elf32_Ehdr *hdr = &module->hdr;
 	Elf32_Shdr *section = module->section;
-	size_t count;
-	int i, ret;
+	size_t size = sizeof(Elf32_Shdr) * hdr->shnum;
+	int i;
 	uint32_t valid = (SHF_WRITE | SHF_ALLOC | SHF_EXECINSTR);
 	int man_section_idx;
 
-	/* read in section header */
-	ret = fseek(module->fd, hdr->shoff, SEEK_SET);
-	if (ret < 0) {
-		fprintf(stderr, "error: can't seek to %s section header %d\n",
-			module->elf_file, ret);
-		return ret;
+	/* section header must be inside the file */
+	if (!elf_in_file(module, hdr->shoff, size)) {
+		fprintf(stderr, "error: %s section header outside file\n",
+			module->elf_file);
+		return -EINVAL;
 	}
 
 	/* allocate space for each section header */
@@ -43,36 +68,19 @@ static int elf_read_sections(struct image *image, struct module *module)
 		return -ENOMEM;
 	module->section = section;
 
-	/* read in sections */
-	count = fread(section, sizeof(Elf32_Shdr), hdr->shnum, module->fd);
-	if (count != hdr->shnum) {
-		fprintf(stderr, "error: failed to read %s section header %d\n",
-			module->elf_file, -errno);
-		return -errno;
-	}
-
-	/* read in strings */
-	module->strings = calloc(1, section[hdr->shstrndx].size);
-	if (!module->strings) {
-		fprintf(stderr, "error: failed %s to read ELF strings for %d\n",
-			module->elf_file, -errno);
-			return -errno;
-	}
+	/* copy sections, the header may be unaligned in the file */
+	memcpy(section, module->map + hdr->shoff, size);
 
-	ret = fseek(module->fd, section[hdr->shstrndx].off, SEEK_SET);
-	if (ret < 0) {
-		fprintf(stderr, "error: can't seek to %s stringss %d\n",
-			module->elf_file, ret);
-		return ret;
+	/* strings are used straight from the mapping */
+	if (hdr->shstrndx >= hdr->shnum) {
+		fprintf(stderr, "error: %s has no ELF strings\n",
+			module->elf_file);
+		return -EINVAL;
 	}
 
-	count = fread(module->strings, 1, section[hdr->shstrndx].size,
-		      module->fd);
-	if (count != section[hdr->shstrndx].size) {
-		fprintf(stderr, "error: failed to read %s strings %d\n",
-			module->elf_file, -errno);
-		return -errno;
-	}
+	module->strings = elf_section_data(module, &section[hdr->shstrndx]);
+	if (!module->strings)
+		return -EINVAL;
 
 	/* find manifest module data */
 	man_section_idx = elf_find_section(image, module, ".bss");
@@ -150,15 +158,14 @@ static int elf_read_programs(struct image *image, struct module *module)
 {
 	Elf32_Ehdr *hdr = &module->hdr;
 	Elf32_Phdr *prg = module->prg;
-	size_t count;
-	int i, ret;
+	size_t size = sizeof(Elf32_Phdr) * hdr->phnum;
+	int i;
 
-	/* read in program header */
-	ret = fseek(module->fd, hdr->phoff, SEEK_SET);
-	if (ret < 0) {
-		fprintf(stderr, "error: cant seek to %s program header %d\n",
-			module->elf_file, ret);
-		return ret;
+	/* program header must be inside the file */
+	if (!elf_in_file(module, hdr->phoff, size)) {
+		fprintf(stderr, "error: %s program header outside file\n",
+			module->elf_file);
+		return -EINVAL;
 	}
 
 	/* allocate space for programs */
@@ -167,13 +174,8 @@ static int elf_read_programs(struct image *image, struct module *module)
 		return -ENOMEM;
 	module->prg = prg;
 
-	/* read in programs */
-	count = fread(prg, sizeof(Elf32_Phdr), hdr->phnum, module->fd);
-	if (count != hdr->phnum) {
-		fprintf(stderr, "error: failed to read %s program header %d\n",
-			module->elf_file, -errno);
-		return -errno;
-	}
+	/* copy programs */
+	memcpy(prg, module->map + hdr->phoff, size);
 
 	/* check each program */
 	for (i = 0; i < hdr->phnum; i++) {
@@ -205,15 +207,14 @@ static int elf_read_programs(struct image *image, struct module *module)
 static int elf_read_hdr(struct image *image, struct module *module)
 {
 	Elf32_Ehdr *hdr = &module->hdr;
-	size_t count;
 
-	/* read in elf header */
-	count = fread(hdr, sizeof(*hdr), 1, module->fd);
-	if (count != 1) {
-		fprintf(stderr, "error: failed to read %s elf header %d\n",
-			module->elf_file, -errno);
-		return -errno;
+	/* copy elf header */
+	if (module->file_size < sizeof(*hdr)) {
+		fprintf(stderr, "error: %s is too small for an elf header\n",
+			module->elf_file);
+		return -EINVAL;
 	}
+	memcpy(hdr, module->map, sizeof(*hdr));
 
 	if (!image->verbose)
 		return 0;
@@ -485,56 +486,31 @@ int elf_find_section(struct image *image, struct module *module,
 		     const char *name)
 {
 	Elf32_Ehdr *hdr = &module->hdr;
-	Elf32_Shdr *section, *s;
-	char *buffer;
-	size_t count;
-	int ret, i;
-
-	section = &module->section[hdr->shstrndx];
-
-	/* alloc data data */
-	buffer = calloc(1, section->size);
-	if (!buffer)
-		return -ENOMEM;
-
-	/* read in section string data */
-	ret = fseek(module->fd, section->off, SEEK_SET);
-	if (ret < 0) {
-		fprintf(stderr, "error: cant seek to string section %d\n", ret);
-		goto out;
-	}
+	Elf32_Shdr *strings, *s;
+	int i;
 
-	count = fread(buffer, 1, section->size, module->fd);
-	if (count != section->size) {
-		fprintf(stderr, "error: can't read string section %d\n",
-			-errno);
-		ret = -errno;
-		goto out;
-	}
+	strings = &module->section[hdr->shstrndx];
 
 	/* find section with name */
 	for (i = 0; i < hdr->shnum; i++) {
 		s = &module->section[i];
-		if (!strcmp(name, buffer + s->name)) {
-			ret = i;
-			goto out;
-		}
+		if (s->name < strings->size &&
+		    !strcmp(name, module->strings + s->name))
+			return i;
 	}
 
 	fprintf(stderr, "error: can't find section %s in module %s\n", name,
 		module->elf_file);
-	ret = -EINVAL;
-
-out:
-	free(buffer);
-	return ret;
+	return -EINVAL;
 }
 
 int elf_parse_module(struct image *image, int module_index, const char *name)
 {
 	struct module *module;
+	struct stat st;
 	uint32_t rem;
 	int ret = 0;
+	int fd;
 
 	/* validate module index */
 	if (module_index >= MAX_MODULES) {
@@ -545,8 +521,8 @@ int elf_parse_module(struct image *image, int module_index, const char *name)
 	module = &image->module[module_index];
 
 	/* open the elf input file */
-	module->fd = fopen(name, "rb");
-	if (!module->fd) {
+	fd = open(name, O_RDONLY);
+	if (fd < 0) {
 		fprintf(stderr, "error: unable to open %s for reading %d\n",
 			name, errno);
 		return -EINVAL;
@@ -554,13 +530,22 @@ int elf_parse_module(struct image *image, int module_index, const char *name)
 	module->elf_file = name;
 
 	/* get file size */
-	ret = fseek(module->fd, 0, SEEK_END);
-	if (ret < 0)
-		goto hdr_err;
-	module->file_size = ftell(module->fd);
-	ret = fseek(module->fd, 0, SEEK_SET);
-	if (ret < 0)
-		goto hdr_err;
+	if (fstat(fd, &st) < 0 || st.st_size == 0) {
+		fprintf(stderr, "error: unable to size %s %d\n", name, errno);
+		close(fd);
+		return -EINVAL;
+	}
+	module->file_size = st.st_size;
+
+	/* map the whole file, every later read is a pointer into it */
+	module->map = mmap(NULL, module->file_size, PROT_READ, MAP_PRIVATE,
+			   fd, 0);
+	close(fd);
+	if (module->map == MAP_FAILED) {
+		fprintf(stderr, "error: unable to map %s %d\n", name, errno);
+		module->map = NULL;
+		return -errno;
+	}
 
 	/* read in elf header */
 	ret = elf_read_hdr(image, module);
@@ -618,9 +603,11 @@ int elf_parse_module(struct image *image, int module_index, const char *name)
 	return 0;
 
 sec_err:
+	free(module->section);
 	free(module->prg);
 hdr_err:
-	fclose(module->fd);
+	munmap((void *)module->map, module->file_size);
+	module->map = NULL;
 
 	return ret;
 }
@@ -631,6 +618,5 @@ void elf_free_module(struct image *image, int module_index)
 
 	free(module->prg);
 	free(module->section);
-	free(module->strings);
-	fclose(module->fd);
+	munmap((void *)module->map, module->file_size);
 }
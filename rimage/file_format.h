@@ -79,4 +79,37 @@ struct snd_sof_logs_header {
 	uint32_t data_offset;	/* offset to first entry in this file */
 	struct sof_ipc_fw_version version;
 };
+
+/*
+ * Logs dictionary v2. The snd_sof_logs_header signature is
+ * SND_SOF_LOGS_SIG_V2, data_length is the size of the log entries section
+ * and data_offset points to the payload after struct snd_sof_logs_header_v2.
+ * The payload, optionally zlib compressed, is entry_count fixed size
+ * struct snd_sof_logs_entry records followed by the string table, which
+ * holds every source file name and format string once.
+ */
+#define SND_SOF_LOGS_SIG_V2	"Log2"
+
+#define SND_SOF_LOGS_FLAG_ZLIB	(1 << 0)	/* payload is compressed */
+
+struct snd_sof_logs_header_v2 {
+	uint32_t flags;		/* SND_SOF_LOGS_FLAG_ */
+	uint32_t entry_count;	/* number of struct snd_sof_logs_entry */
+	uint32_t strings_size;	/* string table bytes following records */
+	uint32_t payload_size;	/* records and strings, uncompressed */
+	uint32_t stored_size;	/* payload bytes in this file */
+};
+
+/* log entry at offset in the log entries section */
+struct snd_sof_logs_entry {
+	uint32_t offset;		/* entry offset in the section */
+	uint32_t component_class;
+	uint32_t line_idx;
+	uint32_t file_name;		/* string table offset */
+	uint32_t text;			/* string table offset */
+	uint8_t level;
+	uint8_t has_ids;
+	uint8_t params_num;
+	uint8_t reserved;
+};
 #endif
@@ -18,6 +18,7 @@
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
+#include <zlib.h>
 
 #include "rimage.h"
 #include "file_format.h"
@@ -81,9 +82,10 @@ static int write_block(struct image *image, struct module *module,
 {
 	const struct adsp *adsp = image->adsp;
 	struct snd_sof_blk_hdr block;
+	static const uint8_t zero[4];
 	uint32_t padding = 0;
+	const void *data;
 	size_t count;
-	void *buffer;
 	int ret;
 
 	block.size = section->size;
@@ -104,50 +106,33 @@ static int write_block(struct image *image, struct module *module,
 		return -EINVAL;
 	}
 
+	/* section data is written straight from the ELF mapping */
+	data = elf_section_data(module, section);
+	if (!data)
+		return -EINVAL;
+
 	/* write header */
 	count = fwrite(&block, sizeof(block), 1, image->out_fd);
 	if (count != 1)
 		return -errno;
 
-	/* alloc data data */
-	buffer = calloc(1, section->size);
-	if (!buffer)
-		return -ENOMEM;
-
-	/* read in section data */
-	ret = fseek(module->fd, section->off, SEEK_SET);
-	if (ret < 0) {
-		fprintf(stderr, "error: cant seek to section %d\n", ret);
-		goto out;
-	}
-	count = fread(buffer, 1, section->size, module->fd);
-	if (count != section->size) {
-		fprintf(stderr, "error: cant read section %d\n", -errno);
-		ret = -errno;
-		goto out;
-	}
-
-	/* write out section data */
-	count = fwrite(buffer, 1, block.size, image->out_fd);
+	/* write out section data and zero padding */
+	count = fwrite(data, 1, section->size, image->out_fd);
+	if (count == section->size && padding)
+		count += fwrite(zero, 1, padding, image->out_fd);
 	if (count != block.size) {
 		fprintf(stderr, "error: cant write section %d\n", -errno);
 		fprintf(stderr, " foffset %d size 0x%x mem addr 0x%x\n",
 			section->off, section->size, section->vaddr);
-		ret = -errno;
-		goto out;
+		return -errno;
 	}
 
 	fprintf(stdout, "\t%d\t0x%8.8x\t0x%8.8x\t0x%8.8lx\t%s\n", block_idx++,
 		section->vaddr, section->size, ftell(image->out_fd),
 		block.type == SOF_FW_BLK_TYPE_IRAM ? "TEXT" : "DATA");
 
-out:
-	free(buffer);
 	/* return padding size */
-	if (ret >= 0)
-		return padding;
-
-	return ret;
+	return padding;
 }
 
 static int simple_write_module(struct image *image, struct module *module)
@@ -230,8 +215,6 @@ static int write_block_reloc(struct image *image, struct module *module)
 {
 	struct snd_sof_blk_hdr block;
 	size_t count;
-	void *buffer;
-	int ret;
 
 	block.size = module->file_size;
 	block.type = SOF_FW_BLK_TYPE_DRAM;
@@ -242,39 +225,18 @@ static int write_block_reloc(struct image *image, struct module *module)
 	if (count != 1)
 		return -errno;
 
-	/* alloc data data */
-	buffer = calloc(1, module->file_size);
-	if (!buffer)
-		return -ENOMEM;
-
-	/* read in section data */
-	ret = fseek(module->fd, 0, SEEK_SET);
-	if (ret < 0) {
-		fprintf(stderr, "error: can't seek to section %d\n", ret);
-		goto out;
-	}
-	count = fread(buffer, 1, module->file_size, module->fd);
-	if (count != module->file_size) {
-		fprintf(stderr, "error: can't read section %d\n", -errno);
-		ret = -errno;
-		goto out;
-	}
-
-	/* write out section data */
-	count = fwrite(buffer, 1, module->file_size, image->out_fd);
+	/* write out the whole ELF from its mapping */
+	count = fwrite(module->map, 1, module->file_size, image->out_fd);
 	if (count != module->file_size) {
 		fprintf(stderr, "error: can't write section %d\n", -errno);
-		ret = -errno;
-		goto out;
+		return -errno;
 	}
 
 	fprintf(stdout, "\t%d\t0x%8.8x\t0x%8.8x\t0x%8.8lx\t%s\n", block_idx++,
 		0, module->file_size, ftell(image->out_fd),
 		block.type == SOF_FW_BLK_TYPE_IRAM ? "TEXT" : "DATA");
 
-out:
-	free(buffer);
-	return ret;
+	return 0;
 }
 
 static int simple_write_module_reloc(struct image *image, struct module *module)
@@ -376,11 +338,205 @@ static int simple_write_firmware(struct image *image)
 	return 0;
 }
 
+/* fixed part of a .static_log_entries entry, see _DECLARE_LOG_ENTRY() */
+struct log_entry_raw {
+	uint32_t level;
+	uint32_t component_class;
+	uint32_t has_ids;
+	uint32_t params_num;
+	uint32_t line_idx;
+	uint32_t file_name_len;
+	uint32_t text_len;
+};
+
+/* deduplicating string table, slots hold string offset + 1 */
+struct ldc_strtab {
+	char *buf;
+	uint32_t size;
+	uint32_t *slots;
+	uint32_t slot_mask;
+};
+
+/*
+ * Find log entry at or after *offset, entries are 4 byte aligned and the
+ * linker may pad between them. Returns entry size or 0 at section end.
+ */
+static uint32_t log_entry_next(const uint8_t *data, uint32_t size,
+			       uint32_t *offset, struct log_entry_raw *entry)
+{
+	const char *strings;
+	uint32_t len;
+
+	for (; *offset + sizeof(*entry) <= size; *offset += 4) {
+		memcpy(entry, data + *offset, sizeof(*entry));
+		len = size - *offset - sizeof(*entry);
+		if (!entry->file_name_len || !entry->text_len ||
+		    entry->file_name_len > len ||
+		    entry->text_len > len - entry->file_name_len ||
+		    entry->level > UINT8_MAX || entry->has_ids > UINT8_MAX ||
+		    entry->params_num > UINT8_MAX)
+			continue;
+
+		strings = (const char *)data + *offset + sizeof(*entry);
+		if (strings[entry->file_name_len - 1] ||
+		    strings[entry->file_name_len + entry->text_len - 1])
+			continue;
+
+		len = sizeof(*entry) + entry->file_name_len + entry->text_len;
+		return (len + 3) & ~3;
+	}
+
+	return 0;
+}
+
+static uint32_t strtab_hash(const char *s)
+{
+	uint32_t hash = 2166136261u;
+
+	while (*s)
+		hash = (hash ^ (uint8_t)*s++) * 16777619u;
+	return hash;
+}
+
+/* add string to the table unless it's there already, returns its offset */
+static uint32_t strtab_add(struct ldc_strtab *tab, const char *s)
+{
+	uint32_t i = strtab_hash(s) & tab->slot_mask;
+	uint32_t len;
+
+	for (; tab->slots[i]; i = (i + 1) & tab->slot_mask)
+		if (!strcmp(tab->buf + tab->slots[i] - 1, s))
+			return tab->slots[i] - 1;
+
+	len = strlen(s) + 1;
+	memcpy(tab->buf + tab->size, s, len);
+	tab->slots[i] = tab->size + 1;
+	tab->size += len;
+
+	return tab->slots[i] - 1;
+}
+
+/*
+ * Write v2 dictionary: one fixed record per entry and a shared string
+ * table, so file names repeated by every entry are stored once.
+ */
+static int write_logs_dictionary_v2(struct image *image,
+				    struct snd_sof_logs_header *header,
+				    const uint8_t *data, uint32_t size)
+{
+	struct snd_sof_logs_header_v2 header_v2;
+	struct snd_sof_logs_entry *records;
+	struct log_entry_raw entry;
+	struct ldc_strtab tab;
+	const char *file_name;
+	uint8_t *payload;
+	uint8_t *stored = NULL;
+	uLongf stored_size;
+	uint32_t offset = 0;
+	uint32_t count = 0;
+	uint32_t len;
+	int ret = 0;
+
+	/* count entries to size the records and string hash */
+	while ((len = log_entry_next(data, size, &offset, &entry))) {
+		offset += len;
+		count++;
+	}
+
+	/* strings never take more space than the section itself */
+	payload = malloc(count * sizeof(*records) + size);
+	for (tab.slot_mask = 1; tab.slot_mask < count * 4;)
+		tab.slot_mask <<= 1;
+	tab.slots = calloc(tab.slot_mask, sizeof(*tab.slots));
+	tab.slot_mask--;
+	tab.size = 0;
+	if (!payload || !tab.slots) {
+		ret = -ENOMEM;
+		goto out;
+	}
+	records = (struct snd_sof_logs_entry *)payload;
+	tab.buf = (char *)(records + count);
+
+	offset = 0;
+	count = 0;
+	while ((len = log_entry_next(data, size, &offset, &entry))) {
+		file_name = (const char *)data + offset + sizeof(entry);
+
+		records[count].offset = offset;
+		records[count].component_class = entry.component_class;
+		records[count].line_idx = entry.line_idx;
+		records[count].file_name = strtab_add(&tab, file_name);
+		records[count].text = strtab_add(&tab, file_name +
+						 entry.file_name_len);
+		records[count].level = entry.level;
+		records[count].has_ids = entry.has_ids;
+		records[count].params_num = entry.params_num;
+		records[count].reserved = 0;
+
+		offset += len;
+		count++;
+	}
+
+	header_v2.flags = 0;
+	header_v2.entry_count = count;
+	header_v2.strings_size = tab.size;
+	header_v2.payload_size = count * sizeof(*records) + tab.size;
+	header_v2.stored_size = header_v2.payload_size;
+	stored = payload;
+
+	if (image->ldc_zlib) {
+		stored_size = compressBound(header_v2.payload_size);
+		stored = malloc(stored_size);
+		if (!stored) {
+			ret = -ENOMEM;
+			goto out;
+		}
+
+		ret = compress2(stored, &stored_size, payload,
+				header_v2.payload_size, Z_BEST_COMPRESSION);
+		if (ret != Z_OK) {
+			fprintf(stderr, "error: can't compress logs %d\n", ret);
+			ret = -EINVAL;
+			goto out;
+		}
+
+		header_v2.flags |= SND_SOF_LOGS_FLAG_ZLIB;
+		header_v2.stored_size = stored_size;
+	}
+
+	memcpy(header->sig, SND_SOF_LOGS_SIG_V2, SND_SOF_LOGS_SIG_SIZE);
+	header->data_offset = sizeof(*header) + sizeof(header_v2);
+
+	if (fwrite(header, sizeof(*header), 1, image->ldc_out_fd) != 1 ||
+	    fwrite(&header_v2, sizeof(header_v2), 1, image->ldc_out_fd) != 1 ||
+	    fwrite(stored, 1, header_v2.stored_size, image->ldc_out_fd) !=
+	    header_v2.stored_size) {
+		fprintf(stderr, "error: can't write logs dictionary %d\n",
+			-errno);
+		ret = -errno;
+		goto out;
+	}
+
+	fprintf(stdout, "logs dictionary: %u entries, %u string bytes\n",
+		count, tab.size);
+	fprintf(stdout, "logs dictionary: size %u, section size %u\n\n",
+		header->data_offset + header_v2.stored_size, size);
+
+out:
+	if (stored != payload)
+		free(stored);
+	free(payload);
+	free(tab.slots);
+	return ret;
+}
+
 int write_logs_dictionary(struct image *image)
 {
 	struct snd_sof_logs_header header;
-	int i, ret = 0;
-	void *buffer = NULL;
+	const struct sof_ipc_fw_ready *ready;
+	const void *data;
+	size_t count;
+	int i, ret;
 
 	memcpy(header.sig, SND_SOF_LOGS_SIG, SND_SOF_LOGS_SIG_SIZE);
 	header.data_offset = sizeof(struct snd_sof_logs_header);
@@ -395,28 +551,16 @@ int write_logs_dictionary(struct image *image)
 			Elf32_Shdr *section =
 				&module->section[module->fw_ready_index];
 
-			buffer = calloc(1, sizeof(struct sof_ipc_fw_ready));
-			if (!buffer)
-				return -ENOMEM;
-
-			fseek(module->fd, section->off, SEEK_SET);
-			size_t count = fread(buffer, 1,
-				sizeof(struct sof_ipc_fw_ready), module->fd);
-
-			if (count != sizeof(struct sof_ipc_fw_ready)) {
+			ready = elf_section_data(module, section);
+			if (!ready || section->size < sizeof(*ready)) {
 				fprintf(stderr,
 					"error: can't read ready section %d\n",
-					-errno);
-				ret = -errno;
-				goto out;
+					module->fw_ready_index);
+				return -EINVAL;
 			}
 
-			memcpy(&header.version,
-			       &((struct sof_ipc_fw_ready *)buffer)->version,
+			memcpy(&header.version, &ready->version,
 			       sizeof(header.version));
-
-			free(buffer);
-			buffer = NULL;
 		}
 
 		if (module->logs_index > 0) {
@@ -426,31 +570,33 @@ int write_logs_dictionary(struct image *image)
 			header.base_address = section->vaddr;
 			header.data_length = section->size;
 
-			fwrite(&header, sizeof(struct snd_sof_logs_header), 1,
-			       image->ldc_out_fd);
-
-			buffer = calloc(1, section->size);
-			if (!buffer)
-				return -ENOMEM;
-
-			fseek(module->fd, section->off, SEEK_SET);
-			size_t count = fread(buffer, 1, section->size,
-				module->fd);
-			if (count != section->size) {
+			data = elf_section_data(module, section);
+			if (!data) {
 				fprintf(stderr,
 					"error: can't read logs section %d\n",
-					-errno);
-				ret = -errno;
-				goto out;
+					module->logs_index);
+				return -EINVAL;
 			}
-			count = fwrite(buffer, 1, section->size,
+
+			if (image->ldc_v2) {
+				ret = write_logs_dictionary_v2(image, &header,
+							       data,
+							       section->size);
+				if (ret < 0)
+					return ret;
+				continue;
+			}
+
+			fwrite(&header, sizeof(struct snd_sof_logs_header), 1,
+			       image->ldc_out_fd);
+
+			count = fwrite(data, 1, section->size,
 				       image->ldc_out_fd);
 			if (count != section->size) {
 				fprintf(stderr,
 					"error: can't write section %d\n",
 					-errno);
-				ret = -errno;
-				goto out;
+				return -errno;
 			}
 
 			fprintf(stdout, "logs dictionary: size %u\n",
@@ -459,11 +605,8 @@ int write_logs_dictionary(struct image *image)
 				(unsigned long)sizeof(header.version));
 		}
 	}
-out:
-	if (buffer)
-		free(buffer);
 
-	return ret;
+	return 0;
 }
 
 const struct adsp machine_byt = {
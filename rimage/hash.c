@@ -20,6 +20,7 @@
 #include <errno.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
 #include <sys/time.h>
 
 #include <openssl/conf.h>
@@ -96,3 +97,66 @@ void ri_hash(struct image *image, unsigned int offset, unsigned int size,
 	module_sha256_update(image, image->fw_image + offset, size);
 	module_sha256_complete(image, hash);
 }
+
+/* more threads than this gains nothing, modules are few and large */
+#define HASH_THREADS_MAX	16
+
+struct hash_pool {
+	struct hash_job *jobs;
+	int count;
+	int next;	/* next job to claim, atomic */
+};
+
+static void hash_job_run(struct hash_job *job)
+{
+	unsigned char md_value[EVP_MAX_MD_SIZE];
+	unsigned int md_len;
+
+	/* one shot digest, no context shared between threads */
+	EVP_Digest(job->data, job->size, md_value, &md_len, EVP_sha256(),
+		   NULL);
+	memcpy(job->hash, md_value, md_len);
+}
+
+static void *hash_pool_worker(void *data)
+{
+	struct hash_pool *pool = data;
+	int i;
+
+	while ((i = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED)) <
+	       pool->count)
+		hash_job_run(&pool->jobs[i]);
+
+	return NULL;
+}
+
+/*
+ * Hash independent buffers concurrently. Each job writes only its own
+ * hash so the jobs can complete in any order.
+ */
+void ri_hash_jobs(struct hash_job *jobs, int count)
+{
+	struct hash_pool pool = { .jobs = jobs, .count = count };
+	pthread_t threads[HASH_THREADS_MAX];
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	int nthreads = 0;
+	int i;
+
+	if (cpus > count)
+		cpus = count;
+	if (cpus > HASH_THREADS_MAX)
+		cpus = HASH_THREADS_MAX;
+
+	/* calling thread is a worker too */
+	for (i = 1; i < cpus; i++) {
+		if (pthread_create(&threads[nthreads], NULL, hash_pool_worker,
+				   &pool))
+			break;
+		nthreads++;
+	}
+
+	hash_pool_worker(&pool);
+
+	for (i = 0; i < nthreads; i++)
+		pthread_join(threads[i], NULL);
+}
@@ -21,6 +21,7 @@
 #include <errno.h>
 #include <string.h>
 #include <time.h>
+#include <sys/mman.h>
 #include <sys/time.h>
 
 #include <uapi/user/manifest.h>
@@ -86,13 +87,56 @@ static int man_open_manifest_file(struct image *image)
 	return 0;
 }
 
-static int man_init_image_v1_5(struct image *image)
+/*
+ * Build the image directly in the output file by mapping it, so the final
+ * write is just a truncate to image_end. Falls back to a heap buffer and
+ * fwrite() when the output can't be mapped (e.g. a pipe).
+ */
+static int man_alloc_image(struct image *image)
 {
-	/* allocate image and copy template manifest */
-	image->fw_image = calloc(image->adsp->image_size, 1);
+	size_t size = image->adsp->image_size;
+	int fd = fileno(image->out_fd);
+	void *map;
+
+	image->fw_image_mapped = 0;
+
+	if (ftruncate(fd, size) == 0) {
+		map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			   fd, 0);
+		if (map != MAP_FAILED) {
+			image->fw_image = map;
+			image->fw_image_mapped = 1;
+			return 0;
+		}
+	}
+
+	image->fw_image = calloc(size, 1);
 	if (!image->fw_image)
 		return -ENOMEM;
 
+	return 0;
+}
+
+static void man_free_image(struct image *image)
+{
+	if (image->fw_image_mapped)
+		munmap(image->fw_image, image->adsp->image_size);
+	else
+		free(image->fw_image);
+
+	image->fw_image = NULL;
+	image->fw_image_mapped = 0;
+}
+
+static int man_init_image_v1_5(struct image *image)
+{
+	int ret;
+
+	/* allocate image and copy template manifest */
+	ret = man_alloc_image(image);
+	if (ret < 0)
+		return ret;
+
 	memcpy(image->fw_image, image->adsp->man_v1_5,
 	       sizeof(struct fw_image_manifest_v1_5));
 
@@ -101,10 +145,12 @@ static int man_init_image_v1_5(struct image *image)
 
 static int man_init_image_v1_5_sue(struct image *image)
 {
+	int ret;
+
 	/* allocate image and copy template manifest */
-	image->fw_image = calloc(image->adsp->image_size, 1);
-	if (!image->fw_image)
-		return -ENOMEM;
+	ret = man_alloc_image(image);
+	if (ret < 0)
+		return ret;
 
 	/* copy 1.5 sue manifest */
 	memcpy(image->fw_image + MAN_DESC_OFFSET_V1_5_SUE,
@@ -116,10 +162,12 @@ static int man_init_image_v1_5_sue(struct image *image)
 
 static int man_init_image_v1_8(struct image *image)
 {
+	int ret;
+
 	/* allocate image and copy template manifest */
-	image->fw_image = calloc(image->adsp->image_size, 1);
-	if (!image->fw_image)
-		return -ENOMEM;
+	ret = man_alloc_image(image);
+	if (ret < 0)
+		return ret;
 
 	memcpy(image->fw_image, image->adsp->man_v1_8,
 	       sizeof(struct fw_image_manifest_v1_8));
@@ -164,7 +212,7 @@ static int man_copy_sram(struct image *image, Elf32_Shdr *section,
 	uint32_t end = offset + section->size;
 	int seg_type = -1;
 	void *buffer = image->fw_image + offset;
-	size_t count;
+	const void *data;
 
 	switch (section->type) {
 	case SHT_PROGBITS:
@@ -188,12 +236,17 @@ static int man_copy_sram(struct image *image, Elf32_Shdr *section,
 	    man_module->segment[seg_type].file_offset == 0)
 		man_module->segment[seg_type].file_offset = offset;
 
-	count = fread(buffer, 1, section->size, module->fd);
-	if (count != section->size) {
-		fprintf(stderr, "error: cant read section %d\n", -errno);
-		return -errno;
+	if (end > image->adsp->image_size) {
+		fprintf(stderr, "error: section %d end 0x%x exceeds image\n",
+			section_idx, end);
+		return -EINVAL;
 	}
 
+	data = elf_section_data(module, section);
+	if (!data)
+		return -EINVAL;
+	memcpy(buffer, data, section->size);
+
 	/* get module end offset  ? */
 	if (end > image->image_end)
 		image->image_end = end;
@@ -209,15 +262,6 @@ static int man_copy_elf_section(struct image *image, Elf32_Shdr *section,
 				struct module *module,
 				struct sof_man_module *man_module, int idx)
 {
-	int ret;
-
-	/* seek to ELF section */
-	ret = fseek(module->fd, section->off, SEEK_SET);
-	if (ret < 0) {
-		fprintf(stderr, "error: can't seek to section %d\n", ret);
-		return ret;
-	}
-
 	/* write data to DRAM or ROM image */
 	if (!elf_is_rom(image, section))
 		return man_copy_sram(image, section, module, man_module, idx);
@@ -231,8 +275,8 @@ static int man_get_module_manifest(struct image *image, struct module *module,
 	Elf32_Shdr *section;
 	struct sof_man_segment_desc *segment;
 	struct sof_man_module_manifest sof_mod;
-	size_t count;
-	int ret, man_section_idx;
+	const uint8_t *data;
+	int man_section_idx;
 
 	fprintf(stdout, "Module Write: %s\n", module->elf_file);
 
@@ -246,23 +290,21 @@ static int man_get_module_manifest(struct image *image, struct module *module,
 	section = &module->section[man_section_idx];
 
 	/* load in manifest data */
+	data = elf_section_data(module, section);
+	if (!data)
+		return -EINVAL;
+
 	/* module built using xcc has preceding bytes */
 	if (section->size > sizeof(sof_mod))
-		ret = fseek(module->fd,
-			    section->off + XCC_MOD_OFFSET, SEEK_SET);
-	else
-		ret = fseek(module->fd, section->off, SEEK_SET);
+		data += XCC_MOD_OFFSET;
 
-	if (ret < 0) {
-		fprintf(stderr, "error: can't seek to section %d\n", ret);
-		return ret;
+	if (data + sizeof(sof_mod) > module->map + module->file_size) {
+		fprintf(stderr, "error: can't read section %d\n",
+			man_section_idx);
+		return -EINVAL;
 	}
 
-	count = fread(&sof_mod, 1, sizeof(sof_mod), module->fd);
-	if (count != sizeof(sof_mod)) {
-		fprintf(stderr, "error: can't read section %d\n", -errno);
-		return -errno;
-	}
+	memcpy(&sof_mod, data, sizeof(sof_mod));
 
 	/* configure man_module with sofmod data */
 	memcpy(man_module->struct_id, "$AME", 4);
@@ -497,7 +539,6 @@ static int man_module_create_reloc(struct image *image, struct module *module,
 	int err;
 	unsigned int pages;
 	void *buffer = image->fw_image + module->foffset;
-	size_t count;
 
 	image->image_end = 0;
 
@@ -547,18 +588,13 @@ static int man_module_create_reloc(struct image *image, struct module *module,
 
 	fprintf(stdout, "\tNo\tAddress\t\tSize\t\tFile\tType\n");
 
-	/* seek to beginning of file */
-	err = fseek(module->fd, 0, SEEK_SET);
-	if (err < 0) {
-		fprintf(stderr, "error: can't seek to section %d\n", err);
-		return err;
-	}
-
-	count = fread(buffer, 1, module->file_size, module->fd);
-	if (count != module->file_size) {
-		fprintf(stderr, "error: can't read section %d\n", -errno);
-		return -errno;
+	/* whole relocatable ELF is copied as is */
+	if (module->foffset + module->file_size > image->adsp->image_size) {
+		fprintf(stderr, "error: module %s exceeds image\n",
+			module->elf_file);
+		return -EINVAL;
 	}
+	memcpy(buffer, module->map, module->file_size);
 
 	fprintf(stdout, "\t%d\t0x%8.8x\t0x%8.8x\t0x%x\t%s\n", 0,
 		0, module->file_size, 0, "DATA");
@@ -618,6 +654,17 @@ static int man_write_fw_mod(struct image *image)
 {
 	int count;
 
+	/* mapped image is already in the file, just cut it to size */
+	if (image->fw_image_mapped) {
+		count = ftruncate(fileno(image->out_fd), image->image_end);
+		if (count < 0) {
+			fprintf(stderr, "error: can't size %s %d\n",
+				image->out_file, -errno);
+			return -errno;
+		}
+		return 0;
+	}
+
 	/* write manifest and signed image */
 	count = fwrite(image->fw_image, image->image_end, 1, image->out_fd);
 
@@ -685,6 +732,8 @@ static int man_create_modules(struct image *image, struct sof_man_fw_desc *desc,
 static int man_hash_modules(struct image *image, struct sof_man_fw_desc *desc)
 {
 	struct sof_man_module *man_module;
+	struct hash_job jobs[MAX_MODULES];
+	int count = 0;
 	int i;
 
 	for (i = 0; i < image->num_modules; i++) {
@@ -696,13 +745,19 @@ static int man_hash_modules(struct image *image, struct sof_man_fw_desc *desc)
 			continue;
 		}
 
-		ri_hash(image,
-			man_module->segment[SOF_MAN_SEGMENT_TEXT].file_offset,
+		jobs[count].data = image->fw_image +
+			man_module->segment[SOF_MAN_SEGMENT_TEXT].file_offset;
+		jobs[count].size =
 			(man_module->segment[SOF_MAN_SEGMENT_TEXT].flags.r.length +
 			man_module->segment[SOF_MAN_SEGMENT_RODATA].flags.r.length) *
-			MAN_PAGE_SIZE, man_module->hash);
+			MAN_PAGE_SIZE;
+		jobs[count].hash = man_module->hash;
+		count++;
 	}
 
+	/* module segments don't overlap, hash them all at once */
+	ri_hash_jobs(jobs, count);
+
 	return 0;
 }
 
@@ -774,7 +829,7 @@ static int man_write_fw_v1_5(struct image *image)
 
 err:
 	free(image->rom_image);
-	free(image->fw_image);
+	man_free_image(image);
 	unlink(image->out_file);
 	unlink(image->out_rom_file);
 	return ret;
@@ -826,7 +881,7 @@ static int man_write_fw_v1_5_sue(struct image *image)
 	return 0;
 
 err:
-	free(image->fw_image);
+	man_free_image(image);
 	unlink(image->out_file);
 	return ret;
 }
@@ -919,7 +974,7 @@ static int man_write_fw_v1_8(struct image *image)
 
 err:
 	free(image->rom_image);
-	free(image->fw_image);
+	man_free_image(image);
 	unlink(image->out_file);
 	unlink(image->out_rom_file);
 	return ret;
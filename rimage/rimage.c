@@ -46,6 +46,8 @@ static void usage(char *name)
 	fprintf(stdout, "\t -r enable relocatable ELF files\n");
 	fprintf(stdout, "\t -s MEU signing offset\n");
 	fprintf(stdout, "\t -p log dictionary outfile\n");
+	fprintf(stdout, "\t -d write v2 log dictionary with string table\n");
+	fprintf(stdout, "\t -z compress v2 log dictionary, implies -d\n");
 	fprintf(stdout, "\t -i set IMR type\n");
 	exit(0);
 }
@@ -59,7 +61,7 @@ int main(int argc, char *argv[])
 
 	memset(&image, 0, sizeof(image));
 
-	while ((opt = getopt(argc, argv, "ho:p:m:vba:s:k:l:ri:")) != -1) {
+	while ((opt = getopt(argc, argv, "ho:p:m:vba:s:k:l:ri:dz")) != -1) {
 		switch (opt) {
 		case 'o':
 			image.out_file = optarg;
@@ -88,6 +90,13 @@ int main(int argc, char *argv[])
 		case 'i':
 			imr_type = atoi(optarg);
 			break;
+		case 'd':
+			image.ldc_v2 = 1;
+			break;
+		case 'z':
+			image.ldc_v2 = 1;
+			image.ldc_zlib = 1;
+			break;
 		case 'h':
 			usage(argv[0]);
 			break;
@@ -142,7 +151,7 @@ found:
 
 	/* open outfile for writing */
 	unlink(image.out_file);
-	image.out_fd = fopen(image.out_file, "wb");
+	image.out_fd = fopen(image.out_file, "w+b");
 	if (!image.out_fd) {
 		fprintf(stderr, "error: unable to open %s for writing %d\n",
 			image.out_file, errno);
@@ -55,12 +55,12 @@ enum machine_id {
  */
 struct module {
 	const char *elf_file;
-	FILE *fd;
+	const uint8_t *map;	/* whole ELF file, read only mapping */
 
 	Elf32_Ehdr hdr;
 	Elf32_Shdr *section;
 	Elf32_Phdr *prg;
-	char *strings;
+	const char *strings;
 
 	uint32_t text_start;
 	uint32_t text_end;
@@ -110,6 +110,8 @@ struct image {
 	int abi;
 	int verbose;
 	int reloc;	/* ELF data is relocatable */
+	int ldc_v2;	/* write deduplicated v2 log dictionary */
+	int ldc_zlib;	/* compress v2 log dictionary */
 	int num_modules;
 	struct module module[MAX_MODULES];
 	uint32_t image_end;/* module end, equal to output image size */
@@ -122,6 +124,7 @@ struct image {
 
 	/* file IO */
 	void *fw_image;
+	int fw_image_mapped;	/* fw_image is the mapped out_file */
 	void *rom_image;
 	FILE *out_rom_fd;
 	FILE *out_man_fd;
@@ -131,6 +134,13 @@ struct image {
 	char out_unsigned_file[256];
 };
 
+/* one independent SHA256 of a buffer, see ri_hash_jobs() */
+struct hash_job {
+	const void *data;
+	size_t size;
+	uint8_t *hash;
+};
+
 struct mem_zone {
 	uint32_t base;
 	uint32_t size;
@@ -164,6 +174,7 @@ void module_sha256_complete(struct image *image, uint8_t *hash);
 int ri_manifest_sign_v1_5(struct image *image);
 int ri_manifest_sign_v1_8(struct image *image);
 void ri_hash(struct image *image, unsigned offset, unsigned size, uint8_t *hash);
+void ri_hash_jobs(struct hash_job *jobs, int count);
 
 int pkcs_v1_5_sign_man_v1_5(struct image *image,
 			    struct fw_image_manifest_v1_5 *man,
@@ -181,6 +192,8 @@ int elf_find_section(struct image *image, struct module *module,
 		const char *name);
 int elf_validate_section(struct image *image, struct module *module,
 	Elf32_Shdr *section, int index);
+const void *elf_section_data(const struct module *module,
+			     const Elf32_Shdr *section);
 
 /* supported machines */
 extern const struct adsp machine_byt;
@@ -58,12 +58,18 @@ static inline void arch_atomic_init(atomic_t *a, int32_t value)
 /* use gcc atomic built-ins for host library */
 static inline int32_t arch_atomic_add(atomic_t *a, int32_t value)
 {
-	return __sync_fetch_and_add(&a->value, value);
+	return __sync_add_and_fetch(&a->value, value);
 }
 
 static inline int32_t arch_atomic_sub(atomic_t *a, int32_t value)
 {
-	return __sync_fetch_and_sub(&a->value, value);
+	return __sync_sub_and_fetch(&a->value, value);
+}
+
+static inline int32_t arch_atomic_cmpxchg(atomic_t *a, int32_t old,
+					  int32_t new_value)
+{
+	return __sync_val_compare_and_swap(&a->value, old, new_value);
 }
 
 #endif
@@ -32,6 +32,7 @@
 #ifndef __ARCH_INTERRUPT_H
 #define __ARCH_INTERRUPT_H
 
+#include <config.h>
 #include <sof/interrupt-map.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -45,9 +46,16 @@ static inline int arch_interrupt_register(int irq,
 static inline void arch_interrupt_unregister(int irq) {}
 static inline uint32_t arch_interrupt_enable_mask(uint32_t mask) {return 0; }
 static inline uint32_t arch_interrupt_disable_mask(uint32_t mask) {return 0; }
+#if CONFIG_HOST_VIRTUAL_TIME
+/* software interrupts are dispatched by the virtual time loop */
+uint32_t arch_interrupt_get_level(void);
+void arch_interrupt_set(int irq);
+void arch_interrupt_clear(int irq);
+#else
 static inline uint32_t arch_interrupt_get_level(void) { return 0; }
 static inline void arch_interrupt_set(int irq) {}
 static inline void arch_interrupt_clear(int irq) {}
+#endif
 static inline uint32_t arch_interrupt_get_enabled(void) {return 0; }
 static inline uint32_t arch_interrupt_get_status(void) {return 0; }
 static inline uint32_t arch_interrupt_global_disable(void) {return 0; }
@@ -38,6 +38,7 @@
 #include <sof/string.h>
 #include <stdio.h>
 #include <execinfo.h>
+#include <config.h>
 
 /* architecture specific stack frames to dump */
 #define ARCH_STACK_DUMP_FRAMES		32
@@ -45,10 +46,13 @@
 /* data cache line alignment */
 #define PLATFORM_DCACHE_ALIGN	sizeof(uint32_t)
 
+/* heap counts come from the platform memory map in the allocator model */
+#if !CONFIG_HOST_MEMORY_MODEL
 #define PLATFORM_HEAP_SYSTEM		1
 #define PLATFORM_HEAP_SYSTEM_RUNTIME	1
 #define PLATFORM_HEAP_RUNTIME		1
 #define PLATFORM_HEAP_BUFFER		3
+#endif
 
 static inline void *arch_get_stack_ptr(void)
 {
@@ -38,8 +38,29 @@
 #ifndef __ARCH_TASK_H_
 #define __ARCH_TASK_H_
 
+#include <config.h>
 #include <sof/schedule.h>
 
+#if CONFIG_HOST_VIRTUAL_TIME
+
+/**
+ * \brief Allocates IRQ tasks.
+ */
+int arch_allocate_tasks(void);
+
+/**
+ * \brief Frees IRQ tasks.
+ */
+void arch_free_tasks(void);
+
+/**
+ * \brief Runs task.
+ * \param[in,out] task Task data.
+ */
+int arch_run_task(struct task *task);
+
+#else
+
 /**
  * \brief Allocates IRQ tasks.
  */
@@ -58,3 +79,5 @@ static inline int arch_run_task(struct task *task)
 }
 
 #endif
+
+#endif
@@ -88,4 +88,18 @@ static inline int32_t arch_atomic_sub(atomic_t *a, int32_t value)
 	return (*(volatile int32_t *)&a->value);
 }
 
+/* store new value only if current one equals old, returns current value */
+static inline int32_t arch_atomic_cmpxchg(atomic_t *a, int32_t old,
+					  int32_t new_value)
+{
+	__asm__ __volatile__(
+		"       wsr     %2, scompare1\n"
+		"       s32c1i  %0, %1, 0\n"
+		: "+a" (new_value)
+		: "a" (&a->value), "a" (old)
+		: "memory");
+
+	return new_value;
+}
+
 #endif
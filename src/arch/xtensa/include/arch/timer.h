@@ -87,4 +87,14 @@ static inline void arch_timer_clear(struct timer *timer)
 	arch_interrupt_clear(timer->irq);
 }
 
+/* CPU cycle counter of this core */
+static inline uint32_t arch_timer_get_cycles(void)
+{
+	uint32_t ccount;
+
+	__asm__ __volatile__("rsr.ccount %0" : "=a"(ccount));
+
+	return ccount;
+}
+
 #endif
@@ -43,6 +43,13 @@
 
 extern struct ipc *_ipc;
 
+/** \brief Size of all IDC message queues. */
+#define IDC_QUEUES_SIZE	\
+	(PLATFORM_CORE_COUNT * PLATFORM_CORE_COUNT * sizeof(struct idc_queue))
+
+/** \brief IDC message queues, indexed by source and target core. */
+static struct idc_queue *idc_queues;
+
 /**
  * \brief Returns IDC data.
  * \return Pointer to pointer of IDC data.
@@ -54,6 +61,17 @@ static struct idc **idc_get(void)
 	return &ctx->idc;
 }
 
+/**
+ * \brief Returns IDC message queue.
+ * \param[in] source_core Source core id.
+ * \param[in] target_core Target core id.
+ * \return Pointer to IDC message queue.
+ */
+static struct idc_queue *idc_queue_get(int source_core, int target_core)
+{
+	return idc_queues + source_core * PLATFORM_CORE_COUNT + target_core;
+}
+
 /**
  * \brief Enables IDC interrupts.
  * \param[in] target_core Target core id.
@@ -75,7 +93,6 @@ static void idc_irq_handler(void *arg)
 	struct idc *idc = arg;
 	int core = arch_cpu_get_id();
 	uint32_t idctfc;
-	uint32_t idctefc;
 	uint32_t idcietc;
 	uint32_t i;
 
@@ -85,21 +102,12 @@ static void idc_irq_handler(void *arg)
 		idctfc = idc_read(IPC_IDCTFC(i), core);
 
 		if (idctfc & IPC_IDCTFC_BUSY) {
-			trace_idc("idc_irq_handler(), IPC_IDCTFC_BUSY");
+			tracev_idc("idc_irq_handler(), IPC_IDCTFC_BUSY");
 
-			/* disable BUSY interrupt */
+			/* disable BUSY interrupt until queues are drained */
 			idc_write(IPC_IDCCTL, core, idc->done_bit_mask);
 
-			idc->received_msg.core = i;
-			idc->received_msg.header =
-					idctfc & IPC_IDCTFC_MSG_MASK;
-
-			idctefc = idc_read(IPC_IDCTEFC(i), core);
-			idc->received_msg.extension =
-					idctefc & IPC_IDCTEFC_MSG_MASK;
-
 			schedule_task(&idc->idc_task, 0, IDC_DEADLINE, 0);
-
 			break;
 		}
 	}
@@ -110,53 +118,113 @@ static void idc_irq_handler(void *arg)
 		if (idcietc & IPC_IDCIETC_DONE) {
 			tracev_idc("idc_irq_handler(), IPC_IDCIETC_DONE");
 
+			/* senders poll queue tails, nothing else to do */
 			idc_write(IPC_IDCIETC(i), core,
 				  idcietc | IPC_IDCIETC_DONE);
-
-			break;
 		}
 	}
 }
 
 /**
  * \brief Sends IDC message.
+ *
+ * Message is queued for the target core, which is only interrupted when
+ * it is not already draining its queues. Completion is only ever read from
+ * the queue tail, which the target advances after executing each message,
+ * so it does not depend on when the target clears BUSY.
+ *
  * \param[in,out] msg Pointer to IDC message.
  * \param[in] mode Is message blocking or not.
- * \return Error code.
+ * \return Error code, or result of the message if blocking.
  */
 int arch_idc_send_msg(struct idc_msg *msg, uint32_t mode)
 {
 	struct idc *idc = *idc_get();
 	int core = arch_cpu_get_id();
-	int ret = 0;
+	struct idc_queue *queue = idc_queue_get(core, msg->core);
 	uint32_t timeout = 0;
-	uint32_t idcietc;
 	uint32_t flags;
+	uint32_t slot;
 
 	tracev_idc("arch_idc_send_msg()");
 
-	spin_lock_irq(&idc->lock, flags);
+	if (msg->payload_size > IDC_MAX_PAYLOAD_SIZE) {
+		trace_idc_error("arch_idc_send_msg() error: payload size %u",
+				msg->payload_size);
+		return -EINVAL;
+	}
 
-	idc_write(IPC_IDCIETC(msg->core), core, msg->extension);
-	idc_write(IPC_IDCITC(msg->core), core, msg->header | IPC_IDCITC_BUSY);
+	/* power up is parsed by ROM of the target core */
+	if (msg->header == IDC_MSG_POWER_UP) {
+		idc_write(IPC_IDCIETC(msg->core), core, msg->extension);
+		idc_write(IPC_IDCITC(msg->core), core,
+			  msg->header | IPC_IDCITC_BUSY);
+		return 0;
+	}
+
+	spin_lock_irq(&idc->lock, flags);
 
-	if (mode == IDC_BLOCKING) {
-		do {
-			idelay(PLATFORM_DEFAULT_DELAY);
-			timeout += PLATFORM_DEFAULT_DELAY;
-			idcietc = idc_read(IPC_IDCIETC(msg->core), core);
-		} while (!(idcietc & IPC_IDCIETC_DONE) &&
-			 timeout < IDC_TIMEOUT);
+	/* wait for free slot, released by execution of older messages */
+	while (queue->head - queue->tail >= IDC_QUEUE_SIZE) {
+		spin_unlock_irq(&idc->lock, flags);
 
 		if (timeout >= IDC_TIMEOUT) {
-			trace_idc_error("arch_idc_send_msg() error: timeout");
-			ret = -ETIME;
+			trace_idc_error("arch_idc_send_msg() error: "
+					"queue full");
+			return -EBUSY;
 		}
+
+		idelay(PLATFORM_DEFAULT_DELAY);
+		timeout += PLATFORM_DEFAULT_DELAY;
+
+		spin_lock_irq(&idc->lock, flags);
+	}
+
+	slot = queue->head & (IDC_QUEUE_SIZE - 1);
+	queue->msg[slot].header = msg->header;
+	queue->msg[slot].extension = msg->extension;
+	if (msg->payload_size)
+		memcpy(queue->msg[slot].payload, msg->payload,
+		       msg->payload_size);
+	msg->seq = queue->head++;
+
+	/* ring doorbell, unless target is still draining its queues */
+	if (!(idc_read(IPC_IDCITC(msg->core), core) & IPC_IDCITC_BUSY)) {
+		idc_write(IPC_IDCIETC(msg->core), core, IDC_MSG_DOORBELL_EXT);
+		idc_write(IPC_IDCITC(msg->core), core,
+			  IDC_MSG_DOORBELL | IPC_IDCITC_BUSY);
 	}
 
 	spin_unlock_irq(&idc->lock, flags);
 
-	return ret;
+	if (mode == IDC_BLOCKING)
+		return arch_idc_wait_msg(msg);
+
+	return 0;
+}
+
+/**
+ * \brief Waits until sent IDC message is executed by the target core.
+ * \param[in] msg Pointer to sent IDC message.
+ * \return Error code, or result of the message.
+ */
+int arch_idc_wait_msg(struct idc_msg *msg)
+{
+	struct idc_queue *queue = idc_queue_get(arch_cpu_get_id(),
+						msg->core);
+	uint32_t timeout = 0;
+
+	while ((int32_t)(queue->tail - msg->seq) <= 0) {
+		if (timeout >= IDC_TIMEOUT) {
+			trace_idc_error("arch_idc_wait_msg() error: timeout");
+			return -ETIME;
+		}
+
+		idelay(PLATFORM_DEFAULT_DELAY);
+		timeout += PLATFORM_DEFAULT_DELAY;
+	}
+
+	return queue->msg[msg->seq & (IDC_QUEUE_SIZE - 1)].ret;
 }
 
 /**
@@ -234,48 +302,82 @@ static int idc_component_command(uint32_t cmd)
 
 /**
  * \brief Executes IDC message based on type.
- * \param[in,out] msg Pointer to IDC message.
+ * \param[in] msg Pointer to queued IDC message.
+ * \return Error code.
  */
-static void idc_cmd(struct idc_msg *msg)
+static int idc_cmd(struct idc_queue_msg *msg)
 {
 	uint32_t type = iTS(msg->header);
 
 	switch (type) {
-	case iTS(IDC_MSG_POWER_DOWN):
-		cpu_power_down_core();
-		break;
 	case iTS(IDC_MSG_PPL_TRIGGER):
-		idc_pipeline_trigger(msg->extension);
-		break;
+		return idc_pipeline_trigger(msg->extension);
 	case iTS(IDC_MSG_COMP_CMD):
-		idc_component_command(msg->extension);
-		break;
+		return idc_component_command(msg->extension);
 	case iTS(IDC_MSG_NOTIFY):
-		notifier_notify();
-		break;
+		return notifier_notify_remote(msg->payload);
 	default:
 		trace_idc_error("idc_cmd() error: invalid msg->header = %u",
 				msg->header);
+		return -EINVAL;
+	}
+}
+
+/**
+ * \brief Executes all IDC messages queued for this core.
+ * \param[in] core Core id.
+ */
+static void idc_queues_execute(int core)
+{
+	struct idc_queue *queue;
+	struct idc_queue_msg *msg;
+	int i;
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		if (i == core)
+			continue;
+
+		queue = idc_queue_get(i, core);
+
+		while (queue->tail != queue->head) {
+			msg = &queue->msg[queue->tail & (IDC_QUEUE_SIZE - 1)];
+
+			/* core doesn't return, so mark message executed */
+			if (msg->header == IDC_MSG_POWER_DOWN) {
+				queue->tail++;
+				cpu_power_down_core();
+			}
+
+			msg->ret = idc_cmd(msg);
+			queue->tail++;
+		}
 	}
 }
 
 /**
- * \brief Handles received IDC message.
+ * \brief Handles received IDC messages.
  * \param[in,out] data Pointer to IDC data.
  */
 static uint64_t idc_do_cmd(void *data)
 {
 	struct idc *idc = data;
 	int core = arch_cpu_get_id();
-	int initiator = idc->received_msg.core;
+	uint32_t idctfc;
+	int i;
 
-	trace_idc("idc_do_cmd()");
+	tracev_idc("idc_do_cmd()");
 
-	idc_cmd(&idc->received_msg);
+	idc_queues_execute(core);
 
-	/* clear BUSY bit */
-	idc_write(IPC_IDCTFC(initiator), core,
-		  idc_read(IPC_IDCTFC(initiator), core) | IPC_IDCTFC_BUSY);
+	/* clear BUSY bits, so initiators ring the doorbell again */
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		idctfc = idc_read(IPC_IDCTFC(i), core);
+		if (idctfc & IPC_IDCTFC_BUSY)
+			idc_write(IPC_IDCTFC(i), core, idctfc);
+	}
+
+	/* messages queued before BUSY was cleared didn't ring */
+	idc_queues_execute(core);
 
 	/* enable BUSY interrupt */
 	idc_write(IPC_IDCCTL, core, idc->busy_bit_mask | idc->done_bit_mask);
@@ -293,13 +395,9 @@ static uint32_t idc_get_busy_bit_mask(int core)
 	uint32_t busy_mask = 0;
 	int i;
 
-	if (core == PLATFORM_MASTER_CORE_ID) {
-		for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
-			if (i != PLATFORM_MASTER_CORE_ID)
-				busy_mask |= IPC_IDCCTL_IDCTBIE(i);
-		}
-	} else {
-		busy_mask = IPC_IDCCTL_IDCTBIE(PLATFORM_MASTER_CORE_ID);
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		if (i != core)
+			busy_mask |= IPC_IDCCTL_IDCTBIE(i);
 	}
 
 	return busy_mask;
@@ -337,6 +435,11 @@ int arch_idc_init(void)
 
 	trace_idc("arch_idc_init()");
 
+	/* queues are shared by all cores */
+	if (core == PLATFORM_MASTER_CORE_ID)
+		idc_queues = rzalloc(RZONE_SYS | RZONE_FLAG_UNCACHED,
+				     SOF_MEM_CAPS_RAM, IDC_QUEUES_SIZE);
+
 	/* initialize idc data */
 	struct idc **idc = idc_get();
 	*idc = rzalloc(RZONE_SYS, SOF_MEM_CAPS_RAM, sizeof(**idc));
@@ -346,7 +449,8 @@ int arch_idc_init(void)
 
 	/* process task */
 	schedule_task_init(&(*idc)->idc_task, SOF_SCHEDULE_EDF,
-			   SOF_TASK_PRI_IDC, idc_do_cmd, *idc, core, 0);
+			   SOF_TASK_PRI_IDC, idc_do_cmd, *idc, core,
+			   SOF_SCHEDULE_FLAG_STATS);
 
 	/* configure interrupt */
 	ret = interrupt_register(PLATFORM_IDC_INTERRUPT(core), IRQ_AUTO_UNMASK,
@@ -355,7 +459,7 @@ int arch_idc_init(void)
 		return ret;
 	interrupt_enable(PLATFORM_IDC_INTERRUPT(core));
 
-	/* enable BUSY and DONE (only for master core) interrupts */
+	/* enable BUSY and DONE interrupts */
 	idc_write(IPC_IDCCTL, core,
 		  (*idc)->busy_bit_mask | (*idc)->done_bit_mask);
 
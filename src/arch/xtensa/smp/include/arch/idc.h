@@ -43,6 +43,7 @@ void cpu_power_down_core(void);
 
 void idc_enable_interrupts(int target_core, int source_core);
 int arch_idc_send_msg(struct idc_msg *msg, uint32_t mode);
+int arch_idc_wait_msg(struct idc_msg *msg);
 int arch_idc_init(void);
 void idc_free(void);
 
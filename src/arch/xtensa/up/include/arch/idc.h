@@ -48,6 +48,13 @@ struct idc_msg;
 static inline int arch_idc_send_msg(struct idc_msg *msg,
 				    uint32_t mode) { return 0; }
 
+/**
+ * \brief Waits until sent IDC message is executed by the target core.
+ * \param[in] msg Pointer to sent IDC message.
+ * \return Error code.
+ */
+static inline int arch_idc_wait_msg(struct idc_msg *msg) { return 0; }
+
 /**
  * \brief Initializes IDC data and registers for interrupt.
  */
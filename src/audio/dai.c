@@ -284,6 +284,20 @@ static void dai_free(struct comp_dev *dev)
 	rfree(dev);
 }
 
+/*
+ * DMA driven pipelines get an interrupt per half of an even DMA buffer.
+ * dai_copy() then moves all the periods the DMA completed since the last
+ * one, so a single copy consumes irq_periods * period_bytes.
+ */
+static uint32_t dai_irq_periods(struct dma_sg_config *config,
+				uint32_t periods)
+{
+	if (config->irq_disabled || periods % 2)
+		return 0;
+
+	return periods / 2;
+}
+
 /* set component audio SSP and DMA configuration */
 static int dai_playback_params(struct comp_dev *dev)
 {
@@ -304,6 +318,8 @@ static int dai_playback_params(struct comp_dev *dev)
 	/* set up local and host DMA elems to reset values */
 	source_config = COMP_GET_CONFIG(dd->dma_buffer->source);
 	buffer_size = source_config->periods_sink * dd->period_bytes;
+	config->irq_periods = dai_irq_periods(config,
+					      source_config->periods_sink);
 
 	/* resize the buffer if space is available to align with period size */
 	err = buffer_set_size(dd->dma_buffer, buffer_size);
@@ -368,6 +384,8 @@ static int dai_capture_params(struct comp_dev *dev)
 	/* set up local and host DMA elems to reset values */
 	sink_config = COMP_GET_CONFIG(dd->dma_buffer->sink);
 	buffer_size = sink_config->periods_source * dd->period_bytes;
+	config->irq_periods = dai_irq_periods(config,
+					      sink_config->periods_source);
 
 	/* resize the buffer if space is available to align with period size */
 	err = buffer_set_size(dd->dma_buffer, buffer_size);
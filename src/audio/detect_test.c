@@ -37,6 +37,9 @@
 #include <sof/notifier.h>
 #include <sof/audio/component.h>
 #include <sof/audio/kpb.h>
+#include <sof/audio/pipeline.h>
+#include <sof/audio/vad.h>
+#include <sof/math/numbers.h>
 #include <uapi/user/detect_test.h>
 
 /* tracing */
@@ -53,16 +56,16 @@
 #define ACTIVATION_DEFAULT_THRESHOLD_S16 \
 	((int16_t)((INT16_MAX) * (ACTIVATION_DEFAULT_THRESHOLD)))
 
-/* number of samples to be treated as a full keyphrase */
+/* number of frames to be treated as a full keyphrase */
 #define KEYPHRASE_DEFAULT_PREAMBLE_LENGTH (30 * 1024)
 
 struct comp_data {
 	struct sof_detect_test_config config;
 	void *load_memory;	/**< synthetic memory load */
-	int16_t activation;
+	struct vad vad;		/**< activation detection stage */
 	uint32_t detected;
 	uint32_t detect_preamble; /**< current keyphrase preamble length */
-	uint32_t keyphrase_samples; /**< keyphrase length in samples */
+	uint32_t keyphrase_samples; /**< keyphrase length in frames */
 	uint32_t buf_copy_pos; /**< current copy position for incoming data */
 
 	struct notify_data event;
@@ -105,6 +108,7 @@ static void notify_kpb(struct comp_dev *dev)
 
 	cd->event.id = NOTIFIER_ID_KPB_CLIENT_EVT;
 	cd->event.target_core_mask = NOTIFIER_TARGET_CORE_ALL_MASK;
+	cd->event.data_size = sizeof(cd->event_data);
 	cd->event.data = &cd->event_data;
 
 	notifier_event(&cd->event);
@@ -121,36 +125,46 @@ static void default_detect_test(struct comp_dev *dev,
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 
-	int16_t *src;
-	int16_t diff;
-	int16_t step;
-	uint32_t count = frames; /**< Assuming single channel */
-	uint32_t sample;
+	bool active;
 
-	/* synthetic load */
-	if (cd->config.load_mips)
+	if (cd->detected)
+		return;
+
+	/* cheap activation stage runs on every period */
+	active = vad_process(&cd->vad, source, frames,
+			     dev->params.channels);
+
+	/* synthetic load of the model, only run on activity */
+	if (active && cd->config.load_mips)
 		idelay(cd->config.load_mips * 1000000);
 
-	/* perform detection within current period */
-	for (sample = 0; sample < count && !cd->detected; ++sample) {
-		src = buffer_read_frag_s16(source, sample);
-		diff = abs(*src) - cd->activation;
-		step = diff >> cd->config.activation_shift;
-
-		/* prevent taking 0 steps when the diff is too low */
-		cd->activation += !step ? diff : step;
-
-		if (cd->detect_preamble >= cd->keyphrase_samples) {
-			if (cd->activation >= cd->config.activation_threshold) {
-				detect_test_notify(dev);
-				cd->detected = 1;
-			}
-		} else {
-			++cd->detect_preamble;
-		}
+	if (cd->detect_preamble < cd->keyphrase_samples) {
+		cd->detect_preamble = MIN(cd->detect_preamble + frames,
+					  cd->keyphrase_samples);
+		return;
+	}
+
+	if (active) {
+		detect_test_notify(dev);
+		cd->detected = 1;
 	}
 }
 
+static void test_keyword_vad_init(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct vad_config config;
+
+	config.shift = cd->config.activation_shift;
+	config.threshold = cd->config.activation_threshold;
+	config.decimation = cd->config.decimation;
+	config.mode = cd->config.channel_mode;
+	config.hangover = cd->config.hangover *
+			  (dev->params.rate / 1000);
+
+	vad_init(&cd->vad, &config, dev->comp.id);
+}
+
 static void free_mem_load(struct comp_data *cd)
 {
 	if (!cd) {
@@ -198,6 +212,8 @@ static void test_keyword_set_default_config(struct comp_dev *dev)
 	cd->keyphrase_samples = KEYPHRASE_DEFAULT_PREAMBLE_LENGTH;
 	cd->config.activation_shift = ACTIVATION_DEFAULT_SHIFT;
 	cd->config.activation_threshold = ACTIVATION_DEFAULT_THRESHOLD_S16;
+
+	test_keyword_vad_init(dev);
 }
 
 static struct comp_dev *test_keyword_new(struct sof_ipc_comp *comp)
@@ -234,9 +250,9 @@ static struct comp_dev *test_keyword_new(struct sof_ipc_comp *comp)
 	/* using default processing function */
 	cd->detect_func = default_detect_test;
 
+	comp_set_drvdata(dev, cd);
 	test_keyword_set_default_config(dev);
 
-	comp_set_drvdata(dev, cd);
 	dev->state = COMP_STATE_READY;
 	return dev;
 }
@@ -257,12 +273,11 @@ static int test_keyword_params(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 
-	/* TODO: remove in the future */
-	dev->params.channels = 1;
-
-	if (dev->params.channels != 1) {
-		trace_keyword_error("test_keyword_params() "
-				    "error: only single-channel supported");
+	if (!dev->params.channels ||
+	    dev->params.channels > VAD_MAX_CHANNELS) {
+		trace_keyword_error("test_keyword_params() error: "
+				    "unsupported channels %u",
+				    dev->params.channels);
 		return -EINVAL;
 	}
 
@@ -288,6 +303,9 @@ static int test_keyword_params(struct comp_dev *dev)
 		cd->keyphrase_samples = KEYPHRASE_DEFAULT_PREAMBLE_LENGTH;
 	}
 
+	/* hangover depends on the rate */
+	test_keyword_vad_init(dev);
+
 	return 0;
 }
 
@@ -320,6 +338,8 @@ static int test_keyword_set_config(struct comp_dev *dev,
 		cd->config.activation_threshold =
 			ACTIVATION_DEFAULT_THRESHOLD_S16;
 
+	test_keyword_vad_init(dev);
+
 	return alloc_mem_load(cd, cd->config.load_memory_size);
 }
 
@@ -563,17 +583,30 @@ static int test_keyword_trigger(struct comp_dev *dev, int cmd)
 	    cmd == COMP_TRIGGER_RELEASE) {
 		cd->detect_preamble = 0;
 		cd->detected = 0;
-		cd->activation = 0;
+		vad_reset(&cd->vad);
 	}
 
 	return ret;
 }
 
+/* copy samples to optional downstream buffer */
+static void test_keyword_pass(struct comp_buffer *source,
+			      struct comp_buffer *sink, uint32_t samples)
+{
+	uint32_t i;
+
+	for (i = 0; i < samples; i++)
+		*(int16_t *)buffer_write_frag_s16(sink, i) =
+			*(int16_t *)buffer_read_frag_s16(source, i);
+}
+
 /*  process stream data from source buffer */
 static int test_keyword_copy(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct comp_buffer *source;
+	struct comp_buffer *sink;
+	uint32_t frames;
 
 	tracev_keyword("test_keyword_copy()");
 
@@ -592,9 +625,31 @@ static int test_keyword_copy(struct comp_dev *dev)
 		return -EIO;	/* xrun */
 	}
 
-	/* copy and perform detection */
-	cd->detect_func(dev, source,
-			source->avail / comp_frame_bytes(source->source));
+	frames = source->avail / comp_frame_bytes(source->source);
+
+	/* perform detection */
+	cd->detect_func(dev, source, frames);
+
+	/* Downstream components, if any, only run during activity.
+	 * Otherwise the data is dropped and the rest of the path is
+	 * stopped for this period.
+	 */
+	if (!list_is_empty(&dev->bsink_list)) {
+		if (!cd->vad.active) {
+			comp_update_buffer_consume(source, source->avail);
+			return PPL_STATUS_PATH_STOP;
+		}
+
+		sink = list_first_item(&dev->bsink_list,
+				       struct comp_buffer, source_list);
+		frames = MIN(frames, sink->free / comp_frame_bytes(dev));
+		test_keyword_pass(source, sink, frames * dev->params.channels);
+		comp_update_buffer_produce(sink,
+					   frames * comp_frame_bytes(dev));
+		comp_update_buffer_consume(source,
+					   frames * comp_frame_bytes(dev));
+		return 0;
+	}
 
 	/* calc new available */
 	comp_update_buffer_consume(source, source->avail);
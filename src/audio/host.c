@@ -69,6 +69,10 @@ struct hc_buf {
  * multiple of host_period_bytes.
  *
  * host_size is the host buffer size (in bytes) specified in the IPC parameters.
+ *
+ * Transfers move whole periods, as many as the local buffer allows. Playback
+ * waits for copy_bytes of free space, so deep buffers are refilled in large
+ * batches instead of once per period.
  */
 struct host_data {
 	/* local DMA config */
@@ -79,6 +83,7 @@ struct host_data {
 
 	uint32_t period_bytes;	/**< Size of a single period (in bytes) */
 	uint32_t period_count;	/**< Number of periods */
+	uint32_t copy_bytes;	/**< Minimum size of a transfer (in bytes) */
 
 	/* host position reporting related */
 	uint32_t host_size;	/**< Host buffer size (in bytes) */
@@ -95,7 +100,7 @@ struct host_data {
 	/* pointers set during params to host or local above */
 	struct hc_buf *source;
 	struct hc_buf *sink;
-	uint32_t split_remaining;
+	uint32_t pending_bytes;	/**< Bytes left in the current transfer */
 #endif
 
 	/* stream info */
@@ -116,16 +121,51 @@ static inline struct dma_sg_elem *next_buffer(struct hc_buf *hc)
 	return hc->elem_array.elems + hc->current;
 }
 
+/* size of next transfer of bytes, split at source or sink elem end */
+static uint32_t host_next_size(struct host_data *hd, uint32_t bytes)
+{
+	struct dma_sg_elem *local_elem = hd->config.elem_array.elems;
+
+	if (local_elem->src + bytes > hd->source->current_end)
+		bytes = hd->source->current_end - local_elem->src;
+	if (local_elem->dest + bytes > hd->sink->current_end)
+		bytes = hd->sink->current_end - local_elem->dest;
+
+	return bytes;
+}
+
+/* merge elems following each other in memory, unused addresses are 0 */
+static void host_elems_coalesce(struct dma_sg_elem_array *elem_array)
+{
+	struct dma_sg_elem *elems = elem_array->elems;
+	struct dma_sg_elem *last = elems;
+	int i;
+
+	for (i = 1; i < elem_array->count; i++) {
+		if ((!elems[i].src || elems[i].src == last->src + last->size) &&
+		    (!elems[i].dest ||
+		     elems[i].dest == last->dest + last->size)) {
+			last->size += elems[i].size;
+			continue;
+		}
+
+		*++last = elems[i];
+	}
+
+	elem_array->count = last - elems + 1;
+}
+
 #endif
 
 /*
- * Host period copy between DSP and host DMA completion.
+ * Host copy between DSP and host DMA completion.
  * This is called  by DMA driver every time when DMA completes its current
  * transfer between host and DSP. The host memory is not guaranteed to be
  * continuous and also not guaranteed to have a period/buffer size that is a
  * multiple of the DSP period size. This means we must check we do not
  * overflow host period/buffer/page boundaries on each transfer and split the
- * DMA transfer if we do overflow.
+ * DMA transfer if we do overflow. The rest of a split transfer is started
+ * right away.
  */
 static void host_dma_cb(void *data, uint32_t type, struct dma_sg_elem *next)
 {
@@ -137,9 +177,6 @@ static void host_dma_cb(void *data, uint32_t type, struct dma_sg_elem *next)
 	struct dma_sg_elem *local_elem;
 	struct dma_sg_elem *source_elem;
 	struct dma_sg_elem *sink_elem;
-	uint32_t next_size;
-	uint32_t need_copy = 0;
-	uint32_t period_bytes = hd->period_bytes;
 	uint32_t bytes;
 
 	local_elem = hd->config.elem_array.elems;
@@ -165,15 +202,17 @@ static void host_dma_cb(void *data, uint32_t type, struct dma_sg_elem *next)
 
 	/* buffer overlap, hard code host buffer size at the moment ? */
 	if (hd->local_pos >= hd->host_size)
-		hd->local_pos = 0;
+		hd->local_pos -= hd->host_size;
 
 	/* NO_IRQ mode if host_period_size == 0 */
 	if (dev->params.host_period_bytes != 0) {
 		hd->report_pos += bytes;
 
-		/* send IPC message to driver if needed */
+		/* send IPC message to driver if needed, a transfer may cover
+		 * several host periods, only the latest one is reported
+		 */
 		if (hd->report_pos >= dev->params.host_period_bytes) {
-			hd->report_pos = 0;
+			hd->report_pos %= dev->params.host_period_bytes;
 
 			/* send timestamped position to host
 			 * (updates position first, by calling ops.position())
@@ -202,38 +241,19 @@ static void host_dma_cb(void *data, uint32_t type, struct dma_sg_elem *next)
 		local_elem->dest = sink_elem->dest;
 	}
 
-	/* calc size of next transfer */
-	next_size = period_bytes;
-	if (local_elem->src + next_size > hd->source->current_end)
-		next_size = hd->source->current_end - local_elem->src;
-	if (local_elem->dest + next_size > hd->sink->current_end)
-		next_size = hd->sink->current_end - local_elem->dest;
-
-	/* are we dealing with a split transfer ? */
-	if (!hd->split_remaining) {
-
-		/* no, is next transfer split ? */
-		if (next_size != period_bytes)
-			hd->split_remaining = period_bytes - next_size;
-	} else {
-
-		/* yes, than calc transfer size */
-		need_copy = 1;
-		next_size = next_size < hd->split_remaining ?
-			next_size : hd->split_remaining;
-		hd->split_remaining -= next_size;
-	}
-	local_elem->size = next_size;
-
-	/* schedule immediate split transfer if needed */
-	if (need_copy) {
-		next->src = local_elem->src;
-		next->dest = local_elem->dest;
-		next->size = local_elem->size;
+	/* transfer done ? */
+	hd->pending_bytes -= bytes;
+	if (!hd->pending_bytes) {
+		next->size = DMA_RELOAD_END;
 		return;
 	}
 
-	next->size = DMA_RELOAD_END;
+	/* no, schedule immediate split transfer */
+	local_elem->size = host_next_size(hd, hd->pending_bytes);
+
+	next->src = local_elem->src;
+	next->dest = local_elem->dest;
+	next->size = local_elem->size;
 #endif
 }
 
@@ -260,6 +280,14 @@ static int create_local_elems(struct comp_dev *dev, uint32_t buffer_count,
 				 "dma_sg_alloc() failed");
 		return err;
 	}
+
+#if !CONFIG_DMA_GW
+	/* local buffer is contiguous, so transfers are only split at
+	 * host page boundaries
+	 */
+	host_elems_coalesce(elem_array);
+#endif
+
 	return 0;
 }
 
@@ -475,12 +503,11 @@ static void host_buffer_cb(void *data, uint32_t bytes)
 		return;
 	}
 
-	/* calculate minimum size to copy */
+	/* calculate minimum size to copy, in whole periods */
 	copy_bytes = dev->params.direction == SOF_IPC_STREAM_PLAYBACK ?
 		MIN(avail_bytes, hd->dma_buffer->free) :
 		MIN(hd->dma_buffer->avail, free_bytes);
-
-	copy_bytes = MIN(copy_bytes, bytes);
+	copy_bytes -= copy_bytes % hd->period_bytes;
 
 	tracev_host("host_buffer_cb(), copy_bytes = 0x%x", copy_bytes);
 
@@ -488,6 +515,9 @@ static void host_buffer_cb(void *data, uint32_t bytes)
 		flags |= DMA_COPY_BLOCKING;
 
 #if CONFIG_DMA_GW
+	if (!copy_bytes || copy_bytes < hd->copy_bytes)
+		return;
+
 	ret = dma_copy(hd->dma, hd->chan, copy_bytes, flags);
 	if (ret < 0)
 		trace_host_error("host_buffer_cb() error: dma_copy() failed, "
@@ -570,6 +600,11 @@ static int host_params(struct comp_dev *dev)
 		return -EINVAL;
 	}
 
+	/* deep playback buffers are refilled once half of them is free */
+	hd->copy_bytes = hd->period_bytes;
+	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK)
+		hd->copy_bytes *= MAX(hd->period_count / 2, 1);
+
 	/* resize the buffer if space is available to align with period size */
 	buffer_size = hd->period_count * hd->period_bytes;
 	err = buffer_set_size(hd->dma_buffer, buffer_size);
@@ -644,7 +679,7 @@ static int host_prepare(struct comp_dev *dev)
 	hd->local_pos = 0;
 	hd->report_pos = 0;
 #if !CONFIG_DMA_GW
-	hd->split_remaining = 0;
+	hd->pending_bytes = 0;
 #endif
 	dev->position = 0;
 
@@ -688,6 +723,9 @@ static int host_buffer(struct comp_dev *dev,
 
 	hd->host.elem_array = *elem_array;
 
+	/* host pages are often contiguous */
+	host_elems_coalesce(&hd->host.elem_array);
+
 	return 0;
 }
 #endif
@@ -731,19 +769,43 @@ static int host_reset(struct comp_dev *dev)
 }
 
 #if !CONFIG_DMA_GW
-/* perform one shot copy from source to sink buffers */
+/* perform one shot copy of all whole periods from source to sink buffers */
 static int host_copy_one_shot(struct comp_dev *dev)
 {
 	struct host_data *hd = comp_get_drvdata(dev);
+	struct dma_sg_elem *local_elem = hd->config.elem_array.elems;
+	uint32_t bytes;
 	int ret;
 
+	/* previous transfer is still running */
+	if (hd->pending_bytes)
+		return 0;
+
+	bytes = dev->params.direction == SOF_IPC_STREAM_PLAYBACK ?
+		hd->dma_buffer->free : hd->dma_buffer->avail;
+	bytes -= bytes % hd->period_bytes;
+
+	/* preload fills whatever is free */
+	if (!bytes || (bytes < hd->copy_bytes &&
+		       !pipeline_is_preload(dev->pipeline)))
+		return 0;
+
+	hd->pending_bytes = bytes;
+	local_elem->size = host_next_size(hd, bytes);
+
 	/* do DMA transfer */
 	ret = dma_set_config(hd->dma, hd->chan, &hd->config);
 	if (ret < 0)
-		return ret;
+		goto err;
 
 	ret = dma_start(hd->dma, hd->chan);
+	if (ret < 0)
+		goto err;
+
+	return 0;
 
+err:
+	hd->pending_bytes = 0;
 	return ret;
 }
 #endif
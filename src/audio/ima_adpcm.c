@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file audio/ima_adpcm.c
+ * \brief IMA-ADPCM block codec, 4:1 compression of 16 bit samples
+ */
+
+#include <sof/audio/ima_adpcm.h>
+#include <sof/string.h>
+
+#define IMA_ADPCM_INDEX_MAX	88
+
+static const int8_t ima_adpcm_index_table[16] = {
+	-1, -1, -1, -1, 2, 4, 6, 8,
+	-1, -1, -1, -1, 2, 4, 6, 8,
+};
+
+static const int16_t ima_adpcm_step_table[IMA_ADPCM_INDEX_MAX + 1] = {
+	7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+	19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+	50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+	130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+	337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+	876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+	2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+	5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+	15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+/* Apply a code to the channel state, shared by encoder and decoder
+ * so both track exactly the same predictor.
+ */
+static inline int16_t ima_adpcm_update(struct ima_adpcm_state *state,
+				       uint8_t code)
+{
+	int step = ima_adpcm_step_table[state->index];
+	int diff = step >> 3;
+	int predictor = state->predictor;
+	int index;
+
+	if (code & 4)
+		diff += step;
+	if (code & 2)
+		diff += step >> 1;
+	if (code & 1)
+		diff += step >> 2;
+
+	predictor += (code & 8) ? -diff : diff;
+	if (predictor > INT16_MAX)
+		predictor = INT16_MAX;
+	else if (predictor < INT16_MIN)
+		predictor = INT16_MIN;
+
+	index = state->index + ima_adpcm_index_table[code];
+	if (index < 0)
+		index = 0;
+	else if (index > IMA_ADPCM_INDEX_MAX)
+		index = IMA_ADPCM_INDEX_MAX;
+
+	state->predictor = predictor;
+	state->index = index;
+
+	return predictor;
+}
+
+static inline uint8_t ima_adpcm_encode(struct ima_adpcm_state *state,
+				       int16_t sample)
+{
+	int step = ima_adpcm_step_table[state->index];
+	int diff = sample - state->predictor;
+	uint8_t code = 0;
+
+	if (diff < 0) {
+		code = 8;
+		diff = -diff;
+	}
+
+	if (diff >= step) {
+		code |= 4;
+		diff -= step;
+	}
+	step >>= 1;
+	if (diff >= step) {
+		code |= 2;
+		diff -= step;
+	}
+	step >>= 1;
+	if (diff >= step)
+		code |= 1;
+
+	ima_adpcm_update(state, code);
+
+	return code;
+}
+
+/**
+ * \brief Encode a block of interleaved samples.
+ * \param[in,out] state Per channel encoder state, carried between blocks.
+ * \param[in] pcm Interleaved samples, frames * channels of them.
+ * \param[out] block Encoded block, IMA_ADPCM_BLOCK_SIZE() bytes.
+ * \param[in] frames Number of frames, frames * channels must be even.
+ * \param[in] channels Number of channels.
+ */
+void ima_adpcm_encode_block(struct ima_adpcm_state *state,
+			    const int16_t *pcm, uint8_t *block,
+			    int frames, int channels)
+{
+	int samples = frames * channels;
+	uint8_t *codes;
+	uint8_t code;
+	int i;
+
+	/* header carries the state decoding has to start from */
+	memcpy(block, state, channels * sizeof(*state));
+	codes = block + channels * sizeof(*state);
+
+	for (i = 0; i < samples; i++) {
+		code = ima_adpcm_encode(&state[i % channels], pcm[i]);
+		if (i & 1)
+			codes[i >> 1] |= code << 4;
+		else
+			codes[i >> 1] = code;
+	}
+}
+
+/**
+ * \brief Decode a block of interleaved samples.
+ * \param[in] block Encoded block.
+ * \param[out] pcm Interleaved samples, frames * channels of them.
+ * \param[in] frames Number of frames, as used for encoding.
+ * \param[in] channels Number of channels, as used for encoding.
+ */
+void ima_adpcm_decode_block(const uint8_t *block, int16_t *pcm,
+			    int frames, int channels)
+{
+	struct ima_adpcm_state state;
+	int samples = frames * channels;
+	const uint8_t *codes = block + channels * sizeof(state);
+	uint8_t code;
+	int ch;
+	int i;
+
+	for (ch = 0; ch < channels; ch++) {
+		memcpy(&state, block + ch * sizeof(state), sizeof(state));
+
+		for (i = ch; i < samples; i += channels) {
+			code = (codes[i >> 1] >> ((i & 1) << 2)) & 0xf;
+			pcm[i] = ima_adpcm_update(&state, code);
+		}
+	}
+}
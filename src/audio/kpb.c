@@ -41,6 +41,7 @@
 #include <sof/ipc.h>
 #include <sof/audio/component.h>
 #include <sof/audio/kpb.h>
+#include <sof/audio/ima_adpcm.h>
 #include <sof/list.h>
 #include <sof/audio/buffer.h>
 #include <sof/ut.h>
@@ -51,25 +52,44 @@ struct comp_data {
 	uint32_t kpb_no_of_clients; /**< number of registered clients */
 	struct kpb_client clients[KPB_MAX_NO_OF_CLIENTS];
 	struct notifier kpb_events; /**< KPB events object */
-	struct task draining_task;
+	struct task draining_task[KPB_MAX_NO_OF_CLIENTS]; /**< per client */
 	uint32_t source_period_bytes; /**< source number of period bytes */
 	uint32_t sink_period_bytes; /**< sink number of period bytes */
 	struct sof_kpb_config config;   /**< component configuration data */
 	struct comp_buffer *rt_sink; /**< real time sink (channel selector ) */
-	struct comp_buffer *cli_sink; /**< draining sink (client) */
+	/**< default draining sinks (clients) */
+	struct comp_buffer *cli_sinks[KPB_MAX_NO_OF_CLIENTS];
 	struct hb *history_buffer;
 	bool is_internal_buffer_full;
 	size_t buffered_data;
-	struct dd draining_task_data;
+	struct dd draining_task_data[KPB_MAX_NO_OF_CLIENTS]; /**< per client */
+	spinlock_t lock; /**< protects draining data shared with copy */
+	size_t hb_block_size; /**< encoded history block size, 0 for PCM */
+	/**< history encoder state, per channel */
+	struct ima_adpcm_state enc_state[KPB_MAX_SUPPORTED_CHANNELS];
+	int16_t enc_pcm[KPB_ADPCM_BLOCK_SAMPLES]; /**< block being encoded */
+	uint32_t enc_samples; /**< samples collected in enc_pcm */
 };
 
 /*! KPB private functions */
 static void kpb_event_handler(int message, void *cb_data, void *event_data);
 static int kpb_register_client(struct comp_data *kpb, struct kpb_client *cli);
+static void kpb_unregister_client(struct comp_data *kpb,
+				  struct kpb_client *cli);
 static void kpb_init_draining(struct comp_data *kpb, struct kpb_client *cli);
 static uint64_t kpb_draining_task(void *arg);
+static size_t kpb_drain_client(struct dd *draining_data, size_t max);
+static void kpb_update_client(struct comp_data *kpb, int id, size_t size);
+static void kpb_seek_oldest(struct comp_data *kpb, struct dd *draining_data,
+			    size_t skip);
 static void kpb_buffer_data(struct comp_data *kpb, struct comp_buffer *source,
-			    size_t size);
+			    struct comp_buffer *sink, size_t size);
+static size_t kpb_encode_data(struct comp_data *kpb,
+			      struct comp_buffer *source,
+			      struct comp_buffer *sink, size_t size);
+static void kpb_write_history(struct comp_data *kpb, void *data, size_t size);
+static struct hb *kpb_next_write_buffer(struct comp_data *kpb,
+					struct hb *buff);
 static size_t kpb_allocate_history_buffer(struct comp_data *kpb);
 static void kpb_clear_history_buffer(struct hb *buff);
 static void kpb_free_history_buffer(struct hb *buff);
@@ -90,6 +110,7 @@ static struct comp_dev *kpb_new(struct sof_ipc_comp *comp)
 	struct comp_dev *dev;
 	struct comp_data *cd;
 	size_t allocated_size;
+	int i;
 
 	trace_kpb("kpb_new()");
 
@@ -114,6 +135,13 @@ static struct comp_dev *kpb_new(struct sof_ipc_comp *comp)
 
 	comp_set_drvdata(dev, cd);
 
+	if (bs > sizeof(cd->config)) {
+		trace_kpb_error("kpb_new() error: "
+		"config data size %u is too big", bs);
+		return NULL;
+	}
+
+	/* Older topologies may not carry all of the fields */
 	memcpy(&cd->config, ipc_process->data, bs);
 
 	if (cd->config.no_channels > KPB_MAX_SUPPORTED_CHANNELS) {
@@ -140,6 +168,21 @@ static struct comp_dev *kpb_new(struct sof_ipc_comp *comp)
 		return NULL;
 	}
 
+	switch (cd->config.codec) {
+	case KPB_CODEC_NONE:
+		cd->hb_block_size = 0;
+		break;
+	case KPB_CODEC_IMA_ADPCM:
+		cd->hb_block_size =
+			IMA_ADPCM_BLOCK_SIZE(KPB_ADPCM_BLOCK_FRAMES,
+					     cd->config.no_channels);
+		break;
+	default:
+		trace_kpb_error("kpb_new() error: "
+		"requested history codec not supported");
+		return NULL;
+	}
+
 	dev->state = COMP_STATE_READY;
 
 	/* Zero number of clients */
@@ -158,6 +201,16 @@ static struct comp_dev *kpb_new(struct sof_ipc_comp *comp)
 		return NULL;
 	}
 
+	/* Draining tasks live as long as the component, freed by kpb_free */
+	for (i = 0; i < KPB_MAX_NO_OF_CLIENTS; i++)
+		schedule_task_init(&cd->draining_task[i], /* task structure */
+				   SOF_SCHEDULE_LL, /* periodic LL task */
+				   SOF_TASK_PRI_MED, /* below pipelines */
+				   kpb_draining_task, /* task function */
+				   &cd->draining_task_data[i], /* task data */
+				   0, /* core on which we should run */
+				   SOF_SCHEDULE_FLAG_STATS); /* freed by kpb */
+
 	return dev;
 }
 
@@ -298,12 +351,16 @@ static void kpb_free_history_buffer(struct hb *buff)
 static void kpb_free(struct comp_dev *dev)
 {
 	struct comp_data *kpb = comp_get_drvdata(dev);
+	int i;
 
 	trace_kpb("kpb_free()");
 
 	/* Reclaim memory occupied by history buffer */
 	kpb_free_history_buffer(kpb->history_buffer);
 
+	for (i = 0; i < KPB_MAX_NO_OF_CLIENTS; i++)
+		schedule_task_free(&kpb->draining_task[i]);
+
 	/* Free KPB */
 	rfree(kpb);
 	rfree(dev);
@@ -350,14 +407,19 @@ static int kpb_prepare(struct comp_dev *dev)
 	/* Init private data */
 	cd->kpb_no_of_clients = 0;
 	cd->buffered_data = 0;
+	cd->enc_samples = 0;
+	bzero(cd->enc_state, sizeof(cd->enc_state));
 
 	/* Init history buffer */
 	kpb_clear_history_buffer(cd->history_buffer);
 
+	spinlock_init(&cd->lock);
+
 	/* Initialize clients data */
 	for (i = 0; i < KPB_MAX_NO_OF_CLIENTS; i++) {
 		cd->clients[i].state = KPB_CLIENT_UNREGISTERED;
 		cd->clients[i].r_ptr = NULL;
+		cd->cli_sinks[i] = NULL;
 	}
 
 	/* Initialize KPB events */
@@ -368,19 +430,12 @@ static int kpb_prepare(struct comp_dev *dev)
 	/* Register KPB for async notification */
 	notifier_register(&cd->kpb_events);
 
-	/* Initialize draining task */
-	schedule_task_init(&cd->draining_task, /* task structure */
-			   SOF_SCHEDULE_EDF, /* utilize EDF scheduler */
-			   0, /* priority doesn't matter for IDLE tasks */
-			   kpb_draining_task, /* task function */
-			   &cd->draining_task_data, /* task private data */
-			   0, /* core on which we should run */
-			   0); /* not used flags */
-
 	/* Search for KPB related sinks.
 	 * NOTE! We assume here that channel selector component device
-	 * is connected to the KPB sinks as well as host device.
+	 * is connected to the KPB sinks as well as host device/s.
+	 * Host sinks become default sinks of clients in order.
 	 */
+	i = 0;
 	list_for_item(blist, &dev->bsink_list) {
 		sink = container_of(blist, struct comp_buffer, source_list);
 
@@ -391,9 +446,10 @@ static int kpb_prepare(struct comp_dev *dev)
 		if (sink->sink->comp.type == SOF_COMP_SELECTOR) {
 			/* We found proper real time sink */
 			cd->rt_sink = sink;
-		} else if (sink->sink->comp.type == SOF_COMP_HOST) {
+		} else if (sink->sink->comp.type == SOF_COMP_HOST &&
+			   i < KPB_MAX_NO_OF_CLIENTS) {
 			/* We found proper host sink */
-			cd->cli_sink = sink;
+			cd->cli_sinks[i++] = sink;
 		}
 	}
 
@@ -428,22 +484,32 @@ static void kpb_cache(struct comp_dev *dev, int cmd)
 static int kpb_reset(struct comp_dev *dev)
 {
 	struct comp_data *kpb = comp_get_drvdata(dev);
+	int i;
 
 	trace_kpb("kpb_reset()");
 
+	/* Stop draining, if any */
+	for (i = 0; i < KPB_MAX_NO_OF_CLIENTS; i++) {
+		schedule_task_cancel(&kpb->draining_task[i]);
+		if (kpb->clients[i].state != KPB_CLIENT_UNREGISTERED)
+			kpb->clients[i].state = KPB_CLIENT_BUFFERING;
+	}
+	kpb->state = KPB_STATE_BUFFERING;
+
 	/* Reset history buffer */
 	kpb->is_internal_buffer_full = false;
 	kpb_clear_history_buffer(kpb->history_buffer);
 	/* Reset amount of buffered data */
 	kpb->buffered_data = 0;
+	kpb->enc_samples = 0;
+	bzero(kpb->enc_state, sizeof(kpb->enc_state));
 
 	return comp_set_state(dev, COMP_TRIGGER_RESET);
 }
 
 /**
- * \brief Copy real time input stream into sink buffer,
- *	and in the same time buffers that input for
- *	later use by some of clients.
+ * \brief Buffer real time input stream in the history buffer
+ *	for later use by clients and serve the sink out of it.
  *
  *\param[in] dev - kpb component device pointer.
  *
@@ -456,25 +522,31 @@ static int kpb_copy(struct comp_dev *dev)
 	int ret = 0;
 	struct comp_data *kpb = comp_get_drvdata(dev);
 	struct comp_buffer *source;
-	struct comp_buffer *sink;
+	struct comp_buffer *sink = NULL;
 	size_t copy_bytes = 0;
+	size_t history_bytes;
+	int i;
 
 	tracev_kpb("kpb_copy()");
 
-	/* Get source and sink buffers */
+	/* Get source buffer */
 	source = list_first_item(&dev->bsource_list, struct comp_buffer,
 				 sink_list);
-	sink = (kpb->state == KPB_STATE_BUFFERING) ? kpb->rt_sink
-	       : kpb->cli_sink;
+
+	/* Get sink buffer. Once clients are drained the real time sink
+	 * is paused and clients are served out of history buffer.
+	 */
+	if (kpb->state == KPB_STATE_BUFFERING)
+		sink = kpb->rt_sink;
 
 	/* Process source data */
 	/* Check if there are valid pointers */
-	if (!source || !sink)
+	if (!source || (!sink && kpb->state != KPB_STATE_DRAINING))
 		return -EIO;
-	if (!source->r_ptr || !sink->w_ptr)
+	if (!source->r_ptr || (sink && !sink->w_ptr))
 		return -EINVAL;
 	/* Check if there is enough free/available space */
-	if (sink->free == 0) {
+	if (sink && sink->free == 0) {
 		trace_kpb_error("kpb_copy() error: "
 				"sink component buffer"
 				" has not enough free bytes for copy");
@@ -491,100 +563,212 @@ static int kpb_copy(struct comp_dev *dev)
 		return -EIO;
 	}
 
-	/* Sink and source are both ready and have space */
-	copy_bytes = MIN(sink->free, source->avail);
-	memcpy(sink->w_ptr, source->r_ptr, copy_bytes);
+	/* Sink and source are both ready and have space. The history
+	 * buffer is a ring, larger copies only overwrite its oldest data.
+	 */
+	copy_bytes = sink ? MIN(sink->free, source->avail) : source->avail;
 
 	/* Buffer source data internally in history buffer for future
-	 * use by clients.
+	 * use by clients and fill the sink from there. Encoded history
+	 * only grows by whole blocks.
 	 */
-	if (source->avail <= KPB_MAX_BUFFER_SIZE) {
-		kpb_buffer_data(kpb, source, copy_bytes);
-
-		if (kpb->buffered_data < KPB_MAX_BUFFER_SIZE)
-			kpb->buffered_data += copy_bytes;
-		else
-			kpb->is_internal_buffer_full = true;
+	if (kpb->hb_block_size) {
+		history_bytes = kpb_encode_data(kpb, source, sink,
+						copy_bytes);
+	} else {
+		kpb_buffer_data(kpb, source, sink, copy_bytes);
+		history_bytes = copy_bytes;
 	}
 
-	comp_update_buffer_produce(sink, copy_bytes);
+	if (kpb->buffered_data < KPB_MAX_BUFFER_SIZE)
+		kpb->buffered_data += history_bytes;
+	else
+		kpb->is_internal_buffer_full = true;
+
+	if (sink)
+		comp_update_buffer_produce(sink, copy_bytes);
 	comp_update_buffer_consume(source, copy_bytes);
 
+	/* Pass new data on to draining clients */
+	for (i = 0; i < KPB_MAX_NO_OF_CLIENTS; i++)
+		kpb_update_client(kpb, i, history_bytes);
+
 	return ret;
 }
 
 /**
  * \brief Buffer real time data stream in
- *	the internal buffer.
+ *	the internal buffer and pass it on to the sink.
+ *
+ * Source data is read once and stored to both the history buffer and
+ * the sink. This goes in linear spans which never cross a wrap of the
+ * source, the sink or the history buffer block. Sink may be NULL, in
+ * which case data is only buffered.
  *
  * \param[in] kpb - KPB component data pointer.
  * \param[in] source pointer to the buffer source.
+ * \param[in] sink pointer to the buffer sink or NULL.
+ * \param[in] size number of bytes to buffer.
  *
  */
 static void kpb_buffer_data(struct comp_data *kpb, struct comp_buffer *source,
-			    size_t size)
+			    struct comp_buffer *sink, size_t size)
 {
 	size_t size_to_copy = size;
-	size_t space_avail;
+	size_t span;
 	struct hb *buff = kpb->history_buffer;
 	void *read_ptr = source->r_ptr;
+	void *write_ptr = sink ? sink->w_ptr : NULL;
 
 	tracev_kpb("kpb_buffer_data()");
 
 	/* Let's store audio stream data in internal history buffer */
 	while (size_to_copy) {
-		/* Check how much space there is in current write buffer */
-		space_avail = (uint32_t)buff->end_addr - (uint32_t)buff->w_ptr;
-
-		if (size_to_copy > space_avail) {
-			/* We have more data to copy than available space
-			 * in this buffer, copy what's available and continue
-			 * with next buffer.
-			 */
-			memcpy(buff->w_ptr, read_ptr, space_avail);
-			/* Update write pointer & requested copy size */
-			buff->w_ptr += space_avail;
-			size_to_copy = size_to_copy - space_avail;
-			/* Update sink read pointer before continuing
-			 * with next buffer.
-			 */
-			read_ptr += space_avail;
-		} else {
-			/* Requested size is smaller or equal to the space
-			 * available in this buffer. In this scenario simply
-			 * copy what was requested.
-			 */
-			memcpy(buff->w_ptr, read_ptr, size_to_copy);
-			/* Update write pointer & requested copy size */
-			buff->w_ptr += size_to_copy;
-			/* Reset requested copy size */
-			size_to_copy = 0;
+		/* Find the longest linear span we can handle at once */
+		span = (uint32_t)buff->end_addr - (uint32_t)buff->w_ptr;
+		span = MIN(span, (uint32_t)source->end_addr -
+			   (uint32_t)read_ptr);
+		if (sink)
+			span = MIN(span, (uint32_t)sink->end_addr -
+				   (uint32_t)write_ptr);
+		span = MIN(span, size_to_copy);
+
+		/* source is read once, sink is served from the history */
+		memcpy(buff->w_ptr, read_ptr, span);
+		if (sink)
+			memcpy(write_ptr, buff->w_ptr, span);
+
+		/* Update pointers & requested copy size */
+		buff->w_ptr += span;
+		size_to_copy -= span;
+
+		read_ptr += span;
+		if (read_ptr >= source->end_addr)
+			read_ptr = source->addr;
+
+		if (sink) {
+			write_ptr += span;
+			if (write_ptr >= sink->end_addr)
+				write_ptr = sink->addr;
 		}
+
 		/* Have we filled whole buffer? */
-		if (buff->w_ptr == buff->end_addr) {
-			/* Reset write pointer back to the beginning
-			 * of the buffer.
-			 */
-			buff->w_ptr = buff->start_addr;
-			/* If we have more buffers use them */
-			if (buff->next && buff->next != buff) {
-				/* Mark current buffer FULL */
-				buff->state = KPB_BUFFER_FULL;
-				/* Use next buffer available on the list
-				 * of buffers.
-				 */
-				buff = buff->next;
-				/* Update also component container,
-				 * so next time we enter buffering function
-				 * we will know right away what is the current
-				 * write buffer
-				 */
-				kpb->history_buffer = buff;
-			}
-			/* Mark buffer as FREE */
-			buff->state = KPB_BUFFER_FREE;
+		if (buff->w_ptr == buff->end_addr)
+			buff = kpb_next_write_buffer(kpb, buff);
+	}
+}
+
+/**
+ * \brief Move on to the next history buffer once current one is full.
+ *
+ * \param[in] kpb - KPB component data pointer.
+ * \param[in] buff - filled history buffer.
+ *
+ * \return history buffer to continue writing to.
+ */
+static struct hb *kpb_next_write_buffer(struct comp_data *kpb,
+					struct hb *buff)
+{
+	/* Reset write pointer back to the beginning
+	 * of the buffer.
+	 */
+	buff->w_ptr = buff->start_addr;
+	/* If we have more buffers use them */
+	if (buff->next && buff->next != buff) {
+		/* Mark current buffer FULL */
+		buff->state = KPB_BUFFER_FULL;
+		/* Use next buffer available on the list
+		 * of buffers.
+		 */
+		buff = buff->next;
+		/* Update also component container,
+		 * so next time we enter buffering function
+		 * we will know right away what is the current
+		 * write buffer
+		 */
+		kpb->history_buffer = buff;
+	}
+	/* Mark buffer as FREE */
+	buff->state = KPB_BUFFER_FREE;
+
+	return buff;
+}
+
+/**
+ * \brief Store linear data in the history buffer.
+ *
+ * \param[in] kpb - KPB component data pointer.
+ * \param[in] data - data to store.
+ * \param[in] size - number of bytes to store.
+ */
+static void kpb_write_history(struct comp_data *kpb, void *data, size_t size)
+{
+	struct hb *buff = kpb->history_buffer;
+	size_t span;
+
+	while (size) {
+		span = (uint32_t)buff->end_addr - (uint32_t)buff->w_ptr;
+		span = MIN(span, size);
+
+		memcpy(buff->w_ptr, data, span);
+		buff->w_ptr += span;
+		data += span;
+		size -= span;
+
+		if (buff->w_ptr == buff->end_addr)
+			buff = kpb_next_write_buffer(kpb, buff);
+	}
+}
+
+/**
+ * \brief Encode real time data stream into the history buffer
+ *	and pass it on to the sink.
+ *
+ * Samples are collected until a whole block is available, which is
+ * then encoded and stored in the history buffer. Sink, if any, gets
+ * the stream unchanged.
+ *
+ * \param[in] kpb - KPB component data pointer.
+ * \param[in] source pointer to the buffer source.
+ * \param[in] sink pointer to the buffer sink or NULL.
+ * \param[in] size number of bytes to buffer.
+ *
+ * \return number of bytes added to the history buffer.
+ */
+static size_t kpb_encode_data(struct comp_data *kpb,
+			      struct comp_buffer *source,
+			      struct comp_buffer *sink, size_t size)
+{
+	uint8_t block[KPB_ADPCM_BLOCK_SIZE_MAX];
+	uint32_t block_samples = KPB_ADPCM_BLOCK_FRAMES *
+				 kpb->config.no_channels;
+	uint32_t samples = size / sizeof(int16_t);
+	size_t history_bytes = 0;
+	int16_t *src;
+	int16_t *dst;
+	uint32_t i;
+
+	tracev_kpb("kpb_encode_data()");
+
+	for (i = 0; i < samples; i++) {
+		src = buffer_read_frag_s16(source, i);
+		if (sink) {
+			dst = buffer_write_frag_s16(sink, i);
+			*dst = *src;
+		}
+
+		kpb->enc_pcm[kpb->enc_samples++] = *src;
+		if (kpb->enc_samples == block_samples) {
+			ima_adpcm_encode_block(kpb->enc_state, kpb->enc_pcm,
+					       block, KPB_ADPCM_BLOCK_FRAMES,
+					       kpb->config.no_channels);
+			kpb_write_history(kpb, block, kpb->hb_block_size);
+			history_bytes += kpb->hb_block_size;
+			kpb->enc_samples = 0;
 		}
 	}
+
+	return history_bytes;
 }
 
 /**
@@ -609,7 +793,7 @@ static void kpb_event_handler(int message, void *cb_data, void *event_data)
 		kpb_register_client(kpb, cli);
 		break;
 	case KPB_EVENT_UNREGISTER_CLIENT:
-		/*TODO*/
+		kpb_unregister_client(kpb, cli);
 		break;
 	case KPB_EVENT_BEGIN_DRAINING:
 		kpb_init_draining(kpb, cli);
@@ -661,7 +845,8 @@ static int kpb_register_client(struct comp_data *kpb, struct kpb_client *cli)
 		/* Client accepted, let's store his data */
 		kpb->clients[cli->id].id  = cli->id;
 		kpb->clients[cli->id].history_depth = cli->history_depth;
-		kpb->clients[cli->id].sink = cli->sink;
+		kpb->clients[cli->id].sink = cli->sink ? cli->sink :
+					     kpb->cli_sinks[cli->id];
 		kpb->clients[cli->id].r_ptr = NULL;
 		kpb->clients[cli->id].state = KPB_CLIENT_BUFFERING;
 		kpb->kpb_no_of_clients++;
@@ -671,32 +856,86 @@ static int kpb_register_client(struct comp_data *kpb, struct kpb_client *cli)
 	return ret;
 }
 
+/**
+ * \brief Unregister client, stopping its draining if any.
+ *
+ * \param[in] kpb - kpb component data.
+ * \param[in] cli - client's data.
+ */
+static void kpb_unregister_client(struct comp_data *kpb,
+				  struct kpb_client *cli)
+{
+	trace_kpb("kpb_unregister_client()");
+
+	if (!cli || cli->id >= KPB_MAX_NO_OF_CLIENTS ||
+	    kpb->clients[cli->id].state == KPB_CLIENT_UNREGISTERED) {
+		trace_kpb_error("kpb_unregister_client() error: "
+				"client not registered");
+		return;
+	}
+
+	schedule_task_cancel(&kpb->draining_task[cli->id]);
+	kpb->clients[cli->id].state = KPB_CLIENT_UNREGISTERED;
+	kpb->kpb_no_of_clients--;
+}
+
 /**
  * \brief Prepare history buffer for draining.
  *
+ * Each client drains its own history depth with its own read pointer
+ * and sink, so several clients can be drained concurrently out of the
+ * same history buffer.
+ *
  * \param[in] kpb - kpb component data.
  * \param[in] cli - client's data.
  *
  */
 static void kpb_init_draining(struct comp_data *kpb, struct kpb_client *cli)
 {
-	bool is_sink_ready = (kpb->cli_sink->sink->state == COMP_STATE_ACTIVE);
-	size_t history_depth = cli->history_depth * kpb->config.no_channels *
-			       (kpb->config.sampling_freq / 1000) *
-			       (kpb->config.sampling_width / 8);
+	struct kpb_client *client;
+	struct dd *draining_data;
+	size_t bytes_per_ms = kpb->config.no_channels *
+			      (kpb->config.sampling_freq / 1000) *
+			      (kpb->config.sampling_width / 8);
+	size_t history_depth = cli->history_depth * bytes_per_ms;
 	struct hb *buff = kpb->history_buffer;
 	struct hb *first_buff = buff;
 	size_t buffered = 0;
 	size_t local_buffered = 0;
+	void *r_ptr = buff->start_addr;
+	size_t blocks;
 
 	trace_kpb("kpb_init_draining()");
 
-	if (cli->id > KPB_MAX_NO_OF_CLIENTS) {
+	/* Encoded history is drained in whole blocks, round up
+	 * to those which fully fit in the history buffer.
+	 */
+	if (kpb->hb_block_size) {
+		blocks = (cli->history_depth * (kpb->config.sampling_freq /
+			  1000) + KPB_ADPCM_BLOCK_FRAMES - 1) /
+			 KPB_ADPCM_BLOCK_FRAMES;
+		blocks = MIN(blocks, KPB_MAX_BUFFER_SIZE / kpb->hb_block_size);
+		history_depth = blocks * kpb->hb_block_size;
+	}
+
+	if (cli->id >= KPB_MAX_NO_OF_CLIENTS) {
 		trace_kpb_error("kpb_init_draining() error: "
 				"wrong client id");
 		return;
-	/* TODO: check also if client is registered */
-	} else if (!is_sink_ready) {
+	}
+
+	/* Clients asking for draining straight away get registered */
+	client = &kpb->clients[cli->id];
+	if (client->state == KPB_CLIENT_UNREGISTERED &&
+	    kpb_register_client(kpb, cli) < 0)
+		return;
+
+	if (client->state != KPB_CLIENT_BUFFERING) {
+		trace_kpb_error("kpb_init_draining() error: "
+				"client = %u already draining", cli->id);
+		return;
+	} else if (!client->sink ||
+		   client->sink->sink->state != COMP_STATE_ACTIVE) {
 		trace_kpb_error("kpb_init_draining() error: "
 				"sink not ready for draining");
 		return;
@@ -716,7 +955,7 @@ static void kpb_init_draining(struct comp_data *kpb, struct kpb_client *cli)
 			 * current buffer.
 			 */
 			local_buffered = 0;
-			buff->r_ptr = buff->start_addr;
+			r_ptr = buff->start_addr;
 			if (buff->state == KPB_BUFFER_FREE) {
 				local_buffered = (uint32_t)buff->w_ptr -
 						 (uint32_t)buff->start_addr;
@@ -745,17 +984,17 @@ static void kpb_init_draining(struct comp_data *kpb, struct kpb_client *cli)
 					buff = buff->prev;
 					buffered += (uint32_t)buff->end_addr -
 						    (uint32_t)buff->w_ptr;
-					buff->r_ptr = buff->w_ptr + (buffered -
-						      history_depth);
+					r_ptr = buff->w_ptr + (buffered -
+						history_depth);
 					break;
 				}
 				buff = buff->prev;
 			} else if (history_depth == buffered) {
-				buff->r_ptr = buff->start_addr;
+				r_ptr = buff->start_addr;
 				break;
 			} else {
-				buff->r_ptr = buff->start_addr +
-					      (buffered - history_depth);
+				r_ptr = buff->start_addr +
+					(buffered - history_depth);
 				break;
 			}
 
@@ -763,87 +1002,301 @@ static void kpb_init_draining(struct comp_data *kpb, struct kpb_client *cli)
 
 		trace_kpb("kpb_init_draining(), schedule draining task");
 
-		/* Add one-time draining task into the scheduler. */
-		kpb->draining_task_data.sink = kpb->cli_sink;
-		kpb->draining_task_data.history_buffer = buff;
-		kpb->draining_task_data.history_depth = history_depth;
-		kpb->draining_task_data.state = &kpb->state;
+		/* Add periodic draining task into the scheduler. */
+		draining_data = &kpb->draining_task_data[cli->id];
+		draining_data->sink = client->sink;
+		draining_data->history_buffer = buff;
+		draining_data->history_depth = history_depth;
+		draining_data->chunk_size = KPB_DRAINING_CHUNK_MS *
+					    bytes_per_ms;
+		draining_data->client = client;
+		draining_data->lock = &kpb->lock;
+		draining_data->block_size = kpb->hb_block_size;
+		draining_data->channels = kpb->config.no_channels;
+		draining_data->pcm_size = KPB_ADPCM_BLOCK_FRAMES *
+					  kpb->config.no_channels *
+					  sizeof(int16_t);
+		draining_data->pcm_avail = 0;
+		client->r_ptr = r_ptr;
+		client->state = KPB_CLIENT_DRAINNING;
 
 		/* Pause selector copy. */
 		kpb->rt_sink->sink->state = COMP_STATE_PAUSED;
 
-		/* Set host-sink copy mode to blocking */
-		comp_set_attribute(kpb->cli_sink->sink,
-				   COMP_ATTR_COPY_BLOCKING, 1);
+		/* Keep on buffering real time stream while draining */
+		kpb->state = KPB_STATE_DRAINING;
 
 		/* Schedule draining task */
-		schedule_task(&kpb->draining_task, 0, 0,
-			      SOF_SCHEDULE_FLAG_IDLE);
+		schedule_task(&kpb->draining_task[cli->id], 0, 0, 0);
 	}
 }
 
 /**
- * \brief Draining task.
+ * \brief Read linear data from client's position in history buffer.
  *
- * \param[in] arg - pointer keeping drainig data previously prepared
- * by kpb_init_draining().
+ * \param[in] draining_data - client's draining data.
+ * \param[out] data - destination.
+ * \param[in] size - number of bytes to read.
+ */
+static void kpb_read_history(struct dd *draining_data, void *data,
+			     size_t size)
+{
+	struct kpb_client *cli = draining_data->client;
+	struct hb *buff = draining_data->history_buffer;
+	size_t span;
+
+	while (size) {
+		span = (uint32_t)buff->end_addr - (uint32_t)cli->r_ptr;
+		span = MIN(span, size);
+
+		memcpy(data, cli->r_ptr, span);
+		cli->r_ptr += span;
+		data += span;
+		size -= span;
+
+		if (cli->r_ptr == buff->end_addr) {
+			buff = buff->next;
+			cli->r_ptr = buff->start_addr;
+		}
+	}
+
+	draining_data->history_buffer = buff;
+}
+
+/**
+ * \brief Decode client's pending encoded history to its sink.
  *
- * \return none.
+ * \param[in] draining_data - client's draining data.
+ * \param[in] max - max number of decoded bytes to copy.
+ *
+ * \return number of decoded bytes copied.
  */
-static uint64_t kpb_draining_task(void *arg)
+static size_t kpb_decode_client(struct dd *draining_data, size_t max)
 {
-	struct dd *draining_data = (struct dd *)arg;
+	struct comp_buffer *sink = draining_data->sink;
+	size_t pending;
+	size_t drained = 0;
+	size_t copied = 0;
+	size_t size;
+	size_t span;
+	uint32_t flags;
+
+	spin_lock_irq(draining_data->lock, flags);
+	pending = draining_data->history_depth;
+	spin_unlock_irq(draining_data->lock, flags);
+
+	while (copied < max) {
+		/* Decode next block once previous one is consumed */
+		if (!draining_data->pcm_avail) {
+			if (pending - drained < draining_data->block_size)
+				break;
+
+			kpb_read_history(draining_data, draining_data->block,
+					 draining_data->block_size);
+			ima_adpcm_decode_block(draining_data->block,
+					       draining_data->pcm,
+					       KPB_ADPCM_BLOCK_FRAMES,
+					       draining_data->channels);
+			draining_data->pcm_avail = draining_data->pcm_size;
+			drained += draining_data->block_size;
+		}
+
+		size = MIN(draining_data->pcm_avail, sink->free);
+		size = MIN(size, max - copied);
+		if (!size)
+			break;
+
+		while (size) {
+			span = (uint32_t)sink->end_addr -
+			       (uint32_t)sink->w_ptr;
+			span = MIN(span, size);
+
+			memcpy(sink->w_ptr, (uint8_t *)draining_data->pcm +
+			       draining_data->pcm_size -
+			       draining_data->pcm_avail, span);
+			comp_update_buffer_produce(sink, span);
+
+			draining_data->pcm_avail -= span;
+			size -= span;
+			copied += span;
+		}
+	}
+
+	spin_lock_irq(draining_data->lock, flags);
+	draining_data->history_depth -= drained;
+	spin_unlock_irq(draining_data->lock, flags);
+
+	return copied;
+}
+
+/**
+ * \brief Copy client's pending history to its sink.
+ *
+ * \param[in] draining_data - client's draining data.
+ * \param[in] max - max number of bytes to copy.
+ *
+ * \return number of bytes copied.
+ */
+static size_t kpb_drain_client(struct dd *draining_data, size_t max)
+{
+	struct kpb_client *cli = draining_data->client;
 	struct comp_buffer *sink = draining_data->sink;
 	struct hb *buff = draining_data->history_buffer;
-	size_t history_depth = draining_data->history_depth;
-	size_t size_to_read;
 	size_t size_to_copy;
-	bool move_buffer = false;
+	size_t drained = 0;
+	size_t span;
+	uint32_t flags;
 
-	trace_kpb("kpb_draining_task(), start.");
+	if (draining_data->block_size)
+		return kpb_decode_client(draining_data, max);
 
-	while (history_depth > 0) {
-		size_to_read = (uint32_t)buff->end_addr - (uint32_t)buff->r_ptr;
+	spin_lock_irq(draining_data->lock, flags);
+	size_to_copy = draining_data->history_depth;
+	spin_unlock_irq(draining_data->lock, flags);
 
-		if (size_to_read > sink->free) {
-			if (sink->free >= history_depth) {
-				size_to_copy = history_depth;
-			} else {
-				size_to_copy = sink->free;
-			}
-		} else {
-			if (size_to_read >= history_depth) {
-				size_to_copy = history_depth;
-			} else {
-				size_to_copy = size_to_read;
-				move_buffer = true;
-			}
-		}
+	size_to_copy = MIN(size_to_copy, sink->free);
+	size_to_copy = MIN(size_to_copy, max);
+
+	while (size_to_copy) {
+		span = (uint32_t)buff->end_addr - (uint32_t)cli->r_ptr;
+		span = MIN(span, (uint32_t)sink->end_addr -
+			   (uint32_t)sink->w_ptr);
+		span = MIN(span, size_to_copy);
 
-		memcpy(sink->w_ptr, buff->r_ptr, size_to_copy);
-		buff->r_ptr += (uint32_t)size_to_copy;
-		history_depth -= size_to_copy;
+		memcpy(sink->w_ptr, cli->r_ptr, span);
+		comp_update_buffer_produce(sink, span);
 
-		if (move_buffer) {
-			buff->r_ptr = buff->start_addr;
+		cli->r_ptr += span;
+		size_to_copy -= span;
+		drained += span;
+
+		if (cli->r_ptr == buff->end_addr) {
 			buff = buff->next;
-			move_buffer = false;
+			cli->r_ptr = buff->start_addr;
 		}
-		if (size_to_copy)
-			comp_update_buffer_produce(sink, size_to_copy);
 	}
 
-	/* Draining is done. Now switch KPB to copy real time stream
-	 * to client's sink
-	 */
-	*draining_data->state = KPB_STATE_DRAINING_ON_DEMAND;
+	draining_data->history_buffer = buff;
+
+	spin_lock_irq(draining_data->lock, flags);
+	draining_data->history_depth -= drained;
+	spin_unlock_irq(draining_data->lock, flags);
+
+	return drained;
+}
+
+/**
+ * \brief Move client's read pointer to the oldest data in history buffer.
+ *
+ * History buffer is full, so its oldest byte is the one following the
+ * current write pointer.
+ *
+ * \param[in] kpb - kpb component data.
+ * \param[in] draining_data - draining data of the client.
+ * \param[in] skip - number of oldest bytes to skip, e.g. a partly
+ *	overwritten encoded block.
+ */
+static void kpb_seek_oldest(struct comp_data *kpb, struct dd *draining_data,
+			    size_t skip)
+{
+	struct hb *buff = kpb->history_buffer;
+	void *r_ptr = buff->w_ptr;
+	size_t span;
+
+	span = (uint32_t)buff->end_addr - (uint32_t)r_ptr;
+	while (skip >= span) {
+		skip -= span;
+		buff = buff->next;
+		r_ptr = buff->start_addr;
+		span = (uint32_t)buff->end_addr - (uint32_t)r_ptr;
+	}
+
+	draining_data->history_buffer = buff;
+	draining_data->client->r_ptr = r_ptr + skip;
+}
+
+/**
+ * \brief Account freshly buffered data for a draining client.
+ *
+ * Clients which caught up with real time stream get the new data
+ * passed on right away, others keep it pending for the draining task.
+ * A client which fell behind by more than the history buffer holds
+ * continues from the oldest data still in there.
+ *
+ * \param[in] kpb - kpb component data.
+ * \param[in] id - client's id.
+ * \param[in] size - number of bytes just buffered.
+ */
+static void kpb_update_client(struct comp_data *kpb, int id, size_t size)
+{
+	struct kpb_client *cli = &kpb->clients[id];
+	struct dd *draining_data = &kpb->draining_task_data[id];
+	size_t max_depth = KPB_MAX_BUFFER_SIZE;
+	uint32_t flags;
+
+	if (cli->state != KPB_CLIENT_DRAINNING &&
+	    cli->state != KPB_CLIENT_DRAINNING_OD)
+		return;
+
+	spin_lock_irq(&kpb->lock, flags);
+
+	/* Has draining task caught up with real time stream? */
+	if (cli->state == KPB_CLIENT_DRAINNING &&
+	    !draining_data->history_depth)
+		cli->state = KPB_CLIENT_DRAINNING_OD;
+
+	/* encoded history is only drained in whole blocks */
+	if (kpb->hb_block_size)
+		max_depth -= KPB_MAX_BUFFER_SIZE % kpb->hb_block_size;
+
+	draining_data->history_depth += size;
+	if (draining_data->history_depth > max_depth) {
+		trace_kpb_error("kpb_update_client() error: "
+				"client = %u draining overrun, lost %u",
+				id, draining_data->history_depth - max_depth);
+		draining_data->history_depth = max_depth;
+
+		/* writer overwrote what the client was about to read */
+		kpb_seek_oldest(kpb, draining_data,
+				KPB_MAX_BUFFER_SIZE - max_depth);
+	}
+
+	spin_unlock_irq(&kpb->lock, flags);
+
+	if (cli->state == KPB_CLIENT_DRAINNING_OD)
+		kpb_drain_client(draining_data, KPB_MAX_BUFFER_SIZE);
+}
+
+/**
+ * \brief Draining task.
+ *
+ * Every run moves at most one chunk of history to the client's sink,
+ * limited further by what host DMA has already made room for, and then
+ * yields until the next period. The chunk covers several periods of
+ * real time, so draining catches up with the still buffering stream.
+ *
+ * \param[in] arg - pointer keeping drainig data previously prepared
+ * by kpb_init_draining().
+ *
+ * \return time to the next run in microseconds or 0 when done.
+ */
+static uint64_t kpb_draining_task(void *arg)
+{
+	struct dd *draining_data = (struct dd *)arg;
+
+	tracev_kpb("kpb_draining_task()");
 
-	/* Reset host-sink copy mode back to unblocking */
-	comp_set_attribute(sink->sink, COMP_ATTR_COPY_BLOCKING, 0);
+	/* Draining is done once KPB switched to copying real time
+	 * stream to client's sink.
+	 */
+	if (draining_data->client->state != KPB_CLIENT_DRAINNING) {
+		trace_kpb("kpb_draining_task(), done.");
+		return 0;
+	}
 
-	trace_kpb("kpb_draining_task(), done.");
+	kpb_drain_client(draining_data, draining_data->chunk_size);
 
-	return 0;
+	return KPB_DRAINING_PERIOD_US;
 }
 
 /**
@@ -55,9 +55,9 @@ struct mixer_data {
 };
 
 /* Mix n 16 bit PCM source streams to one sink stream */
-static void mix_n_s16(struct comp_dev *dev, struct comp_buffer *sink,
-		      struct comp_buffer **sources, uint32_t num_sources,
-		      uint32_t frames)
+UT_STATIC void mix_n_s16(struct comp_dev *dev, struct comp_buffer *sink,
+			 struct comp_buffer **sources, uint32_t num_sources,
+			 uint32_t frames)
 {
 	int16_t *src;
 	int16_t *dest;
@@ -87,9 +87,9 @@ static void mix_n_s16(struct comp_dev *dev, struct comp_buffer *sink,
 }
 
 /* Mix n 32 bit PCM source streams to one sink stream */
-static void mix_n_s32(struct comp_dev *dev, struct comp_buffer *sink,
-		      struct comp_buffer **sources, uint32_t num_sources,
-		      uint32_t frames)
+UT_STATIC void mix_n_s32(struct comp_dev *dev, struct comp_buffer *sink,
+			 struct comp_buffer **sources, uint32_t num_sources,
+			 uint32_t frames)
 {
 	int32_t *src;
 	int32_t *dest;
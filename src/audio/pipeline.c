@@ -49,6 +49,7 @@
 #include <sof/idc.h>
 #include <platform/idc.h>
 #include <sof/schedule.h>
+#include <sof/clk_gov.h>
 
 /* generic pipeline data used by pipeline_comp_* functions */
 struct pipeline_data {
@@ -95,7 +96,8 @@ struct pipeline *pipeline_new(struct sof_ipc_pipe_new *pipe_desc,
 	type = pipeline_is_timer_driven(p) ? SOF_SCHEDULE_LL :
 		SOF_SCHEDULE_EDF;
 	schedule_task_init(&p->pipe_task, type, pipe_desc->priority,
-			   pipeline_task, p, pipe_desc->core, 0);
+			   pipeline_task, p, pipe_desc->core,
+			   SOF_SCHEDULE_FLAG_STATS);
 
 	return p;
 }
@@ -900,6 +902,12 @@ void pipeline_schedule_cancel(struct pipeline *p)
 static uint64_t pipeline_task(void *arg)
 {
 	struct pipeline *p = arg;
+#if CONFIG_PERFORMANCE_COUNTERS
+	uint32_t start = perf_cnt_cycles();
+#endif
+#if CONFIG_CLK_GOVERNOR
+	uint64_t exec = platform_timer_get(platform_timer);
+#endif
 	int err;
 
 	tracev_pipe_with_ids(p, "pipeline_task()");
@@ -922,6 +930,13 @@ static uint64_t pipeline_task(void *arg)
 		}
 	}
 
+#if CONFIG_PERFORMANCE_COUNTERS
+	perf_cnt_pipe_update(p, perf_cnt_cycles() - start);
+#endif
+#if CONFIG_CLK_GOVERNOR
+	clk_gov_pipe_update(p, platform_timer_get(platform_timer) - exec);
+#endif
+
 	tracev_pipe("pipeline_task() sched");
 	return p->ipc_pipe.period;
 }
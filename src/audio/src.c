@@ -44,6 +44,7 @@
 #include <sof/audio/component.h>
 #include <sof/audio/pipeline.h>
 #include <sof/math/numbers.h>
+#include <sof/ut.h>
 #include <uapi/ipc/topology.h>
 
 #include "src_config.h"
@@ -981,7 +982,7 @@ struct comp_driver comp_src = {
 	},
 };
 
-static void sys_comp_src_init(void)
+UT_STATIC void sys_comp_src_init(void)
 {
 	comp_register(&comp_src);
 }
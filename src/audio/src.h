@@ -133,8 +133,16 @@ void src_polyphase_stage_cir_s16(struct src_stage_prm *s);
 int src_buffer_lengths(struct src_param *p, int fs_in, int fs_out, int nch,
 		       int source_frames);
 
+/* sample rates of the coefficient set, NUM_IN_FS and NUM_OUT_FS long */
+extern int src_in_fs[];
+extern int src_out_fs[];
+
 int32_t src_input_rates(void);
 
 int32_t src_output_rates(void);
 
+#ifdef UNIT_TEST
+void sys_comp_src_init(void);
+#endif
+
 #endif
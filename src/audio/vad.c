@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file audio/vad.c
+ * \brief Voice activity detection stage
+ */
+
+#include <sof/audio/vad.h>
+#include <sof/string.h>
+
+/**
+ * \brief Initializes voice activity detection stage.
+ * \param[in,out] vad Stage state.
+ * \param[in] config Configuration, copied.
+ * \param[in] comp_id Id of the component running the stage.
+ */
+void vad_init(struct vad *vad, const struct vad_config *config,
+	      uint32_t comp_id)
+{
+	vad->config = *config;
+	if (!vad->config.decimation)
+		vad->config.decimation = 1;
+
+	vad->event_data.comp_id = comp_id;
+	vad->event.id = NOTIFIER_ID_VAD_STATE;
+	vad->event.target_core_mask = NOTIFIER_TARGET_CORE_ALL_MASK;
+	vad->event.data_size = sizeof(vad->event_data);
+	vad->event.data = &vad->event_data;
+
+	vad_reset(vad);
+}
+
+/**
+ * \brief Resets activation, stage starts inactive.
+ * \param[in,out] vad Stage state.
+ */
+void vad_reset(struct vad *vad)
+{
+	vad->activation = 0;
+	vad->hangover = 0;
+	vad->active = false;
+}
+
+static void vad_notify(struct vad *vad)
+{
+	vad->event.message = vad->active;
+	vad->event_data.activation = vad->activation;
+
+	notifier_event(&vad->event);
+}
+
+/**
+ * \brief Processes one block of 16 bit frames.
+ * \param[in,out] vad Stage state.
+ * \param[in] source Source buffer, read from its read pointer.
+ * \param[in] frames Number of frames to process.
+ * \param[in] channels Number of interleaved channels.
+ * \return True while voice activity is detected.
+ *
+ * Source buffer is not consumed.
+ */
+bool vad_process(struct vad *vad, struct comp_buffer *source,
+		 uint32_t frames, uint32_t channels)
+{
+	int32_t level[VAD_MAX_CHANNELS];
+	int32_t block_level = 0;
+	int32_t diff;
+	int32_t step;
+	uint32_t count;
+	uint32_t ch;
+	bool active;
+
+	if (!frames || !channels || channels > VAD_MAX_CHANNELS)
+		return vad->active;
+
+	count = vad_level_s16(source, frames, channels,
+			      vad->config.decimation, level);
+
+	/* combine channels */
+	for (ch = 0; ch < channels; ch++) {
+		level[ch] /= count;
+
+		if (vad->config.mode == VAD_CHANNELS_AVG)
+			block_level += level[ch];
+		else if (level[ch] > block_level)
+			block_level = level[ch];
+	}
+
+	if (vad->config.mode == VAD_CHANNELS_AVG)
+		block_level /= channels;
+
+	/* Smooth the level with the same time constant as per sample
+	 * update by 1 / 2^shift would give over the block.
+	 */
+	diff = block_level - vad->activation;
+	if (frames >> vad->config.shift) {
+		vad->activation = block_level;
+	} else {
+		step = (diff * (int32_t)frames) >> vad->config.shift;
+
+		/* prevent taking 0 steps when the diff is too low */
+		vad->activation += !step ? diff : step;
+	}
+
+	/* activity with hangover */
+	if (vad->activation >= vad->config.threshold) {
+		active = true;
+		vad->hangover = vad->config.hangover;
+	} else if (vad->hangover >= frames) {
+		active = vad->active;
+		vad->hangover -= frames;
+	} else {
+		active = false;
+		vad->hangover = 0;
+	}
+
+	if (active != vad->active) {
+		vad->active = active;
+		vad_notify(vad);
+	}
+
+	return vad->active;
+}
@@ -187,7 +187,7 @@ static struct comp_dev *volume_new(struct sof_ipc_comp *comp)
 
 	comp_set_drvdata(dev, cd);
 	schedule_task_init(&cd->volwork, SOF_SCHEDULE_LL, SOF_TASK_PRI_MED,
-			   vol_work, dev, 0, 0);
+			   vol_work, dev, 0, SOF_SCHEDULE_FLAG_STATS);
 
 	/* set the default volumes */
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++) {
@@ -209,6 +209,7 @@ static void volume_free(struct comp_dev *dev)
 
 	trace_volume("volume_free()");
 
+	schedule_task_free(&cd->volwork);
 	rfree(cd);
 	rfree(dev);
 }
@@ -553,6 +553,73 @@ static void dw_dma_mask_address(struct dma_sg_elem *sg_elem, uint32_t *sar,
 	}
 }
 
+/* check if elem directly follows prev elem on both sides of the transfer */
+static bool dw_dma_elem_follows(struct dma_sg_elem *prev,
+				struct dma_sg_elem *elem, uint32_t direction)
+{
+	uint32_t src = prev->src;
+	uint32_t dest = prev->dest;
+
+	switch (direction) {
+	case DMA_DIR_MEM_TO_DEV:
+		src += prev->size;
+		break;
+	case DMA_DIR_DEV_TO_MEM:
+		dest += prev->size;
+		break;
+	case DMA_DIR_DEV_TO_DEV:
+		break;
+	default:
+		src += prev->size;
+		dest += prev->size;
+		break;
+	}
+
+	return elem->src == src && elem->dest == dest;
+}
+
+/* number of elems transferred by a single lli */
+static uint32_t dw_dma_elems_per_lli(struct dma *dma, int channel,
+				     struct dma_sg_config *config)
+{
+#if CONFIG_HW_LLI
+	/* hw walks the chain, interrupts are enabled per lli instead */
+	return 1;
+#else
+	struct dma_sg_elem *elems = config->elem_array.elems;
+	uint32_t size = 0;
+	int i;
+
+	if (config->irq_periods <= 1)
+		return 1;
+
+	/* every transfer stops with an interrupt to reload the next lli,
+	 * so merge each irq period into a single block if possible
+	 */
+	for (i = 0; i < config->elem_array.count; i++) {
+		if (i % config->irq_periods) {
+			if (!dw_dma_elem_follows(elems + i - 1, elems + i,
+						 config->direction))
+				goto single;
+			size += elems[i].size;
+		} else {
+			size = elems[i].size;
+		}
+
+		if (size > DW_CTLH_BLOCK_TS_MASK)
+			goto single;
+	}
+
+	return config->irq_periods;
+
+single:
+	trace_dwdma("dw_dma_elems_per_lli(): dma %d channel %d elems can't "
+		    "be merged, irq on every elem", dma->plat_data.id,
+		    channel);
+	return 1;
+#endif
+}
+
 /* set the DMA channel configuration, source/target address, buffer sizes */
 static int dw_dma_set_config(struct dma *dma, int channel,
 			     struct dma_sg_config *config)
@@ -566,9 +633,13 @@ static int dw_dma_set_config(struct dma *dma, int channel,
 	struct dw_lli *lli_desc_tail;
 	uint16_t chan_class;
 	uint32_t msize = 3;/* default msize */
+	uint32_t elems_per_lli;
+	uint32_t irq_period;
+	uint32_t size;
 	uint32_t flags;
 	int ret = 0;
 	int i;
+	int j;
 
 	if (channel >= dma->plat_data.channels ||
 	    channel == DMA_CHAN_INVALID) {
@@ -608,10 +679,30 @@ static int dw_dma_set_config(struct dma *dma, int channel,
 		goto out;
 	}
 
+	if (config->irq_periods > 1 &&
+	    config->elem_array.count % config->irq_periods) {
+		trace_dwdma_error("dw_dma_set_config() error: dma %d channel "
+				  "%d elems %d not multiple of irq periods %d",
+				  dma->plat_data.id, channel,
+				  config->elem_array.count,
+				  config->irq_periods);
+		ret = -EINVAL;
+		goto out;
+	}
+
+	elems_per_lli = dw_dma_elems_per_lli(dma, channel, config);
+
+#if CONFIG_HW_LLI
+	irq_period = config->irq_periods > 1 ? config->irq_periods : 1;
+#else
+	/* transfer stops after each lli, so each one needs an interrupt */
+	irq_period = 1;
+#endif
+
 	/* do we need to realloc descriptors */
-	if (config->elem_array.count != chan->desc_count) {
+	if (config->elem_array.count / elems_per_lli != chan->desc_count) {
 
-		chan->desc_count = config->elem_array.count;
+		chan->desc_count = config->elem_array.count / elems_per_lli;
 
 		/* allocate descriptors for channel */
 		if (chan->lli)
@@ -650,8 +741,13 @@ static int dw_dma_set_config(struct dma *dma, int channel,
 	chan->ptr_data.buffer_bytes = 0;
 
 	/* fill in lli for the elems in the list */
-	for (i = 0; i < config->elem_array.count; i++) {
-		sg_elem = config->elem_array.elems + i;
+	for (i = 0; i < chan->desc_count; i++) {
+		sg_elem = config->elem_array.elems + i * elems_per_lli;
+
+		/* merged elems are contiguous, so only sizes add up */
+		size = 0;
+		for (j = 0; j < elems_per_lli; j++)
+			size += sg_elem[j].size;
 
 		/* write CTL_LO for each lli */
 		switch (config->src_width) {
@@ -713,8 +809,11 @@ static int dw_dma_set_config(struct dma *dma, int channel,
 		}
 
 		lli_desc->ctrl_lo |= DW_CTLL_SRC_MSIZE(msize) |
-			DW_CTLL_DST_MSIZE(msize) |
-			DW_CTLL_INT_EN; /* enable interrupt */
+			DW_CTLL_DST_MSIZE(msize);
+
+		/* enable interrupt at the end of each irq period */
+		if (!((i + 1) % irq_period))
+			lli_desc->ctrl_lo |= DW_CTLL_INT_EN;
 
 		/* config the SINC and DINC fields of CTL_LO,
 		 * SRC/DST_PER fields of CFG_HI
@@ -790,11 +889,10 @@ static int dw_dma_set_config(struct dma *dma, int channel,
 		dw_dma_mask_address(sg_elem, &lli_desc->sar, &lli_desc->dar,
 				    config->direction);
 
-		if (sg_elem->size > DW_CTLH_BLOCK_TS_MASK) {
+		if (size > DW_CTLH_BLOCK_TS_MASK) {
 			trace_dwdma_error("dw_dma_set_config() error: dma %d "
 					  "channel %d block size too big %d",
-					  dma->plat_data.id, channel,
-					  sg_elem->size);
+					  dma->plat_data.id, channel, size);
 			ret = -EINVAL;
 			goto out;
 		}
@@ -803,10 +901,9 @@ static int dw_dma_set_config(struct dma *dma, int channel,
 		platform_dw_dma_set_class(chan, lli_desc, chan_class);
 
 		/* set transfer size of element */
-		platform_dw_dma_set_transfer_size(chan, lli_desc,
-						  sg_elem->size);
+		platform_dw_dma_set_transfer_size(chan, lli_desc, size);
 
-		chan->ptr_data.buffer_bytes += sg_elem->size;
+		chan->ptr_data.buffer_bytes += size;
 
 		/* set next descriptor in list */
 		lli_desc->llp = (uint32_t)(lli_desc + 1);
@@ -961,7 +1058,8 @@ static void dw_dma_verify_transfer(struct dma *dma, int channel,
 	struct dma_pdata *p = dma_get_drvdata(dma);
 	struct dw_dma_chan_data *chan = p->chan + channel;
 #if CONFIG_HW_LLI
-	struct dw_lli *ll_uncached = cache_to_uncache(chan->lli_current);
+	struct dw_lli *ll_uncached;
+	int i;
 
 	switch (next->size) {
 	case DMA_RELOAD_END:
@@ -969,7 +1067,12 @@ static void dw_dma_verify_transfer(struct dma *dma, int channel,
 		dw_write(dma, DW_DMA_CHAN_EN, DW_CHAN_MASK(channel));
 		/* fallthrough */
 	default:
-		if (ll_uncached->ctrl_hi & DW_CTLH_DONE(1)) {
+		/* one interrupt may complete several llis */
+		for (i = 0; i < chan->desc_count && chan->lli_current; i++) {
+			ll_uncached = cache_to_uncache(chan->lli_current);
+			if (!(ll_uncached->ctrl_hi & DW_CTLH_DONE(1)))
+				break;
+
 			ll_uncached->ctrl_hi &= ~DW_CTLH_DONE(1);
 			chan->lli_current =
 				(struct dw_lli *)chan->lli_current->llp;
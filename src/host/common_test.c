@@ -50,11 +50,25 @@
 #include <sof/audio/pipeline.h>
 #include "host/common_test.h"
 #include "host/topology.h"
+#if CONFIG_HOST_VIRTUAL_TIME
+#include "host/virtual_time.h"
+#endif
+#if CONFIG_HOST_MEMORY_MODEL
+#include "host/memmap.h"
+#endif
 
 /* testbench helper functions for pipeline setup and trigger */
 
 int tb_pipeline_setup(struct sof *sof)
 {
+#if CONFIG_HOST_MEMORY_MODEL
+	/* platform heaps must be ready before anything is allocated */
+	if (tb_memmap_init(sof) < 0) {
+		fprintf(stderr, "error: memory map init\n");
+		return -EINVAL;
+	}
+#endif
+
 	/* init components */
 	sys_comp_init();
 
@@ -64,6 +78,14 @@ int tb_pipeline_setup(struct sof *sof)
 		return -EINVAL;
 	}
 
+#if CONFIG_HOST_VIRTUAL_TIME
+	/* init virtual time platform before the schedulers use it */
+	if (vt_init(sof) < 0) {
+		fprintf(stderr, "error: virtual time init\n");
+		return -EINVAL;
+	}
+#endif
+
 	/* init scheduler */
 	if (scheduler_init() < 0) {
 		fprintf(stderr, "error: scheduler init\n");
@@ -215,6 +237,47 @@ int get_index_by_type(uint32_t comp_type,
 	return -EINVAL;
 }
 
+/* short component type name for reports */
+const char *tb_comp_type_name(uint32_t type)
+{
+	switch (type) {
+	case SOF_COMP_HOST:
+	case SOF_COMP_SG_HOST:
+		return "host";
+	case SOF_COMP_DAI:
+	case SOF_COMP_SG_DAI:
+		return "dai";
+	case SOF_COMP_VOLUME:
+		return "volume";
+	case SOF_COMP_MIXER:
+		return "mixer";
+	case SOF_COMP_MUX:
+		return "mux";
+	case SOF_COMP_SRC:
+		return "src";
+	case SOF_COMP_TONE:
+		return "tone";
+	case SOF_COMP_SWITCH:
+		return "switch";
+	case SOF_COMP_EQ_IIR:
+		return "eq_iir";
+	case SOF_COMP_EQ_FIR:
+		return "eq_fir";
+	case SOF_COMP_FILEREAD:
+		return "fileread";
+	case SOF_COMP_FILEWRITE:
+		return "filewrite";
+	case SOF_COMP_KPB:
+		return "kpb";
+	case SOF_COMP_SELECTOR:
+		return "selector";
+	case SOF_COMP_KEYWORD_DETECT:
+		return "detect";
+	default:
+		return "unknown";
+	}
+}
+
 /* The following definitions are to satisfy libsof linker errors */
 
 struct dai *dai_get(uint32_t type, uint32_t index, uint32_t flags)
@@ -250,4 +313,7 @@ void dma_sg_free(struct dma_sg_elem_array *elem_array)
 
 void pipeline_xrun(struct pipeline *p, struct comp_dev *dev, int32_t bytes)
 {
+#if CONFIG_HOST_VIRTUAL_TIME
+	vt_xrun(p);
+#endif
 }
@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <sof/sof.h>
+#include <sof/alloc.h>
+#include <sof/math/numbers.h>
+#include <platform/memory.h>
+#include "host/memmap.h"
+
+/* request size histogram, power of two buckets from 1 byte up */
+#define MEMMAP_HIST_BUCKETS	20
+
+/* heaps of the model: system, system runtime, runtime and buffer */
+#define MEMMAP_NUM_HEAPS \
+	(PLATFORM_HEAP_SYSTEM + PLATFORM_HEAP_SYSTEM_RUNTIME + \
+	 PLATFORM_HEAP_RUNTIME + PLATFORM_HEAP_BUFFER)
+
+/* zone types, in RZONE bit order */
+#define MEMMAP_NUM_ZONES	4
+
+struct memmap_region {
+	const char *name;
+	uint32_t base;
+	uint32_t size;
+};
+
+struct memmap_heap_stats {
+	struct mm_heap *heap;
+	const char *name;
+	uint32_t peak;			/* peak used bytes */
+	uint32_t peak_free;		/* free bytes at peak */
+	uint32_t peak_largest;		/* largest free run at peak */
+	uint16_t *map_peak;		/* peak used blocks per block map */
+};
+
+struct memmap_zone_stats {
+	uint32_t requests;
+	uint32_t failed;
+	uint64_t requested;		/* bytes asked for */
+	uint64_t allocated;		/* bytes taken with block rounding */
+	uint32_t hist[MEMMAP_HIST_BUCKETS];
+};
+
+static const struct memmap_region memmap_regions[] = {
+	{"HP SRAM", HP_SRAM_BASE, HP_SRAM_SIZE},
+	{"LP SRAM", LP_SRAM_BASE, LP_SRAM_SIZE},
+};
+
+static const char * const memmap_zone_names[MEMMAP_NUM_ZONES] = {
+	"sys", "runtime", "buffer", "sys_runtime",
+};
+
+static struct memmap_heap_stats heap_stats[MEMMAP_NUM_HEAPS];
+static struct memmap_zone_stats zone_stats[MEMMAP_NUM_ZONES];
+static int memmap_ready;
+
+/* map a region and its uncached alias onto the same memory */
+static int memmap_region_map(const struct memmap_region *region)
+{
+	uint32_t alias[] = {region->base, region->base - SRAM_ALIAS_OFFSET};
+	void *addr;
+	int fd;
+	int i;
+
+	fd = memfd_create(region->name, 0);
+	if (fd < 0 || ftruncate(fd, region->size) < 0) {
+		fprintf(stderr, "error: memmap %s: %s\n", region->name,
+			strerror(errno));
+		return -errno;
+	}
+
+	for (i = 0; i < (SRAM_ALIAS_OFFSET ? 2 : 1); i++) {
+		addr = mmap((void *)(uintptr_t)alias[i], region->size,
+			    PROT_READ | PROT_WRITE,
+			    MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0);
+		if (addr != (void *)(uintptr_t)alias[i]) {
+			fprintf(stderr, "error: memmap %s at 0x%x: %s\n",
+				region->name, alias[i], strerror(errno));
+			close(fd);
+			return -ENOMEM;
+		}
+	}
+
+	close(fd);
+
+	return 0;
+}
+
+static void memmap_heap_add(int *idx, struct mm_heap *heap, int count,
+			    const char *name)
+{
+	int i;
+
+	for (i = 0; i < count; i++, (*idx)++) {
+		heap_stats[*idx].heap = &heap[i];
+		heap_stats[*idx].name = name;
+		heap_stats[*idx].map_peak = calloc(heap[i].blocks ?
+						   heap[i].blocks : 1,
+						   sizeof(uint16_t));
+	}
+}
+
+int tb_memmap_init(struct sof *sof)
+{
+	int idx = 0;
+	int ret;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(memmap_regions); i++) {
+		ret = memmap_region_map(&memmap_regions[i]);
+		if (ret < 0)
+			return ret;
+	}
+
+	platform_init_memmap();
+	init_heap(sof);
+
+	memmap_heap_add(&idx, memmap.system, PLATFORM_HEAP_SYSTEM, "system");
+	memmap_heap_add(&idx, memmap.system_runtime,
+			PLATFORM_HEAP_SYSTEM_RUNTIME, "sys_runtime");
+	memmap_heap_add(&idx, memmap.runtime, PLATFORM_HEAP_RUNTIME,
+			"runtime");
+	memmap_heap_add(&idx, memmap.buffer, PLATFORM_HEAP_BUFFER, "buffer");
+
+	memmap_ready = 1;
+
+	return 0;
+}
+
+static int memmap_zone_index(int zone)
+{
+	switch (zone & RZONE_TYPE_MASK) {
+	case RZONE_SYS:
+		return 0;
+	case RZONE_RUNTIME:
+		return 1;
+	case RZONE_BUFFER:
+		return 2;
+	default:
+		return 3;
+	}
+}
+
+/* largest run of free blocks in bytes over all block maps of a heap */
+static uint32_t memmap_largest_free(struct mm_heap *heap)
+{
+	struct block_map *map;
+	uint32_t largest = 0;
+	uint32_t run;
+	int i;
+	int j;
+
+	for (i = 0; i < heap->blocks; i++) {
+		map = &heap->map[i];
+		run = 0;
+
+		for (j = 0; j < map->count; j++) {
+			run = map->block[j].used ? 0 : run + 1;
+			largest = MAX(largest, run * map->block_size);
+		}
+	}
+
+	return largest;
+}
+
+/* bytes taken from a block map by the allocation at ptr */
+static uint32_t memmap_alloc_size(void *ptr, uint32_t bytes)
+{
+	struct mm_heap *heap;
+	struct block_map *map;
+	uint32_t addr = (uintptr_t)ptr;
+	int i;
+	int j;
+
+	if (is_uncached(addr))
+		addr = uncache_to_cache(addr);
+
+	for (i = 0; i < MEMMAP_NUM_HEAPS; i++) {
+		heap = heap_stats[i].heap;
+		if (addr < heap->heap || addr >= heap->heap + heap->size)
+			continue;
+
+		for (j = 0; j < heap->blocks; j++) {
+			map = &heap->map[j];
+			if (addr < map->base + map->block_size * map->count)
+				return map->block_size *
+					map->block[(addr - map->base) /
+						   map->block_size].size;
+		}
+	}
+
+	/* system heap has no block map */
+	return bytes;
+}
+
+static void memmap_update_peak(void)
+{
+	struct memmap_heap_stats *stats;
+	struct block_map *map;
+	int i;
+	int j;
+
+	for (i = 0; i < MEMMAP_NUM_HEAPS; i++) {
+		stats = &heap_stats[i];
+
+		for (j = 0; j < stats->heap->blocks; j++) {
+			map = &stats->heap->map[j];
+			stats->map_peak[j] = MAX(stats->map_peak[j],
+						 map->count - map->free_count);
+		}
+
+		if (stats->heap->info.used <= stats->peak)
+			continue;
+
+		stats->peak = stats->heap->info.used;
+		stats->peak_free = stats->heap->info.free;
+		stats->peak_largest = stats->heap->blocks ?
+			memmap_largest_free(stats->heap) :
+			stats->heap->info.free;
+	}
+}
+
+void *memmap_record(void *ptr, int zone, uint32_t caps, size_t bytes)
+{
+	struct memmap_zone_stats *stats;
+	int bucket = 0;
+
+	if (!memmap_ready)
+		return ptr;
+
+	stats = &zone_stats[memmap_zone_index(zone)];
+	stats->requests++;
+
+	while (bucket < MEMMAP_HIST_BUCKETS - 1 && (1UL << bucket) < bytes)
+		bucket++;
+	stats->hist[bucket]++;
+
+	if (!ptr) {
+		stats->failed++;
+		return NULL;
+	}
+
+	stats->requested += bytes;
+	stats->allocated += memmap_alloc_size(ptr, bytes);
+
+	memmap_update_peak();
+
+	return ptr;
+}
+
+static void memmap_print_heap(struct memmap_heap_stats *stats)
+{
+	struct mm_heap *heap = stats->heap;
+	struct block_map *map;
+	int i;
+
+	printf("%-12s 0x%08x size %7u peak %7u (%5.1f%%) used %7u",
+	       stats->name, heap->heap, heap->size, stats->peak,
+	       100.0 * stats->peak / heap->size, heap->info.used);
+
+	if (heap->blocks && stats->peak_free)
+		printf(" frag %5.1f%%", 100.0 - 100.0 *
+		       stats->peak_largest / stats->peak_free);
+	printf("\n");
+
+	for (i = 0; i < heap->blocks; i++) {
+		map = &heap->map[i];
+		printf("    block %5u x %5u peak %5u used %5u\n",
+		       map->block_size, map->count, stats->map_peak[i],
+		       map->count - map->free_count);
+	}
+}
+
+static void memmap_print_zone(int zone)
+{
+	struct memmap_zone_stats *stats = &zone_stats[zone];
+	int i;
+
+	if (!stats->requests)
+		return;
+
+	printf("%-12s requests %6u failed %4u requested %8llu allocated %8llu",
+	       memmap_zone_names[zone], stats->requests, stats->failed,
+	       (unsigned long long)stats->requested,
+	       (unsigned long long)stats->allocated);
+	if (stats->allocated)
+		printf(" waste %5.1f%%", 100.0 - 100.0 * stats->requested /
+		       stats->allocated);
+	printf("\n");
+
+	for (i = 0; i < MEMMAP_HIST_BUCKETS; i++) {
+		if (stats->hist[i])
+			printf("    <= %7lu bytes %6u\n", 1UL << i,
+			       stats->hist[i]);
+	}
+}
+
+void tb_memmap_report(void)
+{
+	int i;
+
+	if (!memmap_ready)
+		return;
+
+	printf("==========================================================\n");
+	printf("		   Memory Map Summary\n");
+	printf("==========================================================\n");
+	printf("Heaps, peak usage and fragmentation of free space at peak:\n");
+	for (i = 0; i < MEMMAP_NUM_HEAPS; i++)
+		memmap_print_heap(&heap_stats[i]);
+
+	printf("Requests per zone and size histogram:\n");
+	for (i = 0; i < MEMMAP_NUM_ZONES; i++)
+		memmap_print_zone(i);
+}
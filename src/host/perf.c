@@ -0,0 +1,876 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+#include <sof/ipc.h>
+#include <sof/list.h>
+#include <sof/math/numbers.h>
+#include <sof/perf_cnt.h>
+#include <uapi/ipc/trace.h>
+#include "host/common_test.h"
+#include "host/perf.h"
+#if CONFIG_HOST_VIRTUAL_TIME
+#include "host/virtual_time.h"
+#endif
+
+/* dependent adds timed for the cycle calibration */
+#define PERF_CAL_LOOPS		20000000
+#define PERF_CAL_RUNS		5
+
+/* reference kernel samples, timed once per pipeline period */
+#define PERF_REF_SAMPLES	1024
+#define PERF_REF_GAIN		0x6000	/* Q1.15 */
+
+#define PERF_LINE_LEN		256
+
+/* hardware events counted as one group, cycles lead the group */
+enum perf_event {
+	PERF_EV_CYCLES = 0,
+	PERF_EV_INSTRUCTIONS,
+	PERF_EV_L1D_MISSES,
+	PERF_EV_LLC_MISSES,
+	PERF_EV_BRANCH_MISSES,
+	PERF_EV_COUNT,
+};
+
+static const struct {
+	const char *name;
+	uint32_t type;
+	uint64_t config;
+} perf_events[PERF_EV_COUNT] = {
+	{"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+	{"instr", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+	{"L1D miss", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+		(PERF_COUNT_HW_CACHE_OP_READ << 8) |
+		(PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+	{"LLC miss", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+	{"br miss", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+struct perf_counters {
+	int fd[PERF_EV_COUNT];		/* -1 when the event is unavailable */
+	int slot[PERF_EV_COUNT];	/* position in the group read */
+	int num;			/* events in the group */
+};
+
+/* one sample of all counters and the timer */
+struct perf_sample {
+	uint64_t ns;
+	uint64_t ev[PERF_EV_COUNT];
+};
+
+/* growing array of per copy values */
+struct perf_series {
+	double *v;
+	uint32_t num;
+	uint32_t max;
+};
+
+struct tb_perf_comp {
+	struct comp_dev *dev;
+	uint32_t type;
+	uint32_t index;		/* nth component of this type */
+	uint64_t copies;
+	uint64_t samples;
+	uint64_t ns;
+
+	/* per copy that produced samples, ns per sample and reference ratio */
+	struct perf_series nsps;
+	struct perf_series ratio;
+
+	/* counted events over all copies */
+	uint64_t ev[PERF_EV_COUNT];
+
+	int checked;
+};
+
+/* pipeline periods, the whole scheduling pass of each period */
+struct tb_perf_periods {
+	struct perf_sample start;
+	struct perf_sample sum;
+	struct perf_sample max;
+	uint64_t count;
+};
+
+struct tb_perf {
+	char *bench;
+	double cycles_per_ns;
+	struct tb_perf_comp ref;	/* reference kernel, no component */
+	double ref_nsps;		/* reference of the current period */
+	struct tb_perf_comp comp[TB_PERF_MAX_COMPS];
+	int num_comps;
+	struct perf_counters counters;
+	struct tb_perf_periods periods;
+};
+
+static struct tb_perf *perf;
+
+static int32_t perf_ref_in[PERF_REF_SAMPLES];
+static int32_t perf_ref_out[PERF_REF_SAMPLES];
+
+static uint64_t perf_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * The loop carried add has a latency of one cycle on any superscalar host,
+ * the fastest of a few runs gives the host cycles per ns.
+ */
+static double perf_calibrate(void)
+{
+	uint64_t best = UINT64_MAX;
+	uint64_t tic;
+	uint64_t x;
+	int run;
+	int i;
+
+	for (run = 0; run < PERF_CAL_RUNS; run++) {
+		x = 0;
+		tic = perf_now_ns();
+		for (i = 0; i < PERF_CAL_LOOPS; i++) {
+			x += i;
+			__asm__ __volatile__("" : "+r" (x));
+		}
+		best = MIN(best, perf_now_ns() - tic);
+	}
+
+	return best ? (double)PERF_CAL_LOOPS / best : 1.0;
+}
+
+static int perf_event_open(struct perf_event_attr *attr, int group_fd)
+{
+	return syscall(__NR_perf_event_open, attr, 0, -1, group_fd, 0);
+}
+
+/*
+ * Counters follow the testbench thread on any CPU and count user space
+ * only, which keeps them usable without privileges. Events the host PMU
+ * does not support are left out of the group.
+ */
+static int perf_counters_open(struct perf_counters *pc)
+{
+	struct perf_event_attr attr;
+	int leader;
+	int i;
+
+	for (i = 0; i < PERF_EV_COUNT; i++)
+		pc->fd[i] = -1;
+	pc->num = 0;
+
+	for (i = 0; i < PERF_EV_COUNT; i++) {
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = perf_events[i].type;
+		attr.config = perf_events[i].config;
+		attr.read_format = PERF_FORMAT_GROUP;
+		attr.disabled = i == PERF_EV_CYCLES;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+
+		leader = pc->fd[PERF_EV_CYCLES];
+		pc->fd[i] = perf_event_open(&attr, leader);
+		if (pc->fd[i] < 0) {
+			/* nothing to count without the group leader */
+			if (i == PERF_EV_CYCLES)
+				return -errno;
+			continue;
+		}
+
+		pc->slot[i] = pc->num++;
+	}
+
+	leader = pc->fd[PERF_EV_CYCLES];
+	ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+	return pc->num;
+}
+
+static void perf_counters_close(struct perf_counters *pc)
+{
+	int i;
+
+	for (i = PERF_EV_COUNT - 1; i >= 0; i--) {
+		if (pc->fd[i] >= 0)
+			close(pc->fd[i]);
+		pc->fd[i] = -1;
+	}
+
+	pc->num = 0;
+}
+
+static void perf_sample(struct perf_sample *sample)
+{
+	struct perf_counters *pc = &perf->counters;
+	uint64_t values[PERF_EV_COUNT + 1];
+	int i;
+
+	if (pc->num &&
+	    read(pc->fd[PERF_EV_CYCLES], values, sizeof(values)) > 0) {
+		for (i = 0; i < PERF_EV_COUNT; i++) {
+			if (pc->fd[i] >= 0)
+				sample->ev[i] = values[pc->slot[i] + 1];
+		}
+	}
+
+	sample->ns = perf_now_ns();
+}
+
+static struct tb_perf_comp *perf_comp_get(struct comp_dev *dev)
+{
+	struct tb_perf_comp *pc;
+	int i;
+
+	for (i = 0; i < perf->num_comps; i++) {
+		if (perf->comp[i].dev == dev)
+			return &perf->comp[i];
+	}
+
+	if (perf->num_comps == TB_PERF_MAX_COMPS)
+		return NULL;
+
+	pc = &perf->comp[perf->num_comps];
+	pc->dev = dev;
+	pc->type = dev->comp.type;
+
+	/* fileread and filewrite share one driver, the writer has no sink */
+	if (pc->type == SOF_COMP_FILEREAD && list_is_empty(&dev->bsink_list))
+		pc->type = SOF_COMP_FILEWRITE;
+
+	/*
+	 * Component ids depend on every widget in the topology, the index in
+	 * copy order is stable as long as the pipeline is the same.
+	 */
+	for (i = 0; i < perf->num_comps; i++) {
+		if (perf->comp[i].type == pc->type)
+			pc->index++;
+	}
+
+	perf->num_comps++;
+
+	return pc;
+}
+
+/*
+ * Samples are counted on the first sink buffer, in the format of the
+ * component consuming it. Endpoints without a sink count the samples taken
+ * from their source buffer instead.
+ */
+static struct comp_buffer *perf_comp_buffer(struct comp_dev *dev,
+					    uint32_t *avail)
+{
+	struct comp_buffer *buffer;
+
+	if (!list_is_empty(&dev->bsink_list)) {
+		buffer = list_first_item(&dev->bsink_list, struct comp_buffer,
+					 source_list);
+		*avail = buffer->avail;
+		return buffer;
+	}
+
+	if (!list_is_empty(&dev->bsource_list)) {
+		buffer = list_first_item(&dev->bsource_list,
+					 struct comp_buffer, sink_list);
+		*avail = buffer->avail;
+		return buffer;
+	}
+
+	return NULL;
+}
+
+static uint32_t perf_comp_samples(struct comp_dev *dev,
+				  struct comp_buffer *buffer, uint32_t avail)
+{
+	struct comp_dev *fmt_dev;
+	uint32_t sample_bytes;
+	uint32_t bytes;
+
+	if (buffer->source == dev) {
+		fmt_dev = buffer->sink;
+		bytes = buffer->avail - avail;
+	} else {
+		fmt_dev = dev;
+		bytes = avail - buffer->avail;
+	}
+
+	sample_bytes = comp_sample_bytes(fmt_dev);
+
+	return sample_bytes ? bytes / sample_bytes : 0;
+}
+
+static void perf_series_add(struct perf_series *s, double value)
+{
+	double *v;
+
+	if (s->num == s->max) {
+		v = realloc(s->v, (s->max * 2 + 1024) * sizeof(*v));
+		if (!v)
+			return;
+		s->v = v;
+		s->max = s->max * 2 + 1024;
+	}
+
+	s->v[s->num++] = value;
+}
+
+static void perf_comp_account(struct comp_dev *dev,
+			      struct perf_sample *start,
+			      struct perf_sample *end, uint32_t samples)
+{
+	struct tb_perf_comp *pc = perf_comp_get(dev);
+	uint64_t ns = end->ns - start->ns;
+	int i;
+
+	if (!pc)
+		return;
+
+	pc->copies++;
+	pc->ns += ns;
+	pc->samples += samples;
+
+	for (i = 0; i < PERF_EV_COUNT; i++)
+		pc->ev[i] += end->ev[i] - start->ev[i];
+
+	if (!samples)
+		return;
+
+	perf_series_add(&pc->nsps, (double)ns / samples);
+	if (perf->ref_nsps > 0)
+		perf_series_add(&pc->ratio,
+				(double)ns / samples / perf->ref_nsps);
+}
+
+/*
+ * Saturating Q1.15 gain over a cache resident buffer, the same kind of work
+ * as a short volume copy. Copies are divided by the reference timed just
+ * before their period, host clock changes and bursts of load from other
+ * processes hit both alike.
+ */
+static void perf_ref_run(void)
+{
+	uint64_t tic;
+	int64_t v;
+	int i;
+
+	tic = perf_now_ns();
+	for (i = 0; i < PERF_REF_SAMPLES; i++) {
+		v = ((int64_t)perf_ref_in[i] * PERF_REF_GAIN) >> 15;
+		perf_ref_out[i] = MAX(MIN(v, INT32_MAX), INT32_MIN);
+	}
+	__asm__ __volatile__("" : : "r" (perf_ref_out) : "memory");
+
+	perf->ref_nsps = (double)(perf_now_ns() - tic) / PERF_REF_SAMPLES;
+	perf_series_add(&perf->ref.nsps, perf->ref_nsps);
+}
+
+int tb_comp_copy(struct comp_dev *dev)
+{
+	struct perf_sample start = { 0 };
+	struct perf_sample end = { 0 };
+	struct comp_buffer *buffer = NULL;
+	uint32_t avail = 0;
+	int ret;
+
+#if CONFIG_HOST_VIRTUAL_TIME
+	if (!perf) {
+		start.ns = perf_now_ns();
+		ret = dev->drv->ops.copy(dev);
+		vt_comp_charge(dev, perf_now_ns() - start.ns);
+		return ret;
+	}
+#else
+	if (!perf)
+		return dev->drv->ops.copy(dev);
+#endif
+
+	buffer = perf_comp_buffer(dev, &avail);
+
+	perf_sample(&start);
+	ret = dev->drv->ops.copy(dev);
+	perf_sample(&end);
+
+	perf_comp_account(dev, &start, &end, buffer ?
+			  perf_comp_samples(dev, buffer, avail) : 0);
+
+#if CONFIG_HOST_VIRTUAL_TIME
+	vt_comp_charge(dev, end.ns - start.ns);
+#endif
+
+	return ret;
+}
+
+void tb_perf_period_begin(void)
+{
+	if (!perf)
+		return;
+
+	/* before the period starts, it is not pipeline time */
+	perf_ref_run();
+	perf_sample(&perf->periods.start);
+}
+
+void tb_perf_period_end(void)
+{
+	struct tb_perf_periods *periods;
+	struct perf_sample end = { 0 };
+	uint64_t delta;
+	int i;
+
+	if (!perf)
+		return;
+
+	periods = &perf->periods;
+	perf_sample(&end);
+
+	delta = end.ns - periods->start.ns;
+	periods->sum.ns += delta;
+	periods->max.ns = MAX(periods->max.ns, delta);
+
+	for (i = 0; i < PERF_EV_COUNT; i++) {
+		delta = end.ev[i] - periods->start.ev[i];
+		periods->sum.ev[i] += delta;
+		periods->max.ev[i] = MAX(periods->max.ev[i], delta);
+	}
+
+	periods->count++;
+}
+
+static int perf_cmp_double(const void *a, const void *b)
+{
+	double da = *(const double *)a;
+	double db = *(const double *)b;
+
+	return (da > db) - (da < db);
+}
+
+/* median is robust against copies preempted on the host */
+static double perf_series_median(struct perf_series *s)
+{
+	if (!s->num)
+		return 0.0;
+
+	qsort(s->v, s->num, sizeof(*s->v), perf_cmp_double);
+
+	return s->v[s->num / 2];
+}
+
+static double perf_comp_median(struct tb_perf_comp *pc)
+{
+	return perf_series_median(&pc->nsps) * perf->cycles_per_ns;
+}
+
+static double perf_comp_ratio(struct tb_perf_comp *pc)
+{
+	return perf_series_median(&pc->ratio);
+}
+
+static void perf_comp_name(struct tb_perf_comp *pc, char *name, size_t size)
+{
+	snprintf(name, size, "%s.%u", tb_comp_type_name(pc->type), pc->index);
+}
+
+static struct tb_perf_comp *perf_comp_find(const char *name)
+{
+	char comp_name[PERF_LINE_LEN];
+	int i;
+
+	for (i = 0; i < perf->num_comps; i++) {
+		perf_comp_name(&perf->comp[i], comp_name, sizeof(comp_name));
+		if (!strcmp(comp_name, name))
+			return &perf->comp[i];
+	}
+
+	return NULL;
+}
+
+static void perf_report_periods(void)
+{
+	struct tb_perf_periods *periods = &perf->periods;
+
+	if (!periods->count)
+		return;
+
+	printf("Pipeline periods %llu, avg %.1f us, max %.1f us\n",
+	       (unsigned long long)periods->count,
+	       periods->sum.ns / 1000.0 / periods->count,
+	       periods->max.ns / 1000.0);
+}
+
+/*
+ * Events per sample of each component, and per period for the pipeline.
+ * Low IPC with many cache misses per sample points at memory layout,
+ * high IPC at the arithmetic.
+ */
+static void perf_report_counters(void)
+{
+	struct tb_perf_periods *periods = &perf->periods;
+	struct perf_counters *counters = &perf->counters;
+	struct tb_perf_comp *pc;
+	char name[PERF_LINE_LEN];
+	double ipc;
+	int i;
+	int j;
+
+	printf("Hardware counters per sample:\n");
+	printf("  %-16s", "component");
+	for (j = 0; j < PERF_EV_COUNT; j++)
+		printf(" %10s", perf_events[j].name);
+	printf(" %6s\n", "IPC");
+
+	for (i = 0; i < perf->num_comps; i++) {
+		pc = &perf->comp[i];
+		perf_comp_name(pc, name, sizeof(name));
+		printf("  %-16s", name);
+
+		for (j = 0; j < PERF_EV_COUNT; j++) {
+			if (counters->fd[j] < 0 || !pc->samples)
+				printf(" %10s", "n/a");
+			else
+				printf(" %10.3f",
+				       (double)pc->ev[j] / pc->samples);
+		}
+
+		if (counters->fd[PERF_EV_INSTRUCTIONS] < 0 ||
+		    !pc->ev[PERF_EV_CYCLES]) {
+			printf(" %6s\n", "n/a");
+			continue;
+		}
+
+		ipc = (double)pc->ev[PERF_EV_INSTRUCTIONS] /
+			pc->ev[PERF_EV_CYCLES];
+		printf(" %6.2f\n", ipc);
+	}
+
+	if (!periods->count)
+		return;
+
+	printf("Hardware counters per period:\n");
+	for (j = 0; j < PERF_EV_COUNT; j++) {
+		if (counters->fd[j] < 0)
+			continue;
+		printf("  %-16s avg %12.1f max %12llu\n", perf_events[j].name,
+		       (double)periods->sum.ev[j] / periods->count,
+		       (unsigned long long)periods->max.ev[j]);
+	}
+}
+
+void tb_perf_report(void)
+{
+	struct tb_perf_comp *pc;
+	char name[PERF_LINE_LEN];
+	int i;
+
+	if (!perf)
+		return;
+
+	/* the host clock may have ramped up during the run */
+	perf->cycles_per_ns = MAX(perf->cycles_per_ns, perf_calibrate());
+
+	printf("==========================================================\n");
+	printf("		     Performance Summary\n");
+	printf("==========================================================\n");
+	printf("Host clock %.1f MHz, medians of cycles per sample of copies\n",
+	       perf->cycles_per_ns * 1000);
+	printf("Reference kernel %.1f cycles per sample over %u periods\n",
+	       perf_comp_median(&perf->ref), perf->ref.nsps.num);
+	printf("# %-22s %-16s %10s %12s %10s %12s\n", "benchmark",
+	       "component", "ref ratio", "cycles/smpl", "copies", "samples");
+
+	for (i = 0; i < perf->num_comps; i++) {
+		pc = &perf->comp[i];
+		perf_comp_name(pc, name, sizeof(name));
+		printf("  %-22s %-16s %10.2f %12.2f %10llu %12llu\n",
+		       perf->bench, name, perf_comp_ratio(pc),
+		       perf_comp_median(pc), (unsigned long long)pc->copies,
+		       (unsigned long long)pc->samples);
+	}
+
+	perf_report_periods();
+
+	if (perf->counters.num)
+		perf_report_counters();
+}
+
+/*
+ * Baseline lines are "<benchmark> <component> <reference ratio>
+ * <tolerance %>", lines starting with # are comments. Only the lines of the
+ * running benchmark are checked. A component regresses when it takes more
+ * than the tolerance above its baseline or when it is missing from the run.
+ */
+int tb_perf_check(const char *baseline)
+{
+	struct tb_perf_comp *pc;
+	char line[PERF_LINE_LEN];
+	char bench[PERF_LINE_LEN];
+	char name[PERF_LINE_LEN];
+	const char *result;
+	double base_ratio;
+	double tolerance;
+	double ratio;
+	double diff;
+	int regressions = 0;
+	int lines = 0;
+	FILE *fh;
+	int i;
+
+	if (!perf)
+		return -EINVAL;
+
+	fh = fopen(baseline, "r");
+	if (!fh) {
+		fprintf(stderr, "error: opening baseline %s\n", baseline);
+		return -EINVAL;
+	}
+
+	printf("Baseline check against %s:\n", baseline);
+	printf("  %-16s %10s %10s %8s %6s  %s\n", "component", "baseline",
+	       "measured", "diff", "tol", "result");
+
+	while (fgets(line, sizeof(line), fh)) {
+		if (line[0] == '#' ||
+		    sscanf(line, "%255s %255s %lf %lf", bench, name,
+			   &base_ratio, &tolerance) != 4 ||
+		    strcmp(bench, perf->bench))
+			continue;
+
+		lines++;
+		pc = perf_comp_find(name);
+		if (!pc || !pc->ratio.num) {
+			printf("  %-16s %10.2f %10s %8s %5.0f%%  MISSING\n",
+			       name, base_ratio, "-", "-", tolerance);
+			regressions++;
+			continue;
+		}
+
+		pc->checked = 1;
+		ratio = perf_comp_ratio(pc);
+		diff = base_ratio > 0 ?
+			100.0 * (ratio - base_ratio) / base_ratio : 0;
+
+		if (diff > tolerance) {
+			result = "REGRESSION";
+			regressions++;
+		} else if (diff < -tolerance) {
+			result = "faster, update baseline";
+		} else {
+			result = "ok";
+		}
+
+		printf("  %-16s %10.2f %10.2f %+7.1f%% %5.0f%%  %s\n", name,
+		       base_ratio, ratio, diff, tolerance, result);
+	}
+
+	fclose(fh);
+
+	/* components without baseline are listed but never fail */
+	for (i = 0; i < perf->num_comps; i++) {
+		pc = &perf->comp[i];
+		if (pc->checked)
+			continue;
+		perf_comp_name(pc, name, sizeof(name));
+		printf("  %-16s %10s %10.2f %8s %6s  not in baseline\n", name,
+		       "-", perf_comp_ratio(pc), "-", "-");
+	}
+
+	if (!lines) {
+		fprintf(stderr, "error: no baseline for benchmark %s\n",
+			perf->bench);
+		return -EINVAL;
+	}
+
+	printf("%d regression(s) in %s\n", regressions, perf->bench);
+
+	return regressions;
+}
+
+/*
+ * Firmware performance counters mock. In virtual time the DSP cycle counter
+ * is the virtual CPU clock, so fixed component costs are counted exactly.
+ * Otherwise it is host cycles at the calibrated rate in benchmark mode or
+ * one cycle per ns.
+ */
+#if CONFIG_HOST_VIRTUAL_TIME
+uint32_t perf_cnt_cycles(void)
+{
+	return vt_get_cycles();
+}
+
+uint64_t perf_cnt_cycles_per_ms(int core)
+{
+	return vt_get_cycles_per_ms();
+}
+#else
+static double perf_cnt_cycles_per_ns(void)
+{
+	return perf ? perf->cycles_per_ns : 1.0;
+}
+
+uint32_t perf_cnt_cycles(void)
+{
+	return (uint64_t)(perf_now_ns() * perf_cnt_cycles_per_ns());
+}
+
+uint64_t perf_cnt_cycles_per_ms(int core)
+{
+	return perf_cnt_cycles_per_ns() * 1000000;
+}
+#endif
+
+static void perf_cnt_report_header(uint32_t window)
+{
+	printf("Cycles of the last window of %u copies/periods\n", window);
+	printf("# %-5s %4s %5s %5s %10s %10s %10s %8s %10s %8s\n",
+	       "type", "core", "id", "pipe", "min", "avg", "max",
+	       "windows", "budget", "overruns");
+}
+
+void tb_perf_cnt_report(struct ipc *ipc)
+{
+	struct sof_ipc_perf_get req = { 0 };
+	struct sof_ipc_perf_data *data;
+	struct sof_ipc_perf_elem *elem;
+	uint32_t i;
+
+	data = malloc(SOF_IPC_MSG_MAX_SIZE);
+	if (!data)
+		return;
+
+	printf("==========================================================\n");
+	printf("		 Firmware Performance Counters\n");
+	printf("==========================================================\n");
+
+	/* page through the elems like the host driver */
+	req.hdr.cmd = SOF_IPC_GLB_TRACE_MSG | SOF_IPC_TRACE_PERF_GET;
+	req.hdr.size = sizeof(req);
+
+	do {
+		if (perf_cnt_get(ipc, &req, data, SOF_IPC_MSG_MAX_SIZE) < 0 ||
+		    !data->elem_cnt)
+			break;
+
+		if (!req.first_elem)
+			perf_cnt_report_header(data->window);
+
+		for (i = 0; i < data->elem_cnt; i++) {
+			elem = &data->elems[i];
+			printf("  %-5s %4u %5u %5u %10u %10u %10u %8u",
+			       elem->type == SOF_IPC_PERF_ELEM_PIPE ?
+			       "pipe" : "comp", elem->core, elem->id,
+			       elem->pipeline_id, elem->min, elem->avg,
+			       elem->max, elem->windows);
+			if (elem->type == SOF_IPC_PERF_ELEM_PIPE)
+				printf(" %10u %8u", elem->budget,
+				       elem->overruns);
+			printf("\n");
+		}
+
+		req.first_elem += data->elem_cnt;
+	} while (req.first_elem < data->elem_total);
+
+	free(data);
+}
+
+int tb_perf_enable(const char *bench)
+{
+	int i;
+
+	perf = calloc(1, sizeof(*perf));
+	if (!perf)
+		return -ENOMEM;
+
+	perf->bench = strdup(bench);
+	if (!perf->bench) {
+		free(perf);
+		perf = NULL;
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < PERF_EV_COUNT; i++)
+		perf->counters.fd[i] = -1;
+
+	/* any fixed non trivial samples */
+	for (i = 0; i < PERF_REF_SAMPLES; i++)
+		perf_ref_in[i] = (int32_t)(i * 0x9e3779b9);
+
+	perf->cycles_per_ns = perf_calibrate();
+
+	return 0;
+}
+
+int tb_perf_enable_counters(void)
+{
+	int ret;
+
+	if (!perf)
+		return -EINVAL;
+
+	ret = perf_counters_open(&perf->counters);
+	if (ret < 0) {
+		fprintf(stderr, "warning: no hw counters %d, timers only\n",
+			ret);
+		perf_counters_close(&perf->counters);
+	}
+
+	return ret;
+}
+
+void tb_perf_free(void)
+{
+	int i;
+
+	if (!perf)
+		return;
+
+	perf_counters_close(&perf->counters);
+
+	for (i = 0; i < perf->num_comps; i++) {
+		free(perf->comp[i].nsps.v);
+		free(perf->comp[i].ratio.v);
+	}
+	free(perf->ref.nsps.v);
+
+	free(perf->bench);
+	free(perf);
+	perf = NULL;
+}
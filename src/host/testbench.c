@@ -31,12 +31,20 @@
 
 #include <sof/ipc.h>
 #include <sof/list.h>
+#include <sof/clk_gov.h>
 #include <getopt.h>
 #include <dlfcn.h>
 #include "host/common_test.h"
 #include "host/topology.h"
 #include "host/trace.h"
 #include "host/file.h"
+#include "host/perf.h"
+#if CONFIG_HOST_VIRTUAL_TIME
+#include "host/virtual_time.h"
+#endif
+#if CONFIG_HOST_MEMORY_MODEL
+#include "host/memmap.h"
+#endif
 
 #define TESTBENCH_NCH 2 /* Stereo */
 
@@ -99,6 +107,62 @@ static void parse_libraries(char *libs)
 	}
 }
 
+#if CONFIG_HOST_VIRTUAL_TIME
+/* component names accepted for fixed virtual time copy costs */
+static const struct {
+	const char *name;
+	uint32_t type;
+} vt_comp_names[] = {
+	{"host", SOF_COMP_HOST},
+	{"dai", SOF_COMP_DAI},
+	{"vol", SOF_COMP_VOLUME},
+	{"mixer", SOF_COMP_MIXER},
+	{"src", SOF_COMP_SRC},
+	{"fileread", SOF_COMP_FILEREAD},
+	{"filewrite", SOF_COMP_FILEWRITE},
+};
+
+/*
+ * Parse fixed copy costs in the format "vol=2000,src=30000,..." where the
+ * value is the number of DSP cycles charged for each copy of that component
+ * type. Components without a fixed cost are measured and scaled.
+ */
+static void parse_comp_costs(char *costs)
+{
+	char *cost_token = NULL;
+	char *comp_token = NULL;
+	char *token = strtok_r(costs, ",", &cost_token);
+	char *name;
+	char *cycles;
+	int i;
+
+	while (token) {
+		name = strtok_r(token, "=", &comp_token);
+		cycles = strtok_r(NULL, "=", &comp_token);
+		if (!cycles) {
+			fprintf(stderr, "error: missing cycles for %s\n", name);
+			break;
+		}
+
+		for (i = 0; i < ARRAY_SIZE(vt_comp_names); i++) {
+			if (!strcmp(name, vt_comp_names[i].name))
+				break;
+		}
+
+		if (i == ARRAY_SIZE(vt_comp_names)) {
+			fprintf(stderr, "error: unsupported comp type %s\n",
+				name);
+			break;
+		}
+
+		vt_set_comp_cost(vt_comp_names[i].type, atoi(cycles));
+
+		/* next component */
+		token = strtok_r(NULL, ",", &cost_token);
+	}
+}
+#endif
+
 /* print usage for testbench */
 static void print_usage(char *executable)
 {
@@ -110,6 +174,19 @@ static void print_usage(char *executable)
 	printf("%s -i in.txt -o out.txt -t test.tplg ", executable);
 	printf("-r 48000 -R 96000 ");
 	printf("-b S16_LE -a vol=libsof_volume.so\n");
+#if CONFIG_HOST_VIRTUAL_TIME
+	printf("Virtual time options:\n");
+	printf("  -C <comp1=cycles,comp2=cycles> fixed cycles per copy\n");
+	printf("  -s <scale> scale measured host copy time, default 1.0\n");
+	printf("  -L <load_file> write CPU load per period as CSV\n");
+	printf("  -S print scheduler histograms\n");
+	printf("  -G select the CPU clock with the DSP clock governor\n");
+#endif
+	printf("Benchmark options:\n");
+	printf("  -p <name> report cycles per sample of each component\n");
+	printf("  -P <baseline_file> fail on regressions against baseline\n");
+	printf("  -e count hardware events per component and period\n");
+	printf("  -c print firmware performance counters\n");
 }
 
 /* free components */
@@ -144,9 +221,10 @@ static void free_comps(void)
 
 static void parse_input_args(int argc, char **argv, struct testbench_prm *tp)
 {
+	const char *optstring = "hdecSGi:o:t:b:a:r:R:C:s:L:p:P:";
 	int option = 0;
 
-	while ((option = getopt(argc, argv, "hdi:o:t:b:a:r:R:")) != -1) {
+	while ((option = getopt(argc, argv, optstring)) != -1) {
 		switch (option) {
 		/* input sample file */
 		case 'i':
@@ -188,6 +266,53 @@ static void parse_input_args(int argc, char **argv, struct testbench_prm *tp)
 			debug = 1;
 			break;
 
+#if CONFIG_HOST_VIRTUAL_TIME
+		/* fixed component copy costs */
+		case 'C':
+			tp->comp_costs = strdup(optarg);
+			break;
+
+		/* measured copy time scale */
+		case 's':
+			tp->cost_scale = atof(optarg);
+			break;
+
+		/* CPU load log */
+		case 'L':
+			tp->load_file = strdup(optarg);
+			break;
+
+		/* scheduler histograms */
+		case 'S':
+			tp->sched_hist = 1;
+			break;
+
+		/* DSP clock governor */
+		case 'G':
+			tp->clk_gov = 1;
+			break;
+#endif
+
+		/* benchmark mode */
+		case 'p':
+			tp->bench_name = strdup(optarg);
+			break;
+
+		/* benchmark baseline */
+		case 'P':
+			tp->baseline_file = strdup(optarg);
+			break;
+
+		/* hardware event counters */
+		case 'e':
+			tp->hw_counters = 1;
+			break;
+
+		/* firmware performance counters */
+		case 'c':
+			tp->perf_cnt = 1;
+			break;
+
 		/* print usage */
 		case 'h':
 		default:
@@ -209,17 +334,30 @@ int main(int argc, char **argv)
 	clock_t tic, toc;
 	double c_realtime, t_exec;
 	int n_in, n_out, ret;
+	int regressions = 0;
 	int i;
 
 	/* initialize input and output sample rates */
 	tp.fs_in = 0;
 	tp.fs_out = 0;
+#if CONFIG_HOST_VIRTUAL_TIME
+	tp.comp_costs = NULL;
+	tp.cost_scale = 1.0;
+	tp.load_file = NULL;
+	tp.sched_hist = 0;
+	tp.clk_gov = 0;
+#endif
+	tp.bench_name = NULL;
+	tp.baseline_file = NULL;
+	tp.hw_counters = 0;
+	tp.perf_cnt = 0;
 
 	/* command line arguments*/
 	parse_input_args(argc, argv, &tp);
 
 	/* check args */
-	if (!tp.tplg_file || !tp.input_file || !tp.output_file || !tp.bits_in) {
+	if (!tp.tplg_file || !tp.input_file || !tp.output_file || !tp.bits_in ||
+	    ((tp.baseline_file || tp.hw_counters) && !tp.bench_name)) {
 		print_usage(argv[0]);
 		exit(EXIT_FAILURE);
 	}
@@ -230,6 +368,21 @@ int main(int argc, char **argv)
 		exit(EXIT_FAILURE);
 	}
 
+#if CONFIG_HOST_VIRTUAL_TIME
+	/* virtual time cost model and load log */
+	if (tp.comp_costs)
+		parse_comp_costs(tp.comp_costs);
+	vt_set_cost_scale(tp.cost_scale);
+
+	if (tp.load_file && vt_set_load_log(tp.load_file) < 0) {
+		fprintf(stderr, "error: opening %s\n", tp.load_file);
+		exit(EXIT_FAILURE);
+	}
+
+	if (tp.clk_gov)
+		clk_gov_init();
+#endif
+
 	/* parse topology file and create pipeline */
 	if (parse_topology(&sof, lib_table, &tp, &fr_id, &fw_id, &sched_id,
 			   pipeline) < 0) {
@@ -261,12 +414,42 @@ int main(int argc, char **argv)
 		exit(EXIT_FAILURE);
 	}
 
+	/* time component copies */
+	if (tp.bench_name && tb_perf_enable(tp.bench_name) < 0) {
+		fprintf(stderr, "error: benchmark init\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* falls back to timers when the host has no counters */
+	if (tp.hw_counters)
+		tb_perf_enable_counters();
+
 	cd = pcm_dev->cd;
 	tb_enable_trace(false); /* reduce trace output */
 	tic = clock();
 
-	while (frcd->fs.reached_eof == 0)
+#if CONFIG_HOST_VIRTUAL_TIME
+	/* CPU load is accounted per scheduling period */
+	vt_set_load_period(ipc_pipe->period);
+
+	/* DMA driven pipelines are copied on each simulated DMA period */
+	if (!pipeline_is_timer_driven(p) && vt_dma_period_register(p) < 0) {
+		fprintf(stderr, "error: virtual time DMA register\n");
+		exit(EXIT_FAILURE);
+	}
+
+	while (frcd->fs.reached_eof == 0) {
+		tb_perf_period_begin();
+		vt_run(ipc_pipe->period);
+		tb_perf_period_end();
+	}
+#else
+	while (frcd->fs.reached_eof == 0) {
+		tb_perf_period_begin();
 		pipeline_schedule_copy(p, 0);
+		tb_perf_period_end();
+	}
+#endif
 
 	if (!frcd->fs.reached_eof)
 		printf("warning: possible pipeline xrun\n");
@@ -285,6 +468,17 @@ int main(int argc, char **argv)
 	t_exec = (double)(toc - tic) / CLOCKS_PER_SEC;
 	c_realtime = (double)n_out / TESTBENCH_NCH / tp.fs_out / t_exec;
 
+	/* read out before the components are gone */
+	if (tp.perf_cnt)
+		tb_perf_cnt_report(sof.ipc);
+#if CONFIG_HOST_VIRTUAL_TIME
+	if (tp.sched_hist)
+		vt_print_sched_hist(sof.ipc);
+#endif
+#if CONFIG_HOST_MEMORY_MODEL
+	tb_memmap_report();
+#endif
+
 	/* free all components/buffers in pipeline */
 	free_comps();
 
@@ -303,11 +497,27 @@ int main(int argc, char **argv)
 	printf("Total execution time: %.2f us, %.2f x realtime\n",
 	       1e3 * t_exec, c_realtime);
 
+#if CONFIG_HOST_VIRTUAL_TIME
+	vt_print_report();
+	vt_free();
+	free(tp.comp_costs);
+	free(tp.load_file);
+#endif
+
+	if (tp.bench_name) {
+		tb_perf_report();
+		if (tp.baseline_file)
+			regressions = tb_perf_check(tp.baseline_file);
+		tb_perf_free();
+	}
+
 	/* free all other data */
 	free(tp.bits_in);
 	free(tp.input_file);
 	free(tp.tplg_file);
 	free(tp.output_file);
+	free(tp.bench_name);
+	free(tp.baseline_file);
 
 	/* close shared library objects */
 	for (i = 0; i < NUM_WIDGETS_SUPPORTED; i++) {
@@ -315,5 +525,5 @@ int main(int argc, char **argv)
 			dlclose(lib_table[i].handle);
 	}
 
-	return EXIT_SUCCESS;
+	return regressions ? EXIT_FAILURE : EXIT_SUCCESS;
 }
@@ -0,0 +1,879 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Virtual time backend for the host testbench.
+ *
+ * Provides the arch and platform glue (interrupts, IRQ tasks, timers,
+ * notifier and scheduler data) the firmware schedulers need and runs them
+ * from a single threaded event loop. There is no preemption: an interrupt
+ * raised while a handler runs is dispatched once the handler returns, in
+ * order of interrupt number like the DSP interrupt levels.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sof/sof.h>
+#include <sof/alloc.h>
+#include <sof/clk.h>
+#include <sof/clk_gov.h>
+#include <sof/edf_schedule.h>
+#include <sof/interrupt.h>
+#include <sof/ipc.h>
+#include <sof/list.h>
+#include <sof/notifier.h>
+#include <sof/schedule.h>
+#include <sof/task.h>
+#include <sof/timer.h>
+#include <sof/audio/component.h>
+#include <sof/audio/pipeline.h>
+#include <platform/clk.h>
+#include <platform/platform.h>
+#include <platform/timer.h>
+#include <uapi/ipc/trace.h>
+#include "host/common_test.h"
+#include "host/virtual_time.h"
+
+#define VT_MAX_IRQS		32
+#define VT_MAX_COMPS		64
+
+/* DMA period interrupts are dispatched above all software interrupts */
+#define VT_DMA_LEVEL		VT_MAX_IRQS
+
+#define VT_NS_PER_MS		1000000ULL
+
+struct vt_irq {
+	void (*handler)(void *arg);
+	void *arg;
+	uint32_t enabled;
+	uint32_t pending;
+};
+
+struct vt_timer {
+	struct timer *timer;
+	void (*handler)(void *arg);
+	void *arg;
+	uint64_t compare;
+	uint32_t armed;
+	uint32_t enabled;
+};
+
+struct vt_dma {
+	struct pipeline *p;
+	uint64_t period_ns;
+	uint64_t next_ns;
+};
+
+struct vt_comp_cost {
+	uint32_t type;
+	uint32_t cycles;
+};
+
+struct vt_comp_stats {
+	struct comp_dev *dev;
+	uint32_t copies;
+	uint64_t cycles;
+	uint64_t max_cycles;
+};
+
+struct vt_data {
+	/* virtual clocks, ticks follow the CPU clock frequency */
+	uint64_t ns;
+	uint64_t base_ns;
+	uint64_t base_ticks;
+	uint64_t ticks_per_msec;
+	uint32_t level;		/* current interrupt level, 0 is passive */
+
+	/* CPU clock changes */
+	uint32_t clk_changes;
+	uint64_t clk_khz_ns;	/* sum of kHz times ns before last change */
+
+	struct vt_irq irq[VT_MAX_IRQS];
+	struct vt_timer timer;
+	struct notifier clk_notifier;
+
+	/* IRQ task lists, high, medium and low priority */
+	struct list_item irq_task[3];
+
+	struct vt_dma dma[VT_MAX_DMA_PIPELINES];
+	uint32_t num_dma;
+
+	/* cost model */
+	double scale;
+	struct vt_comp_cost cost[VT_MAX_COMP_COSTS];
+	uint32_t num_costs;
+	struct vt_comp_stats comp[VT_MAX_COMPS];
+	uint32_t num_comps;
+
+	/* CPU load per period */
+	uint64_t load_period_ns;
+	uint64_t win_end_ns;
+	uint64_t win_busy_ns;
+	uint64_t busy_ns;
+	uint64_t windows;
+	uint64_t windows_overrun;
+	uint32_t load_min;	/* per mille */
+	uint32_t load_max;	/* per mille */
+	FILE *load_log;
+
+	/* scheduling statistics */
+	uint32_t edf_runs;
+	uint32_t edf_misses;
+	uint64_t edf_max_late;	/* ticks */
+	uint32_t ll_runs;
+	uint32_t ll_late;
+	uint64_t ll_max_late;	/* ticks */
+	uint32_t xruns;
+};
+
+static struct vt_data *vt;
+
+static struct schedule_data *vt_sch_data;
+static struct notify *vt_notify;
+
+struct timesource_data platform_generic_queue[] = {
+{
+	.clk		= PLATFORM_DEFAULT_CLOCK,
+	.notifier	= NOTIFIER_ID_CPU_FREQ,
+	.timer_set	= platform_timer_set,
+	.timer_clear	= platform_timer_clear,
+	.timer_get	= platform_timer_get,
+},
+};
+
+struct timer *platform_timer =
+	&platform_generic_queue[PLATFORM_MASTER_CORE_ID].timer;
+
+static inline uint64_t vt_ticks(void)
+{
+	return vt->base_ticks +
+		(vt->ns - vt->base_ns) * vt->ticks_per_msec / VT_NS_PER_MS;
+}
+
+static inline uint64_t vt_ticks_to_ns(uint64_t ticks)
+{
+	return (ticks * VT_NS_PER_MS + vt->ticks_per_msec - 1) /
+		vt->ticks_per_msec;
+}
+
+static void vt_close_window(void)
+{
+	uint32_t load = vt->win_busy_ns * 1000 / vt->load_period_ns;
+
+	if (!vt->windows || load < vt->load_min)
+		vt->load_min = load;
+	if (load > vt->load_max)
+		vt->load_max = load;
+	if (load >= 1000)
+		vt->windows_overrun++;
+
+	if (vt->load_log)
+		fprintf(vt->load_log, "%llu,%llu,%llu,%u.%u\n",
+			(unsigned long long)vt->windows,
+			(unsigned long long)(vt->win_end_ns -
+					     vt->load_period_ns) / 1000,
+			(unsigned long long)vt->win_busy_ns / 1000,
+			load / 10, load % 10);
+
+	vt->windows++;
+	vt->win_busy_ns = 0;
+	vt->win_end_ns += vt->load_period_ns;
+}
+
+/* move virtual time forward, busy time is accounted as CPU load */
+static void vt_advance(uint64_t ns, int busy)
+{
+	uint64_t span;
+
+	if (busy)
+		vt->busy_ns += ns;
+
+	while (ns) {
+		span = MIN(ns, vt->win_end_ns - vt->ns);
+		if (busy)
+			vt->win_busy_ns += span;
+		vt->ns += span;
+		ns -= span;
+
+		if (vt->ns == vt->win_end_ns)
+			vt_close_window();
+	}
+}
+
+/* CPU clock change, keep ticks continuous and rescale from now on */
+static void vt_clk_notify(int message, void *data, void *event_data)
+{
+	if (message != CLOCK_NOTIFY_POST)
+		return;
+
+	vt->clk_changes++;
+	vt->clk_khz_ns += (vt->ns - vt->base_ns) * vt->ticks_per_msec;
+
+	vt->base_ticks = vt_ticks();
+	vt->base_ns = vt->ns;
+	vt->ticks_per_msec = clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1);
+}
+
+/* arch and platform glue used by the firmware schedulers */
+
+struct schedule_data **arch_schedule_get_data(void)
+{
+	return &vt_sch_data;
+}
+
+struct notify **arch_notify_get(void)
+{
+	return &vt_notify;
+}
+
+uint32_t arch_interrupt_get_level(void)
+{
+	return vt ? vt->level : SOF_IRQ_PASSIVE_LEVEL;
+}
+
+void arch_interrupt_set(int irq)
+{
+	if (irq < VT_MAX_IRQS)
+		vt->irq[irq].pending = 1;
+}
+
+void arch_interrupt_clear(int irq)
+{
+	if (irq < VT_MAX_IRQS)
+		vt->irq[irq].pending = 0;
+}
+
+int interrupt_register(uint32_t irq, int unmask, void (*handler)(void *arg),
+		       void *arg)
+{
+	irq = SOF_IRQ_NUMBER(irq);
+	if (irq >= VT_MAX_IRQS)
+		return -EINVAL;
+
+	vt->irq[irq].handler = handler;
+	vt->irq[irq].arg = arg;
+
+	return 0;
+}
+
+void interrupt_unregister(uint32_t irq)
+{
+	irq = SOF_IRQ_NUMBER(irq);
+	if (irq < VT_MAX_IRQS)
+		vt->irq[irq].handler = NULL;
+}
+
+uint32_t interrupt_enable(uint32_t irq)
+{
+	irq = SOF_IRQ_NUMBER(irq);
+	if (irq < VT_MAX_IRQS)
+		vt->irq[irq].enabled = 1;
+
+	return 0;
+}
+
+uint32_t interrupt_disable(uint32_t irq)
+{
+	irq = SOF_IRQ_NUMBER(irq);
+	if (irq < VT_MAX_IRQS)
+		vt->irq[irq].enabled = 0;
+
+	return 0;
+}
+
+int timer_register(struct timer *timer, void (*handler)(void *arg),
+		   void *arg)
+{
+	vt->timer.timer = timer;
+	vt->timer.handler = handler;
+	vt->timer.arg = arg;
+
+	return 0;
+}
+
+void timer_unregister(struct timer *timer)
+{
+	vt->timer.handler = NULL;
+	vt->timer.enabled = 0;
+}
+
+void timer_enable(struct timer *timer)
+{
+	vt->timer.enabled = 1;
+}
+
+void timer_disable(struct timer *timer)
+{
+	vt->timer.enabled = 0;
+}
+
+int platform_timer_set(struct timer *timer, uint64_t ticks)
+{
+	vt->timer.compare = ticks;
+	vt->timer.armed = 1;
+
+	return 0;
+}
+
+void platform_timer_clear(struct timer *timer)
+{
+	vt->timer.armed = 0;
+}
+
+uint64_t platform_timer_get(struct timer *timer)
+{
+	return vt_ticks();
+}
+
+/* IRQ tasks, same priority to level mapping as xtensa */
+static struct list_item *vt_task_list(struct task *task, uint32_t *irq)
+{
+	switch (task->priority) {
+	case SOF_TASK_PRI_HIGH ... SOF_TASK_PRI_MED - 1:
+		*irq = PLATFORM_IRQ_TASK_HIGH;
+		return &vt->irq_task[0];
+	case SOF_TASK_PRI_MED:
+		*irq = PLATFORM_IRQ_TASK_MED;
+		return &vt->irq_task[1];
+	case SOF_TASK_PRI_MED + 1 ... SOF_TASK_PRI_LOW:
+		*irq = PLATFORM_IRQ_TASK_LOW;
+		return &vt->irq_task[2];
+	default:
+		return NULL;
+	}
+}
+
+static void vt_task_done(struct task *task)
+{
+	struct edf_task_pdata *edf_pdata;
+	uint64_t current;
+
+	if (task->type != SOF_SCHEDULE_EDF)
+		return;
+
+	edf_pdata = edf_sch_get_pdata(task);
+	current = vt_ticks();
+
+	vt->edf_runs++;
+	if (current > edf_pdata->deadline) {
+		vt->edf_misses++;
+		vt->edf_max_late = MAX(vt->edf_max_late,
+				       current - edf_pdata->deadline);
+	}
+}
+
+static void vt_irq_task(void *arg)
+{
+	struct list_item *irq_list = arg;
+	struct list_item *clist;
+	struct list_item *tlist;
+	struct task *task;
+
+	list_for_item_safe(clist, tlist, irq_list) {
+		task = container_of(clist, struct task, irq_list);
+		list_item_del(clist);
+
+		if (task->func && task->state == SOF_TASK_STATE_PENDING) {
+			schedule_task_running(task);
+			task->func(task->data);
+			vt_task_done(task);
+		}
+
+		schedule_task_complete(task);
+	}
+}
+
+int arch_allocate_tasks(void)
+{
+	uint32_t irq[] = {
+		PLATFORM_IRQ_TASK_HIGH,
+		PLATFORM_IRQ_TASK_MED,
+		PLATFORM_IRQ_TASK_LOW,
+	};
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(irq); i++) {
+		list_init(&vt->irq_task[i]);
+		interrupt_register(irq[i], IRQ_AUTO_UNMASK, vt_irq_task,
+				   &vt->irq_task[i]);
+		interrupt_enable(irq[i]);
+	}
+
+	return 0;
+}
+
+void arch_free_tasks(void)
+{
+	interrupt_unregister(PLATFORM_IRQ_TASK_HIGH);
+	interrupt_unregister(PLATFORM_IRQ_TASK_MED);
+	interrupt_unregister(PLATFORM_IRQ_TASK_LOW);
+}
+
+int arch_run_task(struct task *task)
+{
+	struct list_item *irq_list;
+	uint32_t irq;
+
+	irq_list = vt_task_list(task, &irq);
+	if (!irq_list)
+		return -EINVAL;
+
+	list_item_append(&task->irq_list, irq_list);
+	interrupt_set(irq);
+
+	return 0;
+}
+
+/* component copy cost */
+
+static struct vt_comp_stats *vt_comp_get(struct comp_dev *dev)
+{
+	int i;
+
+	for (i = 0; i < vt->num_comps; i++) {
+		if (vt->comp[i].dev == dev)
+			return &vt->comp[i];
+	}
+
+	if (vt->num_comps == VT_MAX_COMPS)
+		return NULL;
+
+	vt->comp[vt->num_comps].dev = dev;
+	return &vt->comp[vt->num_comps++];
+}
+
+static uint32_t vt_comp_fixed_cost(uint32_t type)
+{
+	int i;
+
+	for (i = 0; i < vt->num_costs; i++) {
+		if (vt->cost[i].type == type)
+			return vt->cost[i].cycles;
+	}
+
+	return 0;
+}
+
+void vt_comp_charge(struct comp_dev *dev, uint64_t host_ns)
+{
+	struct vt_comp_stats *stats;
+	uint64_t cycles;
+
+	if (!vt)
+		return;
+
+	cycles = vt_comp_fixed_cost(dev->comp.type);
+	if (!cycles)
+		cycles = host_ns * vt->scale * vt->ticks_per_msec /
+			VT_NS_PER_MS;
+
+	stats = vt_comp_get(dev);
+	if (stats) {
+		stats->copies++;
+		stats->cycles += cycles;
+		stats->max_cycles = MAX(stats->max_cycles, cycles);
+	}
+
+	vt_advance(vt_ticks_to_ns(cycles), 1);
+}
+
+/* event loop */
+
+static int vt_irq_next(void)
+{
+	int irq;
+
+	for (irq = VT_MAX_IRQS - 1; irq >= 0; irq--) {
+		if (vt->irq[irq].pending && vt->irq[irq].enabled &&
+		    vt->irq[irq].handler)
+			return irq;
+	}
+
+	return -1;
+}
+
+static void vt_irq_dispatch(void)
+{
+	uint32_t level = vt->level;
+	int irq;
+
+	while ((irq = vt_irq_next()) >= 0) {
+		vt->irq[irq].pending = 0;
+		vt->level = irq + 1;
+		vt->irq[irq].handler(vt->irq[irq].arg);
+		vt->level = level;
+	}
+}
+
+static void vt_timer_fire(void)
+{
+	uint64_t current = vt_ticks();
+
+	vt->timer.armed = 0;
+	vt->ll_runs++;
+
+	if (current > vt->timer.compare) {
+		vt->ll_late++;
+		vt->ll_max_late = MAX(vt->ll_max_late,
+				      current - vt->timer.compare);
+	}
+
+	vt->level = VT_MAX_IRQS;
+	vt->timer.handler(vt->timer.arg);
+	vt->level = SOF_IRQ_PASSIVE_LEVEL;
+}
+
+static void vt_dma_fire(struct vt_dma *dma)
+{
+	struct task *task = &dma->p->pipe_task;
+
+	/* previous period still not processed, the DMA would xrun */
+	if (task->state == SOF_TASK_STATE_QUEUED ||
+	    task->state == SOF_TASK_STATE_PENDING ||
+	    task->state == SOF_TASK_STATE_RUNNING) {
+		vt->xruns++;
+	}
+
+	dma->next_ns += dma->period_ns;
+
+	vt->level = VT_DMA_LEVEL;
+	pipeline_schedule_copy(dma->p, 0);
+	vt->level = SOF_IRQ_PASSIVE_LEVEL;
+}
+
+static int vt_timer_due(void)
+{
+	return vt->timer.handler && vt->timer.armed && vt->timer.enabled;
+}
+
+/* get the next event time in ns, no later than end */
+static uint64_t vt_next_event(uint64_t end)
+{
+	uint64_t next = end;
+	uint64_t current;
+	int i;
+
+	if (vt_timer_due()) {
+		current = vt_ticks();
+		if (vt->timer.compare <= current)
+			return vt->ns;
+		next = MIN(next, vt->ns +
+			   vt_ticks_to_ns(vt->timer.compare - current));
+	}
+
+	for (i = 0; i < vt->num_dma; i++)
+		next = MIN(next, MAX(vt->dma[i].next_ns, vt->ns));
+
+	return next;
+}
+
+int vt_run(uint64_t us)
+{
+	uint64_t end = vt->ns + us * 1000;
+	uint64_t next;
+	int i;
+
+	while (vt->ns < end) {
+		/* like the DSP main loop, interrupts first then idle tasks */
+		vt_irq_dispatch();
+		schedule();
+		if (vt_irq_next() >= 0)
+			continue;
+
+		clk_gov_idle_enter();
+		next = vt_next_event(end);
+		if (next > vt->ns)
+			vt_advance(next - vt->ns, 0);
+		clk_gov_idle_exit();
+
+		if (vt_timer_due() && vt->timer.compare <= vt_ticks())
+			vt_timer_fire();
+
+		for (i = 0; i < vt->num_dma; i++) {
+			if (vt->dma[i].next_ns <= vt->ns)
+				vt_dma_fire(&vt->dma[i]);
+		}
+	}
+
+	vt_irq_dispatch();
+
+	return 0;
+}
+
+uint64_t vt_get_time_us(void)
+{
+	return vt->ns / 1000;
+}
+
+uint64_t vt_get_cycles(void)
+{
+	return vt_ticks();
+}
+
+uint64_t vt_get_cycles_per_ms(void)
+{
+	return vt->ticks_per_msec;
+}
+
+int vt_dma_period_register(struct pipeline *p)
+{
+	struct vt_dma *dma;
+
+	if (vt->num_dma == VT_MAX_DMA_PIPELINES)
+		return -ENOMEM;
+
+	dma = &vt->dma[vt->num_dma++];
+	dma->p = p;
+	dma->period_ns = (uint64_t)p->ipc_pipe.period * 1000;
+	dma->next_ns = vt->ns + dma->period_ns;
+
+	return 0;
+}
+
+void vt_xrun(struct pipeline *p)
+{
+	vt->xruns++;
+}
+
+void vt_set_cost_scale(double scale)
+{
+	vt->scale = scale;
+}
+
+int vt_set_comp_cost(uint32_t comp_type, uint32_t cycles)
+{
+	int i;
+
+	for (i = 0; i < vt->num_costs; i++) {
+		if (vt->cost[i].type == comp_type) {
+			vt->cost[i].cycles = cycles;
+			return 0;
+		}
+	}
+
+	if (vt->num_costs == VT_MAX_COMP_COSTS)
+		return -ENOMEM;
+
+	vt->cost[vt->num_costs].type = comp_type;
+	vt->cost[vt->num_costs].cycles = cycles;
+	vt->num_costs++;
+
+	return 0;
+}
+
+void vt_set_load_period(uint32_t period_us)
+{
+	/* restart accounting with the new window */
+	vt->load_period_ns = (uint64_t)period_us * 1000;
+	vt->win_end_ns = vt->ns + vt->load_period_ns;
+	vt->win_busy_ns = 0;
+}
+
+int vt_set_load_log(const char *file)
+{
+	vt->load_log = fopen(file, "w");
+	if (!vt->load_log)
+		return -errno;
+
+	fprintf(vt->load_log, "period,start_us,busy_us,load_pct\n");
+
+	return 0;
+}
+
+static double vt_ticks_to_us(uint64_t ticks)
+{
+	return (double)ticks * 1000 / vt->ticks_per_msec;
+}
+
+void vt_print_report(void)
+{
+	struct vt_comp_stats *stats;
+	int i;
+
+	printf("==========================================================\n");
+	printf("		     Virtual Time Summary\n");
+	printf("==========================================================\n");
+	printf("Simulated time: %.3f ms, CPU clock %llu kHz\n",
+	       vt->ns / 1e6, (unsigned long long)vt->ticks_per_msec);
+	printf("CPU clock changes %u, avg clock %llu kHz\n", vt->clk_changes,
+	       vt->ns ? (unsigned long long)((vt->clk_khz_ns +
+	       (vt->ns - vt->base_ns) * vt->ticks_per_msec) / vt->ns) : 0ULL);
+	printf("CPU load per %llu us period over %llu periods:\n",
+	       (unsigned long long)vt->load_period_ns / 1000,
+	       (unsigned long long)vt->windows);
+	printf("  avg %.1f%%, min %.1f%%, max %.1f%%, overrun periods %llu\n",
+	       vt->ns ? 100.0 * vt->busy_ns / vt->ns : 0.0,
+	       vt->load_min / 10.0, vt->load_max / 10.0,
+	       (unsigned long long)vt->windows_overrun);
+	printf("EDF task runs %u, deadline misses %u, max late %.1f us\n",
+	       vt->edf_runs, vt->edf_misses,
+	       vt_ticks_to_us(vt->edf_max_late));
+	printf("LL timer runs %u, late wakeups %u, max late %.1f us\n",
+	       vt->ll_runs, vt->ll_late, vt_ticks_to_us(vt->ll_max_late));
+	printf("Xruns: %u\n", vt->xruns);
+	printf("Component copies:\n");
+	printf("  %-6s %-10s %10s %12s %12s\n", "id", "type", "copies",
+	       "avg cycles", "max cycles");
+
+	for (i = 0; i < vt->num_comps; i++) {
+		stats = &vt->comp[i];
+		printf("  %-6u %-10s %10u %12llu %12llu\n",
+		       stats->dev->comp.id,
+		       tb_comp_type_name(stats->dev->comp.type),
+		       stats->copies,
+		       stats->copies ? (unsigned long long)
+		       (stats->cycles / stats->copies) : 0ULL,
+		       (unsigned long long)stats->max_cycles);
+	}
+}
+
+/* pipeline id of the task data, or -1 for other tasks */
+static int vt_task_pipeline(struct ipc *ipc, uint32_t data)
+{
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
+
+	list_for_item(clist, &ipc->shared_ctx->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type == COMP_TYPE_PIPELINE &&
+		    (uint32_t)(uintptr_t)icd->pipeline == data)
+			return icd->pipeline->ipc_pipe.pipeline_id;
+	}
+
+	return -1;
+}
+
+static void vt_print_hist(const char *name, struct sof_ipc_sched_hist *hist,
+			  uint32_t shift, uint32_t ticks_per_msec)
+{
+	double us_per_tick = ticks_per_msec ? 1000.0 / ticks_per_msec : 0.0;
+	int i;
+
+	printf("    %-8s max %9.1f us:", name, hist->max * us_per_tick);
+
+	for (i = 0; i < SOF_IPC_SCHED_HIST_BUCKETS; i++) {
+		if (!hist->count[i])
+			continue;
+
+		if (i == SOF_IPC_SCHED_HIST_BUCKETS - 1)
+			printf(" >=%.1f:%u",
+			       (1ULL << (shift + i - 1)) * us_per_tick,
+			       hist->count[i]);
+		else
+			printf(" <%.1f:%u", (1ULL << (shift + i)) * us_per_tick,
+			       hist->count[i]);
+	}
+
+	printf("\n");
+}
+
+void vt_print_sched_hist(struct ipc *ipc)
+{
+	struct sof_ipc_sched_get req = { 0 };
+	struct sof_ipc_sched_data *data;
+	struct sof_ipc_sched_elem *elem;
+	uint32_t i;
+	int pipe;
+
+	data = malloc(SOF_IPC_MSG_MAX_SIZE);
+	if (!data)
+		return;
+
+	printf("==========================================================\n");
+	printf("		     Scheduler Histograms\n");
+	printf("==========================================================\n");
+
+	/* page through the elems like the host driver */
+	req.hdr.cmd = SOF_IPC_GLB_TRACE_MSG | SOF_IPC_TRACE_SCHED_GET;
+	req.hdr.size = sizeof(req);
+
+	do {
+		if (schedule_stats_get(&req, data, SOF_IPC_MSG_MAX_SIZE) < 0 ||
+		    !data->elem_cnt)
+			break;
+
+		for (i = 0; i < data->elem_cnt; i++) {
+			elem = &data->elems[i];
+			pipe = vt_task_pipeline(ipc, elem->data);
+
+			printf("  %s task prio %u core %u", elem->type ==
+			       SOF_SCHEDULE_EDF ? "EDF" : "LL", elem->priority,
+			       elem->core);
+			if (pipe >= 0)
+				printf(" pipeline %d", pipe);
+			printf(" runs %u misses %u\n", elem->runs,
+			       elem->misses);
+
+			vt_print_hist("latency", &elem->latency,
+				      data->bucket_shift, elem->ticks_per_msec);
+			vt_print_hist("exec", &elem->exec,
+				      data->bucket_shift, elem->ticks_per_msec);
+			vt_print_hist("slack", &elem->slack,
+				      data->bucket_shift, elem->ticks_per_msec);
+		}
+
+		req.first_elem += data->elem_cnt;
+	} while (req.first_elem < data->elem_total);
+
+	free(data);
+}
+
+int vt_init(struct sof *sof)
+{
+	vt = calloc(1, sizeof(*vt));
+	if (!vt)
+		return -ENOMEM;
+
+	vt->scale = 1.0;
+
+	init_system_notify(sof);
+	clock_init();
+
+	vt->ticks_per_msec = clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1);
+	vt_set_load_period(PLATFORM_WORKQ_DEFAULT_TIMEOUT);
+
+	vt->clk_notifier.id = NOTIFIER_ID_CPU_FREQ;
+	vt->clk_notifier.cb = vt_clk_notify;
+	vt->clk_notifier.cb_data = NULL;
+	notifier_register(&vt->clk_notifier);
+
+	return 0;
+}
+
+void vt_free(void)
+{
+	if (vt->load_log)
+		fclose(vt->load_log);
+
+	free(vt);
+	vt = NULL;
+}
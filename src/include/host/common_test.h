@@ -60,6 +60,17 @@ struct testbench_prm {
 	 */
 	uint32_t fs_in;
 	uint32_t fs_out;
+#if CONFIG_HOST_VIRTUAL_TIME
+	char *comp_costs; /* fixed copy costs in cycles per comp type */
+	double cost_scale; /* scale for measured host copy time */
+	char *load_file; /* CPU load log file */
+	int sched_hist; /* print scheduler histograms */
+	int clk_gov; /* run the DSP clock governor */
+#endif
+	char *bench_name; /* benchmark mode name, NULL when disabled */
+	char *baseline_file; /* benchmark baseline to check against */
+	int hw_counters; /* count hardware events in benchmark mode */
+	int perf_cnt; /* print firmware performance counters */
 };
 
 struct shared_lib_table {
@@ -95,4 +106,6 @@ int get_index_by_name(char *comp_name,
 
 int get_index_by_type(uint32_t comp_type,
 		      struct shared_lib_table *lib_table);
+
+const char *tb_comp_type_name(uint32_t type);
 #endif
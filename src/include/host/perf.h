@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host testbench benchmark mode.
+ *
+ * Every component copy is timed on the host and the samples it produced are
+ * counted from its sink buffer. Host time is converted to CPU cycles with a
+ * calibrated dependent add loop for the report. A fixed reference kernel is
+ * timed after every pipeline period, and the baseline check compares the
+ * median time per sample of each component relative to the median of the
+ * reference. The host clock then cancels out, also when it changes between
+ * or during runs.
+ *
+ * Optionally perf_event_open() counters for cycles, instructions, L1D and
+ * LLC misses and branch misses are read around every copy and every
+ * pipeline period, telling compute bound kernels from memory bound ones.
+ */
+
+#ifndef _INCLUDE_HOST_PERF_H_
+#define _INCLUDE_HOST_PERF_H_
+
+#include <stdint.h>
+
+struct comp_dev;
+struct ipc;
+
+/* max number of components tracked */
+#define TB_PERF_MAX_COMPS	32
+
+/* time component copies and report them under the benchmark name */
+int tb_perf_enable(const char *bench);
+
+void tb_perf_free(void);
+
+/* count hardware events, returns number of events or error for timers */
+int tb_perf_enable_counters(void);
+
+/* bracket one scheduling pass of the pipeline */
+void tb_perf_period_begin(void);
+void tb_perf_period_end(void);
+
+/* print median cycles per sample and reference ratio of each component */
+void tb_perf_report(void);
+
+/* compare against baseline file, returns number of regressions */
+int tb_perf_check(const char *baseline);
+
+/* read firmware performance counters with the IPC mock and print them */
+void tb_perf_cnt_report(struct ipc *ipc);
+
+#endif /* _INCLUDE_HOST_PERF_H_ */
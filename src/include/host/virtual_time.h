@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Virtual time backend for the host testbench.
+ *
+ * The firmware LL and EDF schedulers from src/lib run against a simulated
+ * DSP timer and CPU clock. Component copies advance virtual time by either
+ * a fixed number of cycles configured per component type, or by their
+ * measured host execution time multiplied by a scale factor.
+ */
+
+#ifndef _INCLUDE_HOST_VIRTUAL_TIME_H_
+#define _INCLUDE_HOST_VIRTUAL_TIME_H_
+
+#include <stdint.h>
+
+struct sof;
+struct ipc;
+struct pipeline;
+struct comp_dev;
+
+/* max number of DMA driven pipelines */
+#define VT_MAX_DMA_PIPELINES	8
+
+/* max number of per component type costs */
+#define VT_MAX_COMP_COSTS	16
+
+int vt_init(struct sof *sof);
+
+void vt_free(void);
+
+/* measured host time is multiplied by scale to get DSP time */
+void vt_set_cost_scale(double scale);
+
+/* fixed DSP cycles per copy for all components of comp_type */
+int vt_set_comp_cost(uint32_t comp_type, uint32_t cycles);
+
+/* CPU load is accounted over windows of period_us */
+void vt_set_load_period(uint32_t period_us);
+
+/* per period CPU load is written as CSV to file */
+int vt_set_load_log(const char *file);
+
+/* advance virtual time by the cost of one copy of dev */
+void vt_comp_charge(struct comp_dev *dev, uint64_t host_ns);
+
+/* emulate DMA period interrupts scheduling the pipeline copy */
+int vt_dma_period_register(struct pipeline *p);
+
+/* advance virtual time by us, running all interrupts and tasks due */
+int vt_run(uint64_t us);
+
+uint64_t vt_get_time_us(void);
+
+/* virtual DSP cycle counter and its rate at the current CPU clock */
+uint64_t vt_get_cycles(void);
+uint64_t vt_get_cycles_per_ms(void);
+
+/* pipeline has reported an xrun */
+void vt_xrun(struct pipeline *p);
+
+void vt_print_report(void);
+
+/* read scheduler histograms with the IPC mock and print them */
+void vt_print_sched_hist(struct ipc *ipc);
+
+#endif /* _INCLUDE_HOST_VIRTUAL_TIME_H_ */
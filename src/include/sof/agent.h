@@ -45,6 +45,7 @@ struct sa {
 };
 
 void sa_enter_idle(struct sof *sof);
+void sa_exit_idle(struct sof *sof);
 void sa_init(struct sof *sof);
 
 #endif
@@ -123,13 +123,28 @@ struct mm {
 	spinlock_t lock;	/* all allocs and frees are atomic */
 } __attribute__ ((__aligned__(PLATFORM_DCACHE_ALIGN)));
 
+/* platform heap map */
+extern struct mm memmap;
+
 /* heap allocation and free */
 void *_malloc(int zone, uint32_t caps, size_t bytes);
 void *_zalloc(int zone, uint32_t caps, size_t bytes);
 void *_balloc(int zone, uint32_t caps, size_t bytes);
 void rfree(void *ptr);
 
-#if CONFIG_DEBUG_HEAP
+#if CONFIG_HOST_MEMORY_MODEL
+
+/* host testbench allocator model, records each request and its result */
+void *memmap_record(void *ptr, int zone, uint32_t caps, size_t bytes);
+
+#define rmalloc(zone, caps, bytes)	\
+	memmap_record(_malloc(zone, caps, bytes), zone, caps, bytes)
+#define rzalloc(zone, caps, bytes)	\
+	memmap_record(_zalloc(zone, caps, bytes), zone, caps, bytes)
+#define rballoc(zone, caps, bytes)	\
+	memmap_record(_balloc(zone, caps, bytes), RZONE_BUFFER, caps, bytes)
+
+#elif CONFIG_DEBUG_HEAP
 
 #define rmalloc(zone, caps, bytes)			\
 	({void *_ptr;					\
@@ -60,4 +60,10 @@ static inline int32_t atomic_sub(atomic_t *a, int32_t value)
 	return arch_atomic_sub(a, value);
 }
 
+static inline int32_t atomic_cmpxchg(atomic_t *a, int32_t old,
+				     int32_t new_value)
+{
+	return arch_atomic_cmpxchg(a, old, new_value);
+}
+
 #endif
@@ -51,6 +51,7 @@
 #include <sof/audio/pipeline.h>
 #include <sof/cache.h>
 #include <sof/math/numbers.h>
+#include <sof/perf_cnt.h>
 #include <uapi/ipc/control.h>
 #include <uapi/ipc/stream.h>
 #include <uapi/ipc/topology.h>
@@ -264,6 +265,10 @@ struct comp_dev {
 	/* private data - core does not touch this */
 	void *private;		/**< private data */
 
+#if CONFIG_PERFORMANCE_COUNTERS
+	struct perf_cnt_data perf;	/**< comp_copy() cycles */
+#endif
+
 	/**
 	 * IPC config object header - MUST be at end as it's
 	 * variable size/type
@@ -464,6 +469,11 @@ static inline int comp_prepare(struct comp_dev *dev)
 	return 0;
 }
 
+#if CONFIG_HOST
+/* host testbench, runs the copy and accounts its cost */
+int tb_comp_copy(struct comp_dev *dev);
+#endif
+
 /**
  * Copy component buffers - mandatory.
  * @param dev Component device.
@@ -471,9 +481,24 @@ static inline int comp_prepare(struct comp_dev *dev)
  */
 static inline int comp_copy(struct comp_dev *dev)
 {
+#if CONFIG_PERFORMANCE_COUNTERS
+	uint32_t start = perf_cnt_cycles();
+#endif
+	int ret;
+
 	assert(dev->drv->ops.copy);
 
-	return dev->drv->ops.copy(dev);
+#if CONFIG_HOST
+	ret = tb_comp_copy(dev);
+#else
+	ret = dev->drv->ops.copy(dev);
+#endif
+
+#if CONFIG_PERFORMANCE_COUNTERS
+	perf_cnt_comp_update(dev, perf_cnt_cycles() - start);
+#endif
+
+	return ret;
 }
 
 /**
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file include/sof/audio/ima_adpcm.h
+ * \brief IMA-ADPCM block codec
+ */
+
+#ifndef __INCLUDE_AUDIO_IMA_ADPCM_H__
+#define __INCLUDE_AUDIO_IMA_ADPCM_H__
+
+#include <stdint.h>
+
+/** \brief Codec state of a single channel, also the block header. */
+struct ima_adpcm_state {
+	int16_t predictor; /**< last predicted sample */
+	uint8_t index; /**< step table index */
+	uint8_t reserved;
+};
+
+/**
+ * \brief Size in bytes of an encoded block.
+ *
+ * A block starts with one ima_adpcm_state header per channel followed
+ * by 4 bit codes of the interleaved samples, low nibble first. Every
+ * block can be decoded on its own.
+ */
+#define IMA_ADPCM_BLOCK_SIZE(frames, channels) \
+	((channels) * sizeof(struct ima_adpcm_state) + \
+	 (frames) * (channels) / 2)
+
+void ima_adpcm_encode_block(struct ima_adpcm_state *state,
+			    const int16_t *pcm, uint8_t *block,
+			    int frames, int channels);
+
+void ima_adpcm_decode_block(const uint8_t *block, int16_t *pcm,
+			    int frames, int channels);
+
+#endif
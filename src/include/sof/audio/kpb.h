@@ -36,6 +36,8 @@
 #include <sof/notifier.h>
 #include <sof/trace.h>
 #include <sof/schedule.h>
+#include <sof/lock.h>
+#include <sof/audio/ima_adpcm.h>
 
 /* KPB tracing */
 #define trace_kpb(__e, ...) trace_event(TRACE_CLASS_KPB, __e, ##__VA_ARGS__)
@@ -56,10 +58,21 @@
 #define KPB_NO_OF_HISTORY_BUFFERS 2 /**< no of internal buffers */
 #define KPB_ALLOCATION_STEP 0x100
 #define KPB_NO_OF_MEM_POOLS 3
+#define KPB_DRAINING_PERIOD_US 1000 /**< draining task period */
+#define KPB_DRAINING_CHUNK_MS 10 /**< max history drained per period */
+#define KPB_ADPCM_BLOCK_FRAMES 64 /**< frames per encoded history block */
+#define KPB_ADPCM_BLOCK_SAMPLES \
+	(KPB_ADPCM_BLOCK_FRAMES * KPB_MAX_SUPPORTED_CHANNELS)
+#define KPB_ADPCM_BLOCK_SIZE_MAX \
+	IMA_ADPCM_BLOCK_SIZE(KPB_ADPCM_BLOCK_FRAMES, KPB_MAX_SUPPORTED_CHANNELS)
+
+/* history buffer encoding, sof_kpb_config.codec */
+#define KPB_CODEC_NONE		0 /**< PCM, as received */
+#define KPB_CODEC_IMA_ADPCM	1 /**< IMA-ADPCM, 4:1 */
 
 enum kpb_state {
 	KPB_STATE_BUFFERING = 0,
-	KPB_STATE_DRAINING_ON_DEMAND,
+	KPB_STATE_DRAINING, /**< serving clients, still buffering */
 };
 
 enum kpb_event {
@@ -88,7 +101,7 @@ struct kpb_client {
 	uint32_t history_begin; /**< place where key phrase begins */
 	uint32_t history_end; /**< place where key phrase ends */
 	enum kpb_client_state state; /**< current state of a client */
-	void *r_ptr; /**< current read position */
+	void *r_ptr; /**< current read position in history buffer */
 	struct comp_buffer *sink; /**< client's sink */
 };
 
@@ -115,10 +128,18 @@ struct hb {
 
 struct dd {
 	struct comp_buffer *sink;
-	struct hb *history_buffer;
-	size_t history_depth;
+	struct hb *history_buffer; /**< current read buffer */
+	size_t history_depth; /**< bytes left to drain */
+	size_t chunk_size; /**< max bytes drained per task run */
 	uint8_t is_draining_active;
-	enum kpb_state *state;
+	struct kpb_client *client; /**< client being drained */
+	spinlock_t *lock;
+	size_t block_size; /**< encoded history block size, 0 for PCM */
+	uint32_t channels;
+	size_t pcm_size; /**< size of a decoded block */
+	size_t pcm_avail; /**< decoded bytes not yet copied to sink */
+	uint8_t block[KPB_ADPCM_BLOCK_SIZE_MAX]; /**< block being decoded */
+	int16_t pcm[KPB_ADPCM_BLOCK_SAMPLES]; /**< decoded block */
 };
 
 /** \brief kpb component configuration data. */
@@ -129,6 +150,7 @@ struct sof_kpb_config {
 	uint32_t history_depth; /**< time of buffering in milliseconds */
 	uint32_t sampling_freq; /**< frequency in hertz */
 	uint32_t sampling_width; /**< number of bits */
+	uint32_t codec; /**< history encoding, KPB_CODEC_ */
 };
 
 #ifdef UNIT_TEST
@@ -32,7 +32,20 @@
 #define __INCLUDE_AUDIO_MIXER_H__
 
 #ifdef UNIT_TEST
+#include <stdint.h>
+
+struct comp_dev;
+struct comp_buffer;
+
 void sys_comp_mixer_init(void);
+
+void mix_n_s16(struct comp_dev *dev, struct comp_buffer *sink,
+	       struct comp_buffer **sources, uint32_t num_sources,
+	       uint32_t frames);
+
+void mix_n_s32(struct comp_dev *dev, struct comp_buffer *sink,
+	       struct comp_buffer **sources, uint32_t num_sources,
+	       uint32_t frames);
 #endif
 
 #endif
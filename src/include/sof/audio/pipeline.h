@@ -40,6 +40,7 @@
 #include <sof/audio/component.h>
 #include <sof/trace.h>
 #include <sof/schedule.h>
+#include <sof/perf_cnt.h>
 #include <uapi/ipc/topology.h>
 
 /*
@@ -108,6 +109,13 @@ struct pipeline {
 
 	/* position update */
 	uint32_t posn_offset;		/* position update array offset*/
+
+#if CONFIG_PERFORMANCE_COUNTERS
+	/* period cycles against the period budget */
+	struct perf_cnt_data perf;
+	uint32_t perf_budget;		/* cycles per period */
+	uint32_t perf_overruns;		/* periods over budget */
+#endif
 };
 
 /* static pipeline */
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file include/sof/audio/vad.h
+ * \brief Voice activity detection stage
+ *
+ * Block processed level based voice activity detector. Level of a
+ * period is the mean absolute sample value of every n-th frame, per
+ * channel, combined across channels. The level is smoothed into an
+ * activation estimate, which is compared against a threshold. Users
+ * may gate their heavy processing on the returned activity state and
+ * other components may follow it through NOTIFIER_ID_VAD_STATE.
+ */
+
+#ifndef __INCLUDE_AUDIO_VAD_H__
+#define __INCLUDE_AUDIO_VAD_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sof/notifier.h>
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+
+#define VAD_MAX_CHANNELS	8
+
+/* channel combining modes */
+#define VAD_CHANNELS_MAX	0 /**< loudest channel decides */
+#define VAD_CHANNELS_AVG	1 /**< average of channels decides */
+
+/** \brief Voice activity detection configuration. */
+struct vad_config {
+	uint16_t shift;		/**< activation right shift, its speed */
+	int16_t threshold;	/**< activation threshold */
+	uint16_t decimation;	/**< level from every n-th frame, 0 or 1 all */
+	uint16_t mode;		/**< VAD_CHANNELS_ */
+	uint32_t hangover;	/**< frames to stay active below threshold */
+};
+
+/** \brief Payload of NOTIFIER_ID_VAD_STATE, message is the new state. */
+struct vad_event_data {
+	uint32_t comp_id;	/**< component running the stage */
+	int32_t activation;	/**< activation at state change */
+};
+
+/** \brief Voice activity detection stage state. */
+struct vad {
+	struct vad_config config;
+	int32_t activation;	/**< smoothed level */
+	uint32_t hangover;	/**< frames left before going inactive */
+	bool active;		/**< current activity state */
+
+	struct notify_data event;
+	struct vad_event_data event_data;
+};
+
+void vad_init(struct vad *vad, const struct vad_config *config,
+	      uint32_t comp_id);
+
+void vad_reset(struct vad *vad);
+
+bool vad_process(struct vad *vad, struct comp_buffer *source,
+		 uint32_t frames, uint32_t channels);
+
+/**
+ * \brief Sums absolute values of every n-th frame, per channel.
+ * \param[in] source Source buffer, read from its read pointer.
+ * \param[in] frames Number of frames available.
+ * \param[in] channels Number of interleaved channels.
+ * \param[in] decimation Frame step.
+ * \param[out] level Per channel sums.
+ * \return Number of frames summed.
+ */
+uint32_t vad_level_s16(struct comp_buffer *source, uint32_t frames,
+		       uint32_t channels, uint32_t decimation,
+		       int32_t *level);
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * DSP clock governor.
+ *
+ * Each core picks its own CPU clock from the platform cpu_freq table. Load
+ * is measured over windows of CONFIG_CLK_GOVERNOR_WINDOW ms as the larger
+ * of the non idle time of the core and the worst pipeline execution time
+ * relative to its period. Scheduler interrupts taken while the core waits
+ * for an interrupt count as busy. The lowest frequency leaving
+ * CONFIG_CLK_GOVERNOR_HEADROOM percent of headroom is selected, raising
+ * the clock at once and lowering it only after
+ * CONFIG_CLK_GOVERNOR_DOWN_WINDOWS windows asking for less.
+ */
+
+#ifndef __INCLUDE_CLK_GOV_H__
+#define __INCLUDE_CLK_GOV_H__
+
+#include <stdint.h>
+#include <config.h>
+
+struct pipeline;
+
+#if CONFIG_CLK_GOVERNOR
+
+void clk_gov_init(void);
+
+/* execution time of one pipeline period in platform timer ticks */
+void clk_gov_pipe_update(struct pipeline *p, uint64_t ticks);
+
+/* scheduler run from an interrupt on the calling core */
+void clk_gov_busy_enter(void);
+void clk_gov_busy_exit(void);
+
+/* idle loop of the calling core, exit changes the clock after a window */
+void clk_gov_idle_enter(void);
+void clk_gov_idle_exit(void);
+
+#else
+
+static inline void clk_gov_init(void)
+{
+}
+
+static inline void clk_gov_pipe_update(struct pipeline *p, uint64_t ticks)
+{
+}
+
+static inline void clk_gov_busy_enter(void)
+{
+}
+
+static inline void clk_gov_busy_exit(void)
+{
+}
+
+static inline void clk_gov_idle_enter(void)
+{
+}
+
+static inline void clk_gov_idle_exit(void)
+{
+}
+
+#endif
+
+#endif /* __INCLUDE_CLK_GOV_H__ */
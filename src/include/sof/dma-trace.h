@@ -40,9 +40,37 @@
 #include <sof/timer.h>
 #include <sof/dma.h>
 #include <sof/schedule.h>
+#include <sof/atomic.h>
 #include <platform/platform.h>
 #include <platform/timer.h>
 
+/* per core trace ring size, must be a power of 2 */
+#ifndef DMA_TRACE_RING_SIZE
+#define DMA_TRACE_RING_SIZE	(DMA_TRACE_LOCAL_SIZE / 2)
+#endif
+
+/* max size of a single trace record */
+#define DMA_TRACE_RECORD_MAX	64
+
+/* compact records of a core with absolute timestamp, every n-th record */
+#define DMA_TRACE_COMPACT_SYNC	64
+
+/*
+ * Per core trace ring. Only the owning core writes records, space is
+ * reserved with compare and swap so nested interrupts on that core can
+ * write too. The master core consumes records in trace_work().
+ */
+struct dma_trace_ring {
+	void *addr;		/* ring base address */
+	atomic_t w_pos;		/* reserved bytes, free running */
+	atomic_t r_pos;		/* consumed bytes, free running */
+	atomic_t dropped;	/* records dropped since last report */
+#if CONFIG_TRACE_COMPACT
+	uint64_t timestamp;	/* of last compact record sent */
+	uint32_t records;	/* compact records sent */
+#endif
+};
+
 struct dma_trace_buf {
 	void *w_ptr;		/* buffer write pointer */
 	void *r_ptr;		/* buffer read position */
@@ -65,7 +93,7 @@ struct dma_trace_data {
 	uint32_t enabled;
 	uint32_t copy_in_progress;
 	uint32_t stream_tag;
-	spinlock_t lock; /* dma trace lock */
+	struct dma_trace_ring rings[PLATFORM_CORE_COUNT];
 };
 
 int dma_trace_init_early(struct sof *sof);
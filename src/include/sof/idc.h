@@ -37,6 +37,7 @@
 #ifndef __INCLUDE_IDC_H__
 #define __INCLUDE_IDC_H__
 
+#include <platform/platform.h>
 #include <sof/schedule.h>
 #include <sof/trace.h>
 
@@ -61,6 +62,12 @@
 /** \brief IDC task deadline. */
 #define IDC_DEADLINE	100
 
+/** \brief Number of queued IDC messages per core pair, power of 2. */
+#define IDC_QUEUE_SIZE	8
+
+/** \brief Maximum size of IDC message payload in bytes. */
+#define IDC_MAX_PAYLOAD_SIZE	48
+
 /** \brief ROM wake version parsed by ROM during core wake up. */
 #define IDC_ROM_WAKE_VERSION	0x2
 
@@ -98,6 +105,10 @@
 #define IDC_MSG_NOTIFY		IDC_TYPE(0x5)
 #define IDC_MSG_NOTIFY_EXT	IDC_EXTENSION(0x0)
 
+/** \brief IDC doorbell message, target has queued messages. */
+#define IDC_MSG_DOORBELL	IDC_TYPE(0x6)
+#define IDC_MSG_DOORBELL_EXT	IDC_EXTENSION(0x0)
+
 /** \brief Decodes IDC message type. */
 #define iTS(x)	(((x) >> IDC_TYPE_SHIFT) & IDC_TYPE_MASK)
 
@@ -106,6 +117,30 @@ struct idc_msg {
 	uint32_t header;	/**< header value */
 	uint32_t extension;	/**< extension value */
 	uint32_t core;		/**< core id */
+	uint32_t seq;		/**< queue sequence number, set on send */
+	void *payload;		/**< payload copied to target core */
+	uint32_t payload_size;	/**< payload size in bytes */
+};
+
+/** \brief Queued IDC message. */
+struct idc_queue_msg {
+	uint32_t header;	/**< header value */
+	uint32_t extension;	/**< extension value */
+	int32_t ret;		/**< execution result */
+	uint32_t payload[IDC_MAX_PAYLOAD_SIZE / sizeof(uint32_t)];
+				/**< message payload */
+};
+
+/**
+ * \brief IDC message queue from one core to another.
+ *
+ * Queues are allocated uncached. Only the source core writes head and only
+ * the target core writes tail.
+ */
+struct idc_queue {
+	struct idc_queue_msg msg[IDC_QUEUE_SIZE];	/**< messages */
+	uint32_t head;		/**< number of messages sent */
+	uint32_t tail;		/**< number of messages executed */
 };
 
 /** \brief IDC data. */
@@ -113,7 +148,6 @@ struct idc {
 	spinlock_t lock;		/**< lock mechanism */
 	uint32_t busy_bit_mask;		/**< busy interrupt mask */
 	uint32_t done_bit_mask;		/**< done interrupt mask */
-	struct idc_msg received_msg;	/**< received message */
 	struct task idc_task;		/**< IDC processing task */
 };
 
@@ -41,21 +41,39 @@ struct sof;
 #define NOTIFIER_TARGET_CORE_MASK(x)	(1 << x)
 #define NOTIFIER_TARGET_CORE_ALL_MASK	0xFFFFFFFF
 
+/* notifier event flags */
+#define NOTIFIER_FLAG_SYNC	(1 << 0)	/* wait for remote cores */
+
 enum notify_id {
 	NOTIFIER_ID_CPU_FREQ = 0,
 	NOTIFIER_ID_I2S_FREQ,
 	NOTIFIER_ID_KPB_CLIENT_EVT,
+	NOTIFIER_ID_VAD_STATE,
+	NOTIFIER_ID_COUNT,
 };
 
+/* maximum size of event data sent to other cores */
+#define NOTIFIER_DATA_SIZE_MAX	32
+
 struct notify {
 	spinlock_t lock;	/* notifier lock */
-	struct list_item list;	/* list of notifiers */
+	struct list_item list[NOTIFIER_ID_COUNT];	/* notifiers per id */
+};
+
+/* event copied to the target core, sent as IDC payload */
+struct notify_payload {
+	uint32_t id;
+	uint32_t message;
+	uint32_t data_size;
+	uint32_t reserved;
+	uint8_t data[NOTIFIER_DATA_SIZE_MAX];
 };
 
 struct notify_data {
 	enum notify_id id;
 	uint32_t message;
 	uint32_t target_core_mask;
+	uint32_t flags;
 	uint32_t data_size;
 	void *data;
 };
@@ -69,11 +87,11 @@ struct notifier {
 
 struct notify **arch_notify_get(void);
 
-void notifier_register(struct notifier *notifier);
+int notifier_register(struct notifier *notifier);
 void notifier_unregister(struct notifier *notifier);
 
-void notifier_notify(void);
-void notifier_event(struct notify_data *notify_data);
+int notifier_notify_remote(void *payload);
+int notifier_event(struct notify_data *notify_data);
 
 void init_system_notify(struct sof *sof);
 
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Performance counters.
+ *
+ * Cycles spent in comp_copy() of each component and in the period of each
+ * pipeline are collected as min/avg/max over a window of
+ * CONFIG_PERFORMANCE_COUNTERS_WINDOW samples. The last complete window is
+ * kept for SOF_IPC_TRACE_PERF_GET and optionally traced when it closes.
+ */
+
+#ifndef __INCLUDE_PERF_CNT_H__
+#define __INCLUDE_PERF_CNT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <config.h>
+
+struct comp_dev;
+struct pipeline;
+struct ipc;
+struct sof_ipc_perf_get;
+struct sof_ipc_perf_data;
+
+struct perf_cnt_data {
+	/* current window */
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+
+	/* last complete window */
+	uint32_t last_min;
+	uint32_t last_avg;
+	uint32_t last_max;
+	uint32_t windows;
+};
+
+#if CONFIG_PERFORMANCE_COUNTERS
+
+#if CONFIG_HOST
+/* testbench mock of the DSP cycle counter, see src/host/perf.c */
+uint32_t perf_cnt_cycles(void);
+uint64_t perf_cnt_cycles_per_ms(int core);
+#else
+#include <sof/clk.h>
+#include <arch/timer.h>
+#include <platform/clk.h>
+
+static inline uint32_t perf_cnt_cycles(void)
+{
+	return arch_timer_get_cycles();
+}
+
+static inline uint64_t perf_cnt_cycles_per_ms(int core)
+{
+	return clock_ms_to_ticks(CLK_CPU(core), 1);
+}
+#endif
+
+/* adds a sample, returns true when it closed a window */
+static inline bool perf_cnt_update(struct perf_cnt_data *pc, uint32_t cycles)
+{
+	if (!pc->count || cycles < pc->min)
+		pc->min = cycles;
+	if (!pc->count || cycles > pc->max)
+		pc->max = cycles;
+	pc->sum += cycles;
+
+	if (++pc->count < CONFIG_PERFORMANCE_COUNTERS_WINDOW)
+		return false;
+
+	pc->last_min = pc->min;
+	pc->last_avg = pc->sum / pc->count;
+	pc->last_max = pc->max;
+	pc->windows++;
+
+	pc->count = 0;
+	pc->sum = 0;
+
+	return true;
+}
+
+void perf_cnt_comp_update(struct comp_dev *dev, uint32_t cycles);
+void perf_cnt_pipe_update(struct pipeline *p, uint32_t cycles);
+
+/* applies the request flags and fills one page of elems */
+int perf_cnt_get(struct ipc *ipc, struct sof_ipc_perf_get *req,
+		 struct sof_ipc_perf_data *data, uint32_t size);
+
+#endif
+
+#endif /* __INCLUDE_PERF_CNT_H__ */
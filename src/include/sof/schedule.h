@@ -35,6 +35,8 @@
 #include <stdint.h>
 #include <sof/list.h>
 #include <sof/trace.h>
+#include <uapi/ipc/trace.h>
+#include <config.h>
 
 /* schedule tracing */
 #define trace_schedule(format, ...) \
@@ -77,6 +79,7 @@ enum {
 #define SOF_SCHEDULE_FLAG_ASYNC (0 << 0) /* task scheduled asynchronously */
 #define SOF_SCHEDULE_FLAG_SYNC	(1 << 0) /* task scheduled synchronously */
 #define SOF_SCHEDULE_FLAG_IDLE  (2 << 0)
+#define SOF_SCHEDULE_FLAG_STATS	(4 << 0) /* histograms, task must be freed */
 
 struct task;
 
@@ -106,8 +109,126 @@ struct task {
 	struct list_item irq_list;	/* list for assigned irq level */
 	const struct scheduler_ops *ops;
 	void *private;
+#if CONFIG_SCHEDULE_HISTOGRAMS
+	struct task_stats *stats;	/* scheduling histograms */
+#endif
 };
 
+#if CONFIG_SCHEDULE_HISTOGRAMS
+
+/*
+ * Log2 histogram with a fixed footprint. Bucket 0 counts values below
+ * 1 << SCHED_HIST_SHIFT ticks, each next bucket doubles the range.
+ */
+#define SCHED_HIST_BUCKETS	SOF_IPC_SCHED_HIST_BUCKETS
+#define SCHED_HIST_SHIFT	5
+
+struct sched_hist {
+	uint32_t count[SCHED_HIST_BUCKETS];
+	uint32_t max;
+};
+
+/* per task statistics in scheduler clock ticks */
+struct task_stats {
+	struct list_item list;		/* list of all task stats */
+
+	/* task identity, copied as the task may go without a free */
+	uint16_t type;
+	uint16_t core;
+	uint16_t priority;
+	void *func;
+	void *data;
+
+	uint64_t due;			/* time the task should run at */
+	uint64_t run;			/* time the task started running */
+	uint32_t ticks_per_msec;
+	uint32_t runs;
+	uint32_t misses;		/* deadlines missed */
+	uint32_t late;			/* rescheduled past its deadline */
+	struct sched_hist latency;	/* due to running */
+	struct sched_hist exec;		/* running to complete */
+	struct sched_hist slack;	/* complete to deadline */
+};
+
+static inline void sched_hist_add(struct sched_hist *hist, uint64_t ticks)
+{
+	uint32_t val = ticks > UINT32_MAX ? UINT32_MAX : ticks;
+	uint32_t bucket = val >> SCHED_HIST_SHIFT;
+
+	if (bucket)
+		bucket = 32 - __builtin_clz(bucket);
+	if (bucket >= SCHED_HIST_BUCKETS)
+		bucket = SCHED_HIST_BUCKETS - 1;
+
+	hist->count[bucket]++;
+	if (val > hist->max)
+		hist->max = val;
+}
+
+/* task is due to run at ticks */
+static inline void task_stats_due(struct task *task, uint64_t due,
+				  uint32_t ticks_per_msec)
+{
+	if (!task->stats)
+		return;
+
+	task->stats->due = due;
+	task->stats->ticks_per_msec = ticks_per_msec;
+}
+
+static inline void task_stats_running(struct task *task, uint64_t now)
+{
+	struct task_stats *stats = task->stats;
+
+	if (!stats)
+		return;
+
+	stats->run = now;
+	stats->runs++;
+	sched_hist_add(&stats->latency,
+		       now > stats->due ? now - stats->due : 0);
+}
+
+/* deadline of 0 means the task has none */
+static inline void task_stats_complete(struct task *task, uint64_t now,
+				       uint64_t deadline)
+{
+	struct task_stats *stats = task->stats;
+
+	if (!stats)
+		return;
+
+	sched_hist_add(&stats->exec, now - stats->run);
+
+	/* misses are only counted here, once per run */
+	if (stats->late || (deadline && now > deadline))
+		stats->misses++;
+	else if (deadline)
+		sched_hist_add(&stats->slack, deadline - now);
+
+	stats->late = 0;
+}
+
+/* deadline passed before the task ran, counted as a miss on completion */
+static inline void task_stats_late(struct task *task)
+{
+	if (task->stats)
+		task->stats->late = 1;
+}
+
+/* applies the request flags and fills one page of elems */
+int schedule_stats_get(struct sof_ipc_sched_get *req,
+		       struct sof_ipc_sched_data *data, uint32_t size);
+
+#else
+
+#define task_stats_due(task, due, ticks_per_msec)
+#define task_stats_running(task, now)
+#define task_stats_complete(task, now, deadline)
+#define task_stats_late(task)
+
+#endif
+
 struct edf_schedule_data;
 struct ll_schedule_data;
 
@@ -115,6 +115,14 @@
 #define TRACE_CLASS_SCHEDULE_LL	(31 << 24)
 #define TRACE_CLASS_SOUNDWIRE	(32 << 24)
 #define TRACE_CLASS_KEYWORD	(33 << 24)
+#define TRACE_CLASS_NOTIFIER	(34 << 24)
+
+/* DMA trace record format, reported to host in fw_ready */
+#if CONFIG_TRACE_COMPACT
+#define TRACE_FORMAT	SOF_IPC_TRACE_FORMAT_COMPACT
+#else
+#define TRACE_FORMAT	SOF_IPC_TRACE_FORMAT_FULL
+#endif
 
 #ifdef CONFIG_HOST
 extern int test_bench_trace;
@@ -209,6 +217,49 @@ void trace_flush(void);
 void trace_off(void);
 void trace_init(struct sof *sof);
 
+struct sof_ipc_trace_filter;
+
+/* runtime trace filter, size of per class table and comp overrides */
+#define TRACE_FILTER_CLASS_COUNT	64
+#define TRACE_FILTER_COMP_COUNT		8
+
+/* filter override for a pipeline and/or component */
+struct trace_filter_comp {
+	uint32_t comp_class;	/* TRACE_CLASS_x or 0 for any */
+	int32_t id_0;		/* pipeline id or -1 for any */
+	int32_t id_1;		/* component id or -1 for any */
+	uint32_t level;		/* max traced level */
+};
+
+struct trace_filter {
+	uint8_t class_level[TRACE_FILTER_CLASS_COUNT];	/* max traced level */
+	uint32_t comp_count;
+	struct trace_filter_comp comp[TRACE_FILTER_COMP_COUNT];
+};
+
+extern struct trace_filter *trace_filter;
+
+int trace_filter_comp_check(uint32_t level, uint32_t comp_class,
+			    uint32_t id_0, uint32_t id_1);
+int trace_filter_update(const struct sof_ipc_trace_filter *msg);
+
+/* check if message is wanted, before any argument gets evaluated */
+static inline int trace_filter_check(uint32_t level, uint32_t comp_class,
+				     uint32_t id_0, uint32_t id_1)
+{
+	uint32_t idx = comp_class >> 24;
+
+	/* everything is traced until the filter is allocated */
+	if (!trace_filter)
+		return 1;
+
+	if (trace_filter->comp_count)
+		return trace_filter_comp_check(level, comp_class, id_0, id_1);
+
+	return idx >= TRACE_FILTER_CLASS_COUNT ||
+	       level <= trace_filter->class_level[idx];
+}
+
 #if CONFIG_TRACE
 /*
  * trace_event macro definition
@@ -352,9 +403,13 @@ do {									\
 
 #define _log_message(mbox, atomic, level, comp_class, id_0, id_1,	\
 		     has_ids, format, ...)				\
-	__log_message(META_CONCAT_SEQ(_trace_event, mbox, atomic),	\
-		      level, comp_class, id_0, id_1, has_ids, format,	\
-		      ##__VA_ARGS__)
+do {									\
+	if (trace_filter_check(level, comp_class, id_0, id_1))		\
+		__log_message(META_CONCAT_SEQ(_trace_event, mbox,	\
+					      atomic),			\
+			      level, comp_class, id_0, id_1, has_ids,	\
+			      format, ##__VA_ARGS__);			\
+} while (0)
 #else
 #define _DECLARE_LOG_ENTRY(lvl, format, comp_class, params, ids)\
 	static const struct {					\
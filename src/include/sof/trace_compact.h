@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Compact trace record encoder, see TRACE_COMPACT_START for the format.
+ * Kept free of firmware dependencies, so host tools can produce the same
+ * byte stream as the DMA trace.
+ */
+
+#ifndef __INCLUDE_TRACE_COMPACT_H__
+#define __INCLUDE_TRACE_COMPACT_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <uapi/user/trace.h>
+
+static inline uint32_t trace_compact_put_varint(uint8_t *dst, uint64_t value)
+{
+	uint32_t i = 0;
+
+	while (value >= 0x80) {
+		dst[i++] = (value & 0x7f) | 0x80;
+		value >>= 7;
+	}
+	dst[i++] = value;
+
+	return i;
+}
+
+/*
+ * Encode full record of length bytes, header and arguments, into dst of
+ * TRACE_COMPACT_MAX_SIZE bytes. The timestamp is a delta to last_timestamp
+ * unless abs_ts is set or time went backwards. entries_base is the address
+ * of the log entries section. Returns the record size in whole words.
+ */
+static inline uint32_t trace_compact_encode(const uint32_t *record,
+					    uint32_t length,
+					    uint64_t last_timestamp,
+					    int abs_ts, uint32_t entries_base,
+					    uint8_t *dst)
+{
+	struct log_entry_header header;
+	const uint32_t *params = record + sizeof(header) / sizeof(uint32_t);
+	uint32_t params_num = (length - sizeof(header)) / sizeof(uint32_t);
+	uint32_t index;
+	uint32_t size = 1;
+	uint32_t i;
+	uint8_t flags;
+
+	memcpy(&header, record, sizeof(header));
+	flags = TRACE_COMPACT_START |
+		(header.core_id & TRACE_COMPACT_CORE_MASK);
+
+	if (abs_ts || header.timestamp < last_timestamp) {
+		flags |= TRACE_COMPACT_ABS_TS;
+		size += trace_compact_put_varint(dst + size, header.timestamp);
+	} else {
+		size += trace_compact_put_varint(dst + size, header.timestamp -
+						 last_timestamp);
+	}
+
+	index = (header.log_entry_address - entries_base) >> 2;
+	if (header.log_entry_address >= entries_base && index <= 0xffff) {
+		dst[size++] = index;
+		dst[size++] = index >> 8;
+	} else {
+		flags |= TRACE_COMPACT_ADDR;
+		for (i = 0; i < sizeof(uint32_t); i++)
+			dst[size++] = header.log_entry_address >> (i * 8);
+	}
+
+	if (header.id_0 != TRACE_COMPACT_NO_ID ||
+	    header.id_1 != TRACE_COMPACT_NO_ID) {
+		flags |= TRACE_COMPACT_IDS;
+		size += trace_compact_put_varint(dst + size, header.id_0);
+		size += trace_compact_put_varint(dst + size, header.id_1);
+	}
+
+	/* zigzag, so small negative values are short too */
+	for (i = 0; i < params_num; i++)
+		size += trace_compact_put_varint(dst + size,
+						 (params[i] << 1) ^
+						 -(params[i] >> 31));
+
+	/* host DMA moves whole words */
+	while (size % sizeof(uint32_t))
+		dst[size++] = TRACE_COMPACT_PAD;
+
+	dst[0] = flags;
+
+	return size;
+}
+
+#endif /* __INCLUDE_TRACE_COMPACT_H__ */
@@ -59,14 +59,6 @@ static inline void wait_for_interrupt(int level)
 	tracev_event(TRACE_CLASS_WAIT, "WFX");
 }
 
-static uint64_t _wait_cb(void *data)
-{
-	volatile completion_t *wc = (volatile completion_t*)data;
-
-	wc->timeout = 1;
-	return 0;
-}
-
 static inline uint32_t wait_is_completed(completion_t *comp)
 {
 	volatile completion_t *c = (volatile completion_t *)comp;
@@ -86,9 +78,6 @@ static inline void wait_init(completion_t *comp)
 	volatile completion_t *c = (volatile completion_t *)comp;
 
 	c->complete = 0;
-
-	schedule_task_init(&comp->work, SOF_SCHEDULE_LL, SOF_TASK_PRI_MED,
-			   _wait_cb, comp, 0, 0);
 }
 
 static inline void wait_clear(completion_t *comp)
@@ -169,6 +169,9 @@
 
 #define SOF_IPC_TRACE_DMA_PARAMS		SOF_CMD_TYPE(0x001)
 #define SOF_IPC_TRACE_DMA_POSITION		SOF_CMD_TYPE(0x002)
+#define SOF_IPC_TRACE_FILTER_UPDATE		SOF_CMD_TYPE(0x003)
+#define SOF_IPC_TRACE_PERF_GET			SOF_CMD_TYPE(0x004)
+#define SOF_IPC_TRACE_SCHED_GET			SOF_CMD_TYPE(0x005)
 
 /** @} */
 
@@ -54,6 +54,10 @@ enum sof_ipc_ext_data {
 	SOF_IPC_EXT_WINDOW,
 };
 
+/* DMA trace record formats */
+#define SOF_IPC_TRACE_FORMAT_FULL	0	/* struct log_entry_header */
+#define SOF_IPC_TRACE_FORMAT_COMPACT	1	/* TRACE_COMPACT_ records */
+
 /* FW version - SOF_IPC_GLB_VERSION */
 struct sof_ipc_fw_version {
 	struct sof_ipc_hdr hdr;
@@ -65,9 +69,11 @@ struct sof_ipc_fw_version {
 	uint8_t time[10];
 	uint8_t tag[6];
 	uint32_t abi_version;
+	uint8_t trace_format;	/* SOF_IPC_TRACE_FORMAT_ */
+	uint8_t reserved0[3];
 
 	/* reserved for future use */
-	uint32_t reserved[4];
+	uint32_t reserved[3];
 } __attribute__((packed));
 
 /* FW ready Message - sent by firmware when boot has completed */
@@ -63,6 +63,127 @@ struct sof_ipc_dma_trace_posn {
 	uint32_t messages;	/* total trace messages */
 } __attribute__((packed));
 
+/*
+ * Runtime trace filter - SOF_IPC_TRACE_FILTER_UPDATE
+ *
+ * The message carries a list of filters. Each filter is a run of elements
+ * terminated by an element with SOF_IPC_TRACE_FILTER_ELEM_FIN set in key.
+ * A filter sets the max traced level of the matching class, pipeline and
+ * component. A filter with only a level resets the whole filter table.
+ */
+#define SOF_IPC_TRACE_FILTER_ELEM_SET_LEVEL	0x01	/* LOG_LEVEL_x */
+#define SOF_IPC_TRACE_FILTER_ELEM_BY_CLASS	0x02	/* TRACE_CLASS_x */
+#define SOF_IPC_TRACE_FILTER_ELEM_BY_PIPE	0x03	/* pipeline id */
+#define SOF_IPC_TRACE_FILTER_ELEM_BY_COMP	0x04	/* component id */
+#define SOF_IPC_TRACE_FILTER_ELEM_FIN		0x80	/* filter end */
+#define SOF_IPC_TRACE_FILTER_ELEM_TYPE_MASK	0x7f
+
+struct sof_ipc_trace_filter_elem {
+	uint32_t key;		/* SOF_IPC_TRACE_FILTER_ELEM_ */
+	uint32_t value;
+} __attribute__((packed));
+
+struct sof_ipc_trace_filter {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t elem_cnt;	/* number of elems */
+	uint32_t reserved[2];
+	struct sof_ipc_trace_filter_elem elems[];
+} __attribute__((packed));
+
+/*
+ * Performance counters - SOF_IPC_TRACE_PERF_GET
+ *
+ * Reads cycles spent in comp_copy() of each component and in the whole
+ * period of each pipeline as min/avg/max of the last complete window.
+ * Elements are returned in pages starting at first_elem, the reply tells
+ * the total so the host can read the rest. Flags are applied before the
+ * page is built.
+ */
+#define SOF_IPC_PERF_FLAG_RESET		(1 << 0)	/* clear all counters */
+#define SOF_IPC_PERF_FLAG_TRACE_ON	(1 << 1)	/* trace each window */
+#define SOF_IPC_PERF_FLAG_TRACE_OFF	(1 << 2)
+
+#define SOF_IPC_PERF_ELEM_COMP		0
+#define SOF_IPC_PERF_ELEM_PIPE		1
+
+struct sof_ipc_perf_get {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t first_elem;	/* first elem of the page */
+	uint32_t flags;		/* SOF_IPC_PERF_FLAG_ */
+	uint32_t reserved[2];
+} __attribute__((packed));
+
+struct sof_ipc_perf_elem {
+	uint16_t type;		/* SOF_IPC_PERF_ELEM_ */
+	uint16_t core;
+	uint32_t id;		/* component or pipeline id */
+	uint32_t pipeline_id;
+	uint32_t budget;	/* cycles per period, pipelines only */
+	uint32_t overruns;	/* periods over budget, pipelines only */
+	uint32_t min;		/* cycles */
+	uint32_t avg;
+	uint32_t max;
+	uint32_t windows;	/* complete windows so far */
+} __attribute__((packed));
+
+struct sof_ipc_perf_data {
+	struct sof_ipc_reply rhdr;
+	uint32_t elem_total;	/* elems in firmware */
+	uint32_t elem_cnt;	/* elems in this page */
+	uint32_t window;	/* samples per window */
+	uint32_t reserved;
+	struct sof_ipc_perf_elem elems[];
+} __attribute__((packed));
+
+/*
+ * Scheduler histograms - SOF_IPC_TRACE_SCHED_GET
+ *
+ * Per task histograms of wakeup latency, execution time and deadline slack
+ * in scheduler clock ticks. Bucket 0 counts values below 1 << bucket_shift,
+ * bucket n counts values below 1 << (bucket_shift + n) and the last bucket
+ * counts everything above. Missed deadlines are counted instead of slack.
+ * Elements are returned in pages starting at first_elem.
+ */
+#define SOF_IPC_SCHED_HIST_BUCKETS	16
+
+#define SOF_IPC_SCHED_FLAG_RESET	(1 << 0)	/* clear histograms */
+
+struct sof_ipc_sched_get {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t first_elem;	/* first elem of the page */
+	uint32_t flags;		/* SOF_IPC_SCHED_FLAG_ */
+	uint32_t reserved[2];
+} __attribute__((packed));
+
+struct sof_ipc_sched_hist {
+	uint32_t count[SOF_IPC_SCHED_HIST_BUCKETS];
+	uint32_t max;		/* ticks */
+} __attribute__((packed));
+
+struct sof_ipc_sched_elem {
+	uint16_t type;		/* SOF_SCHEDULE_ */
+	uint16_t core;
+	uint16_t priority;
+	uint16_t reserved;
+	uint32_t func;		/* task function address */
+	uint32_t data;		/* task data address */
+	uint32_t ticks_per_msec;
+	uint32_t runs;
+	uint32_t misses;	/* deadlines missed */
+	struct sof_ipc_sched_hist latency;	/* due to running */
+	struct sof_ipc_sched_hist exec;		/* running to complete */
+	struct sof_ipc_sched_hist slack;	/* complete to deadline */
+} __attribute__((packed));
+
+struct sof_ipc_sched_data {
+	struct sof_ipc_reply rhdr;
+	uint32_t elem_total;	/* elems in firmware */
+	uint32_t elem_cnt;	/* elems in this page */
+	uint32_t bucket_shift;
+	uint32_t reserved;
+	struct sof_ipc_sched_elem elems[];
+} __attribute__((packed));
+
 /*
  * Commom debug
  */
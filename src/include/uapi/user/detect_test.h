@@ -51,8 +51,17 @@ struct sof_detect_test_config {
 	/** activation threshold */
 	int16_t activation_threshold;
 
+	/** level computed from every n-th frame, 0 or 1 uses all frames */
+	uint16_t decimation;
+
+	/** channels combining, 0 loudest channel, 1 average of channels */
+	uint16_t channel_mode;
+
+	/** time in milliseconds to stay active below threshold */
+	uint32_t hangover;
+
 	/** reserved for future use */
-	uint32_t reserved[3];
+	uint32_t reserved[1];
 } __attribute__((packed));
 
 /** used for binary blob size sanity checks */
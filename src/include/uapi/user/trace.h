@@ -120,4 +120,37 @@ struct log_entry_header {
 	uint32_t log_entry_address;	/* Address of log entry in ELF */
 } __attribute__((packed));
 
+/*
+ * Compact log record, used by DMA trace when firmware reports
+ * SOF_IPC_TRACE_FORMAT_COMPACT. Records are a byte stream, each one padded
+ * with TRACE_COMPACT_PAD bytes to whole words:
+ *
+ *  u8     flags, TRACE_COMPACT_ bits and reporting core's id
+ *  varint timestamp, delta to previous record of the same core unless
+ *         TRACE_COMPACT_ABS_TS is set
+ *  u16    log entry index, (address - entries section base) / 4, or
+ *         u32 log entry address if TRACE_COMPACT_ADDR is set
+ *  varint id_0, varint id_1, only if TRACE_COMPACT_IDS is set, both
+ *         are TRACE_COMPACT_NO_ID otherwise
+ *  varint arguments, zigzag coded, number is given by the log entry
+ *
+ * Varints are unsigned LEB128, other multibyte fields are little endian.
+ */
+#define TRACE_COMPACT_START	0x80	/* set in every record */
+#define TRACE_COMPACT_ABS_TS	0x40	/* absolute timestamp */
+#define TRACE_COMPACT_ADDR	0x20	/* full entry address */
+#define TRACE_COMPACT_IDS	0x10	/* ids follow */
+#define TRACE_COMPACT_CORE_MASK	0x0f
+
+#define TRACE_COMPACT_NO_ID	((1 << TRACE_ID_LENGTH) - 1)
+
+/* padding, never a valid flags byte */
+#define TRACE_COMPACT_PAD	0x00
+
+/*
+ * Longest compact record: flags, timestamp, address, ids, 4 arguments,
+ * padded to whole words.
+ */
+#define TRACE_COMPACT_MAX_SIZE	((1 + 10 + 4 + 2 * 2 + 4 * 5 + 3) & ~3)
+
 #endif //#ifndef __INCLUDE_LOGGING__
@@ -48,6 +48,7 @@
 #include <sof/wait.h>
 #include <sof/trace.h>
 #include <sof/math/numbers.h>
+#include <sof/perf_cnt.h>
 #include <platform/interrupt.h>
 #include <platform/mailbox.h>
 #include <platform/dma.h>
@@ -798,6 +799,73 @@ int ipc_dma_trace_send_position(void)
 				      sizeof(posn), 1);
 }
 
+static int ipc_trace_filter_update(uint32_t header)
+{
+	struct sof_ipc_trace_filter *filter = _ipc->comp_data;
+	int ret;
+
+	if (filter->hdr.size < sizeof(*filter) ||
+	    filter->elem_cnt > (filter->hdr.size - sizeof(*filter)) /
+			       sizeof(filter->elems[0])) {
+		trace_ipc_error("ipc: invalid trace filter size %u",
+				filter->hdr.size);
+		return -EINVAL;
+	}
+
+	ret = trace_filter_update(filter);
+	if (ret < 0)
+		trace_ipc_error("ipc: trace filter update failed %d", ret);
+
+	return ret;
+}
+
+#if CONFIG_PERFORMANCE_COUNTERS
+static int ipc_trace_perf_get(uint32_t header)
+{
+	struct sof_ipc_perf_data *data = _ipc->comp_data;
+	struct sof_ipc_perf_get req;
+	int ret;
+
+	/* copy message with ABI safe method, reply is built in place */
+	IPC_COPY_CMD(req, _ipc->comp_data);
+
+	ret = perf_cnt_get(_ipc, &req, data,
+			   MIN(MAILBOX_HOSTBOX_SIZE, SOF_IPC_MSG_MAX_SIZE));
+	if (ret < 0) {
+		trace_ipc_error("ipc: perf get failed %d", ret);
+		return ret;
+	}
+
+	mailbox_hostbox_write(0, data, data->rhdr.hdr.size);
+
+	return 1;
+}
+#endif
+
+#if CONFIG_SCHEDULE_HISTOGRAMS
+static int ipc_trace_sched_get(uint32_t header)
+{
+	struct sof_ipc_sched_data *data = _ipc->comp_data;
+	struct sof_ipc_sched_get req;
+	int ret;
+
+	/* copy message with ABI safe method, reply is built in place */
+	IPC_COPY_CMD(req, _ipc->comp_data);
+
+	ret = schedule_stats_get(&req, data,
+				 MIN(MAILBOX_HOSTBOX_SIZE,
+				     SOF_IPC_MSG_MAX_SIZE));
+	if (ret < 0) {
+		trace_ipc_error("ipc: sched get failed %d", ret);
+		return ret;
+	}
+
+	mailbox_hostbox_write(0, data, data->rhdr.hdr.size);
+
+	return 1;
+}
+#endif
+
 static int ipc_glb_debug_message(uint32_t header)
 {
 	uint32_t cmd = iCS(header);
@@ -807,6 +875,16 @@ static int ipc_glb_debug_message(uint32_t header)
 	switch (cmd) {
 	case SOF_IPC_TRACE_DMA_PARAMS:
 		return ipc_dma_trace_config(header);
+	case SOF_IPC_TRACE_FILTER_UPDATE:
+		return ipc_trace_filter_update(header);
+#if CONFIG_PERFORMANCE_COUNTERS
+	case SOF_IPC_TRACE_PERF_GET:
+		return ipc_trace_perf_get(header);
+#endif
+#if CONFIG_SCHEDULE_HISTOGRAMS
+	case SOF_IPC_TRACE_SCHED_GET:
+		return ipc_trace_sched_get(header);
+#endif
 	default:
 		trace_ipc_error("ipc: unknown debug cmd 0x%x", cmd);
 		return -EINVAL;
@@ -846,8 +924,9 @@ static int ipc_glb_gdb_debug(uint32_t header)
 static int ipc_comp_cmd(struct comp_dev *dev, int cmd,
 			struct sof_ipc_ctrl_data *data, int size)
 {
-	struct idc_msg comp_cmd_msg;
 	int core = dev->pipeline->ipc_pipe.core;
+	struct idc_msg comp_cmd_msg = { IDC_MSG_COMP_CMD,
+		IDC_MSG_COMP_CMD_EXT(cmd), core };
 
 	/* pipeline running on other core */
 	if (dev->pipeline->status == COMP_STATE_ACTIVE &&
@@ -857,11 +936,6 @@ static int ipc_comp_cmd(struct comp_dev *dev, int cmd,
 		if (!cpu_is_core_enabled(core))
 			return -EINVAL;
 
-		/* build IDC message */
-		comp_cmd_msg.header = IDC_MSG_COMP_CMD;
-		comp_cmd_msg.extension = IDC_MSG_COMP_CMD_EXT(cmd);
-		comp_cmd_msg.core = core;
-
 		/* send IDC component command message */
 		return idc_send_msg(&comp_cmd_msg, IDC_BLOCKING);
 	} else {
@@ -541,6 +541,7 @@ int ipc_get_page_descriptors(struct dma *dmac, uint8_t *page_table,
 	config.src_width = sizeof(uint32_t);
 	config.dest_width = sizeof(uint32_t);
 	config.cyclic = 0;
+	config.irq_periods = 0;
 	config.irq_disabled = false;
 	dma_sg_init(&config.elem_array);
 
@@ -36,6 +36,7 @@
 
 #include <sof/sof.h>
 #include <sof/agent.h>
+#include <sof/clk_gov.h>
 #include <sof/debug.h>
 #include <sof/panic.h>
 #include <sof/alloc.h>
@@ -57,6 +58,16 @@ void sa_enter_idle(struct sof *sof)
 	struct sa *sa = sof->sa;
 
 	sa->last_idle = platform_timer_get(platform_timer);
+	clk_gov_idle_enter();
+}
+
+/*
+ * Notify the SA that we have left idle state, idle time feeds the clock
+ * governor.
+ */
+void sa_exit_idle(struct sof *sof)
+{
+	clk_gov_idle_exit();
 }
 
 static uint64_t validate(void *data)
@@ -99,4 +110,6 @@ void sa_init(struct sof *sof)
 			   validate, sa, 0, 0);
 
 	schedule_task(&sa->work, PLATFORM_IDLE_TIME, 0, 0);
+
+	clk_gov_init();
 }
@@ -93,6 +93,7 @@ void clock_set_freq(int clock, uint32_t hz)
 	uint32_t idx;
 	uint32_t flags;
 
+	notify_data.flags = NOTIFIER_FLAG_SYNC;
 	notify_data.data_size = sizeof(clk_notify_data);
 	notify_data.data = &clk_notify_data;
 
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sof/clk_gov.h>
+#include <sof/clk.h>
+#include <sof/alloc.h>
+#include <sof/cpu.h>
+#include <sof/trace.h>
+#include <sof/audio/component.h>
+#include <sof/audio/pipeline.h>
+#include <sof/drivers/timer.h>
+#include <platform/clk.h>
+#include <platform/clk-map.h>
+#include <platform/platform.h>
+#include <platform/timer.h>
+#include <config.h>
+#include <stdint.h>
+
+#define trace_clk_gov(__e, ...) \
+	trace_event(TRACE_CLASS_CLK, __e, ##__VA_ARGS__)
+
+struct clk_gov_data {
+	/* current window, platform timer ticks */
+	uint64_t win_start;
+	uint64_t win_ticks;
+	uint64_t idle;
+	uint32_t pipe_load;	/* worst pipeline period, per mille */
+
+	/* scheduler runs from interrupts are not idle */
+	uint64_t idle_start;
+	uint64_t idle_busy;	/* scheduler time since idle_start */
+	uint64_t busy_start;
+	uint32_t busy_depth;	/* nested scheduler interrupts */
+
+	/* hysteresis of lowering the clock */
+	uint32_t down_idx;	/* highest index asked for while lower */
+	uint32_t down_windows;
+};
+
+/* one entry per core, each core only updates its own */
+static struct clk_gov_data *clk_gov;
+
+/* index of the CPU clock in cpu_freq, the table is sorted ascending */
+static uint32_t clk_gov_cur_idx(int core)
+{
+	uint64_t ticks_per_msec = clock_ms_to_ticks(CLK_CPU(core), 1);
+	uint32_t i;
+
+	for (i = 0; i < ARRAY_SIZE(cpu_freq) - 1; i++) {
+		if (ticks_per_msec <= cpu_freq[i].ticks_per_msec)
+			break;
+	}
+
+	return i;
+}
+
+static void clk_gov_win_start(struct clk_gov_data *gd)
+{
+	gd->win_start = platform_timer_get(platform_timer);
+	gd->win_ticks = clock_ms_to_ticks(PLATFORM_SCHED_CLOCK,
+					  CONFIG_CLK_GOVERNOR_WINDOW);
+	gd->idle = 0;
+	gd->pipe_load = 0;
+}
+
+static void clk_gov_select(struct clk_gov_data *gd, int core, uint32_t load)
+{
+	uint32_t cur = clk_gov_cur_idx(core);
+	uint64_t need;
+	uint32_t idx;
+
+	/* cycles needed per second with the headroom kept free */
+	need = (uint64_t)cpu_freq[cur].freq * load / 1000 *
+		(100 + CONFIG_CLK_GOVERNOR_HEADROOM) / 100;
+
+	for (idx = 0; idx < ARRAY_SIZE(cpu_freq) - 1; idx++) {
+		if (need <= cpu_freq[idx].freq)
+			break;
+	}
+
+	if (idx < cur) {
+		/* go down to the highest index of the last windows */
+		gd->down_idx = gd->down_windows ? MAX(gd->down_idx, idx) : idx;
+		if (++gd->down_windows < CONFIG_CLK_GOVERNOR_DOWN_WINDOWS)
+			return;
+		idx = gd->down_idx;
+	}
+
+	gd->down_windows = 0;
+	if (idx == cur)
+		return;
+
+	trace_clk_gov("clk_gov_select() core %d load %u freq %u",
+		      core, load, cpu_freq[idx].freq);
+
+	/* drivers are told through CLOCK_NOTIFY_PRE and CLOCK_NOTIFY_POST */
+	clock_set_freq(CLK_CPU(core), cpu_freq[idx].freq);
+}
+
+void clk_gov_pipe_update(struct pipeline *p, uint64_t ticks)
+{
+	uint64_t period;
+	uint32_t load;
+
+	if (!clk_gov || !p->ipc_pipe.period)
+		return;
+
+	period = clock_ms_to_ticks(PLATFORM_SCHED_CLOCK, 1) *
+		p->ipc_pipe.period / 1000;
+	load = MIN(ticks * 1000 / MAX(period, 1), 1000);
+
+	clk_gov[cpu_get_id()].pipe_load =
+		MAX(clk_gov[cpu_get_id()].pipe_load, load);
+}
+
+void clk_gov_busy_enter(void)
+{
+	struct clk_gov_data *gd;
+
+	if (!clk_gov)
+		return;
+
+	gd = &clk_gov[cpu_get_id()];
+	if (!gd->busy_depth++)
+		gd->busy_start = platform_timer_get(platform_timer);
+}
+
+void clk_gov_busy_exit(void)
+{
+	struct clk_gov_data *gd;
+
+	if (!clk_gov)
+		return;
+
+	gd = &clk_gov[cpu_get_id()];
+	if (gd->busy_depth && !--gd->busy_depth)
+		gd->idle_busy += platform_timer_get(platform_timer) -
+			gd->busy_start;
+}
+
+void clk_gov_idle_enter(void)
+{
+	struct clk_gov_data *gd;
+
+	if (!clk_gov)
+		return;
+
+	gd = &clk_gov[cpu_get_id()];
+	gd->idle_busy = 0;
+	gd->idle_start = platform_timer_get(platform_timer);
+}
+
+/*
+ * Called from the passive level of the idle loop, so the clock is never
+ * changed under a running pipeline. Low latency and EDF tasks run from
+ * interrupts while the core waits, their time is taken out of the idle.
+ */
+void clk_gov_idle_exit(void)
+{
+	struct clk_gov_data *gd;
+	int core = cpu_get_id();
+	uint64_t elapsed;
+	uint64_t ticks;
+	uint32_t load;
+
+	if (!clk_gov)
+		return;
+
+	gd = &clk_gov[core];
+
+	/* first call on this core */
+	if (!gd->win_ticks) {
+		clk_gov_win_start(gd);
+		return;
+	}
+
+	ticks = platform_timer_get(platform_timer) - gd->idle_start;
+	gd->idle += ticks - MIN(gd->idle_busy, ticks);
+	elapsed = platform_timer_get(platform_timer) - gd->win_start;
+	if (elapsed < gd->win_ticks)
+		return;
+
+	load = (elapsed - MIN(gd->idle, elapsed)) * 1000 / elapsed;
+	load = MAX(load, gd->pipe_load);
+
+	clk_gov_select(gd, core, load);
+
+	/* ticks may have a new rate, start a clean window */
+	clk_gov_win_start(gd);
+}
+
+void clk_gov_init(void)
+{
+	trace_clk_gov("clk_gov_init()");
+
+	clk_gov = rzalloc(RZONE_SYS | RZONE_FLAG_UNCACHED, SOF_MEM_CAPS_RAM,
+			  sizeof(*clk_gov) * PLATFORM_CORE_COUNT);
+}
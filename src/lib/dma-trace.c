@@ -30,6 +30,7 @@
 
 #include <sof/trace.h>
 #include <sof/dma-trace.h>
+#include <sof/trace_compact.h>
 #include <sof/ipc.h>
 #include <sof/sof.h>
 #include <sof/alloc.h>
@@ -39,27 +40,42 @@
 #include <platform/platform.h>
 #include <sof/lock.h>
 #include <sof/cpu.h>
+#include <uapi/user/trace.h>
+#include <stddef.h>
 #include <stdint.h>
 
-static struct dma_trace_data *trace_data = NULL;
+/*
+ * Ring record header, tagged with the record position so the reader can
+ * tell a committed record from stale data of the previous lap.
+ */
+#define DTRACE_RING_HDR_SIZE		sizeof(uint32_t)
+#define DTRACE_RING_TAG(pos)		(((pos) >> 2) & 0xffff)
+#define DTRACE_RING_HDR(pos, len)	((DTRACE_RING_TAG(pos) << 16) | (len))
+#define DTRACE_RING_HDR_TAG(hdr)	((hdr) >> 16)
+#define DTRACE_RING_HDR_LEN(hdr)	((hdr) & 0xffff)
 
-/* amount of dropped entries */
-static uint32_t dropped_entries;
+static struct dma_trace_data *trace_data;
 
 static int dma_trace_get_avail_data(struct dma_trace_data *d,
 				    struct dma_trace_buf *buffer,
 				    int avail);
+static void dtrace_gather(struct dma_trace_data *d);
+static void dtrace_report_dropped(struct dma_trace_data *d);
 
 static uint64_t trace_work(void *data)
 {
 	struct dma_trace_data *d = (struct dma_trace_data *)data;
 	struct dma_trace_buf *buffer = &d->dmatb;
 	struct dma_sg_config *config = &d->config;
-	unsigned long flags;
-	uint32_t avail = buffer->avail;
+	uint32_t avail;
 	int32_t size;
 	uint32_t overflow;
 
+	/* move records from per core rings to the DMA buffer */
+	dtrace_report_dropped(d);
+	dtrace_gather(d);
+	avail = buffer->avail;
+
 	/* make sure we don't write more than buffer */
 	if (avail > DMA_TRACE_LOCAL_SIZE) {
 		overflow = avail - DMA_TRACE_LOCAL_SIZE;
@@ -102,8 +118,6 @@ static uint64_t trace_work(void *data)
 		buffer->r_ptr -= DMA_TRACE_LOCAL_SIZE;
 
 out:
-	spin_lock_irq(&d->lock, flags);
-
 	/* disregard any old messages and don't resend them if we overflow */
 	if (size > 0) {
 		if (d->overflow)
@@ -115,8 +129,6 @@ out:
 	/* DMA trace copying is done, allow reschedule */
 	d->copy_in_progress = 0;
 
-	spin_unlock_irq(&d->lock, flags);
-
 	/* reschedule the trace copying work */
 	return DMA_TRACE_PERIOD;
 }
@@ -127,7 +139,6 @@ int dma_trace_init_early(struct sof *sof)
 			     sizeof(*trace_data));
 
 	dma_sg_init(&trace_data->config.elem_array);
-	spinlock_init(&trace_data->lock);
 	sof->dmat = trace_data;
 
 	return 0;
@@ -168,6 +179,35 @@ int dma_trace_host_buffer(struct dma_trace_data *d,
 static int dma_trace_buffer_init(struct dma_trace_data *d)
 {
 	struct dma_trace_buf *buffer = &d->dmatb;
+	struct dma_trace_ring *ring;
+	int i;
+
+	/* allocate per core rings, cores start writing once addr is set */
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		ring = &d->rings[i];
+#if CONFIG_TRACE_COMPACT
+		/* host starts decoding from scratch */
+		ring->records = 0;
+#endif
+		if (ring->addr)
+			continue;
+
+		ring->addr = rballoc(RZONE_BUFFER,
+				     SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_DMA,
+				     DMA_TRACE_RING_SIZE);
+		if (!ring->addr) {
+			trace_buffer_error("dma_trace_buffer_init() error: "
+					   "ring alloc failed");
+			return -ENOMEM;
+		}
+
+		bzero(ring->addr, DMA_TRACE_RING_SIZE);
+		dcache_writeback_invalidate_region(ring->addr,
+						   DMA_TRACE_RING_SIZE);
+		atomic_init(&ring->w_pos, 0);
+		atomic_init(&ring->r_pos, 0);
+		atomic_init(&ring->dropped, 0);
+	}
 
 	/* allocate new buffer */
 	buffer->addr = rballoc(RZONE_BUFFER,
@@ -217,6 +257,7 @@ static int dma_trace_start(struct dma_trace_data *d)
 	config.src_width = sizeof(uint32_t);
 	config.dest_width = sizeof(uint32_t);
 	config.cyclic = 0;
+	config.irq_periods = 0;
 
 	err = dma_sg_alloc(&config.elem_array, RZONE_SYS,
 			   config.direction,
@@ -343,6 +384,10 @@ void dma_trace_flush(void *t)
 	if (!trace_data || !trace_data->dmatb.addr)
 		return;
 
+	/* rings are only consumed on master core */
+	if (cpu_get_id() == PLATFORM_MASTER_CORE_ID)
+		dtrace_gather(trace_data);
+
 	buffer = &trace_data->dmatb;
 	avail = buffer->avail;
 
@@ -394,97 +439,274 @@ static int dtrace_calc_buf_overflow(struct dma_trace_buf *buffer,
 	return overflow;
 }
 
+/* copy record to DMA buffer, master core only */
 static void dtrace_add_event(const char *e, uint32_t length)
 {
 	struct dma_trace_buf *buffer = &trace_data->dmatb;
 	uint32_t margin;
-	uint32_t overflow = 0;
 
 	margin = dtrace_calc_buf_margin(buffer);
-	overflow = dtrace_calc_buf_overflow(buffer, length);
-
-	/* tracing dropped entries */
-	if (dropped_entries) {
-		if (!overflow) {
-			/*
-			 * if any dropped entries have appeared and there
-			 * is not any overflow, their amount will be logged
-			 */
-#if CONFIG_TRACE
-			uint32_t tmp_dropped_entries = dropped_entries;
+
+	/* check for buffer wrap */
+	if (margin > length) {
+		/* no wrap */
+		memcpy(buffer->w_ptr, e, length);
+		dcache_writeback_invalidate_region(buffer->w_ptr, length);
+		buffer->w_ptr += length;
+	} else {
+		/* data is bigger than remaining margin so we wrap */
+		memcpy(buffer->w_ptr, e, margin);
+		dcache_writeback_invalidate_region(buffer->w_ptr, margin);
+		buffer->w_ptr = buffer->addr;
+
+		memcpy(buffer->w_ptr, e + margin, length - margin);
+		dcache_writeback_invalidate_region(buffer->w_ptr,
+						   length - margin);
+		buffer->w_ptr += length - margin;
+	}
+
+	buffer->avail += length;
+	trace_data->messages++;
+}
+
+/* copy into ring at free running position pos, owning core only */
+static void dtrace_ring_copy_in(struct dma_trace_ring *ring, uint32_t pos,
+				const void *src, uint32_t length)
+{
+	uint32_t offset = pos & (DMA_TRACE_RING_SIZE - 1);
+	uint32_t tail = DMA_TRACE_RING_SIZE - offset;
+	void *dst = ring->addr + offset;
+
+	if (length <= tail) {
+		memcpy(dst, src, length);
+		dcache_writeback_region(dst, length);
+	} else {
+		memcpy(dst, src, tail);
+		dcache_writeback_region(dst, tail);
+		memcpy(ring->addr, src + tail, length - tail);
+		dcache_writeback_region(ring->addr, length - tail);
+	}
+}
+
+/* copy out of ring at free running position pos, master core only */
+static void dtrace_ring_copy_out(struct dma_trace_ring *ring, uint32_t pos,
+				 void *dst, uint32_t length)
+{
+	uint32_t offset = pos & (DMA_TRACE_RING_SIZE - 1);
+	uint32_t tail = DMA_TRACE_RING_SIZE - offset;
+	void *src = ring->addr + offset;
+
+	if (length <= tail) {
+		dcache_invalidate_region(src, length);
+		memcpy(dst, src, length);
+	} else {
+		dcache_invalidate_region(src, tail);
+		memcpy(dst, src, tail);
+		dcache_invalidate_region(ring->addr, length - tail);
+		memcpy(dst + tail, ring->addr, length - tail);
+	}
+}
+
+static void dtrace_ring_write(struct dma_trace_ring *ring, const char *e,
+			      uint32_t length)
+{
+	uint32_t size = DTRACE_RING_HDR_SIZE + ALIGN(length, sizeof(uint32_t));
+	uint32_t hdr;
+	uint32_t w;
+
+	/* reserve space, may race with interrupts nested on this core */
+	do {
+		w = atomic_read(&ring->w_pos);
+		if (w + size - atomic_read(&ring->r_pos) >
+		    DMA_TRACE_RING_SIZE) {
+			/* no room, reported later by trace_work() */
+			atomic_add(&ring->dropped, 1);
+			return;
+		}
+	} while (atomic_cmpxchg(&ring->w_pos, w, w + size) != w);
+
+	/* header goes last and commits the record */
+	dtrace_ring_copy_in(ring, w + DTRACE_RING_HDR_SIZE, e, length);
+	hdr = DTRACE_RING_HDR(w, length);
+	dtrace_ring_copy_in(ring, w, &hdr, sizeof(hdr));
+}
+
+/* get length and timestamp of oldest committed record in ring */
+static int dtrace_ring_peek(struct dma_trace_ring *ring, uint32_t *length,
+			    uint64_t *timestamp)
+{
+	uint32_t r = atomic_read(&ring->r_pos);
+	uint32_t hdr;
+
+	if (!ring->addr || r == atomic_read(&ring->w_pos))
+		return 0;
+
+	/* reserved but not committed yet */
+	dtrace_ring_copy_out(ring, r, &hdr, sizeof(hdr));
+	if (DTRACE_RING_HDR_TAG(hdr) != DTRACE_RING_TAG(r) ||
+	    !DTRACE_RING_HDR_LEN(hdr))
+		return 0;
+
+	*length = DTRACE_RING_HDR_LEN(hdr);
+	*timestamp = 0;
+	if (*length >= sizeof(struct log_entry_header))
+		dtrace_ring_copy_out(ring, r + DTRACE_RING_HDR_SIZE +
+				     offsetof(struct log_entry_header,
+					      timestamp),
+				     timestamp, sizeof(*timestamp));
+
+	return 1;
+}
+
+#if CONFIG_TRACE_COMPACT
+/*
+ * Encode full record as compact record into dst, see TRACE_COMPACT_START.
+ * Ring state is updated by the caller once the record is sent.
+ */
+static uint32_t dtrace_compact(struct dma_trace_ring *ring,
+			       const uint32_t *record, uint32_t length,
+			       uint8_t *dst)
+{
+	/* absolute now and then, so host can resync after lost data */
+	return trace_compact_encode(record, length, ring->timestamp,
+				    !(ring->records % DMA_TRACE_COMPACT_SYNC),
+				    LOG_ENTRY_ELF_BASE, dst);
+}
+#endif
+
+/*
+ * Move committed records from all rings into the DMA buffer, oldest
+ * timestamp first. Records stay in their rings while the DMA buffer
+ * is full.
+ */
+static void dtrace_gather(struct dma_trace_data *d)
+{
+	uint32_t record[DMA_TRACE_RECORD_MAX / sizeof(uint32_t)];
+#if CONFIG_TRACE_COMPACT
+	uint8_t compact[TRACE_COMPACT_MAX_SIZE];
 #endif
-			dropped_entries = 0;
-			/*
-			 * this trace_error invocation causes recursion,
-			 * so after it we have to recalculate margin and
-			 * overflow
-			 */
-			trace_error(0, "dtrace_add_event() error: "
-				    "number of dropped logs = %u",
-				    tmp_dropped_entries);
-			margin = dtrace_calc_buf_margin(buffer);
-			overflow = dtrace_calc_buf_overflow(buffer, length);
+	struct dma_trace_ring *next;
+	const char *out;
+	uint64_t timestamp;
+	uint64_t next_timestamp = 0;
+	uint32_t length;
+	uint32_t next_length = 0;
+	uint32_t r;
+	int i;
+
+	for (;;) {
+		next = NULL;
+		for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+			if (!dtrace_ring_peek(&d->rings[i], &length,
+					      &timestamp))
+				continue;
+
+			if (!next || timestamp < next_timestamp) {
+				next = &d->rings[i];
+				next_timestamp = timestamp;
+				next_length = length;
+			}
 		}
-	}
 
-	/* checking overflow */
-	if (!overflow) {
-		/* check for buffer wrap */
-		if (margin > length) {
-			/* no wrap */
-			memcpy(buffer->w_ptr, e, length);
-			dcache_writeback_invalidate_region(buffer->w_ptr,
-							   length);
-			buffer->w_ptr += length;
-		} else {
-			/* data is bigger than remaining margin so we wrap */
-			memcpy(buffer->w_ptr, e, margin);
-			dcache_writeback_invalidate_region(buffer->w_ptr,
-							   margin);
-			buffer->w_ptr = buffer->addr;
-
-			memcpy(buffer->w_ptr, e + margin, length - margin);
-			dcache_writeback_invalidate_region(buffer->w_ptr,
-							   length - margin);
-			buffer->w_ptr += length - margin;
+		if (!next)
+			return;
+
+		r = atomic_read(&next->r_pos);
+		dtrace_ring_copy_out(next, r + DTRACE_RING_HDR_SIZE, record,
+				     next_length);
+		out = (const char *)record;
+		length = next_length;
+
+#if CONFIG_TRACE_COMPACT
+		if (length >= sizeof(struct log_entry_header)) {
+			length = dtrace_compact(next, record, length,
+						compact);
+			out = (const char *)compact;
 		}
+#endif
 
-		buffer->avail += length;
-		trace_data->messages++;
-	} else {
-		/* if there is not enough memory for new log, we drop it */
-		dropped_entries++;
+		if (dtrace_calc_buf_overflow(&d->dmatb, length))
+			return;
+
+		atomic_set(&next->r_pos, r + DTRACE_RING_HDR_SIZE +
+			   ALIGN(next_length, sizeof(uint32_t)));
+
+#if CONFIG_TRACE_COMPACT
+		if (out == (const char *)compact) {
+			next->timestamp = next_timestamp;
+			next->records++;
+		}
+#endif
+
+		dtrace_add_event(out, length);
 	}
 }
 
+static void dtrace_report_dropped(struct dma_trace_data *d)
+{
+	uint32_t dropped;
+	int i;
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		dropped = atomic_read(&d->rings[i].dropped);
+		if (!dropped)
+			continue;
+
+		/* keep entries dropped meanwhile for next report */
+		atomic_sub(&d->rings[i].dropped, dropped);
+		trace_error(0, "trace_work() error: core %u "
+			    "number of dropped logs = %u", i, dropped);
+	}
+}
+
+/* fill level of the fullest ring */
+static uint32_t dtrace_rings_max_avail(struct dma_trace_data *d)
+{
+	uint32_t avail;
+	uint32_t max = 0;
+	int i;
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		avail = atomic_read(&d->rings[i].w_pos) -
+			atomic_read(&d->rings[i].r_pos);
+		if (avail > max)
+			max = avail;
+	}
+
+	return max;
+}
+
+static struct dma_trace_ring *dtrace_get_ring(uint32_t length)
+{
+	struct dma_trace_ring *ring;
+
+	if (!trace_data || length > DMA_TRACE_RECORD_MAX || length == 0)
+		return NULL;
+
+	ring = &trace_data->rings[cpu_get_id()];
+
+	return ring->addr ? ring : NULL;
+}
+
 void dtrace_event(const char *e, uint32_t length)
 {
-	struct dma_trace_buf *buffer = NULL;
-	unsigned long flags;
+	struct dma_trace_ring *ring = dtrace_get_ring(length);
 
-	if (!trace_data || !trace_data->dmatb.addr ||
-	    length > DMA_TRACE_LOCAL_SIZE / 8 || length == 0)
+	if (!ring)
 		return;
 
-	buffer = &trace_data->dmatb;
-
-	spin_lock_irq(&trace_data->lock, flags);
-	dtrace_add_event(e, length);
+	dtrace_ring_write(ring, e, length);
 
 	/* if DMA trace copying is working or slave core
-	 * don't check if local buffer is half full
+	 * don't check if rings are half full
 	 */
 	if (trace_data->copy_in_progress ||
-	    cpu_get_id() != PLATFORM_MASTER_CORE_ID) {
-		spin_unlock_irq(&trace_data->lock, flags);
+	    cpu_get_id() != PLATFORM_MASTER_CORE_ID)
 		return;
-	}
 
-	spin_unlock_irq(&trace_data->lock, flags);
-
-	/* schedule copy now if buffer > 50% full */
+	/* schedule copy now if any ring > 50% full */
 	if (trace_data->enabled &&
-	    buffer->avail >= (DMA_TRACE_LOCAL_SIZE / 2)) {
+	    dtrace_rings_max_avail(trace_data) >= DMA_TRACE_RING_SIZE / 2) {
 		reschedule_task(&trace_data->dmat_work,
 				DMA_TRACE_RESCHEDULE_TIME);
 		/* reschedule should not be interrupted
@@ -496,9 +718,8 @@ void dtrace_event(const char *e, uint32_t length)
 
 void dtrace_event_atomic(const char *e, uint32_t length)
 {
-	if (!trace_data || !trace_data->dmatb.addr ||
-	    length > DMA_TRACE_LOCAL_SIZE / 8 || length == 0)
-		return;
+	struct dma_trace_ring *ring = dtrace_get_ring(length);
 
-	dtrace_add_event(e, length);
+	if (ring)
+		dtrace_ring_write(ring, e, length);
 }
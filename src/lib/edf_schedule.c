@@ -38,6 +38,7 @@
 #include <sof/alloc.h>
 #include <sof/debug.h>
 #include <sof/clk.h>
+#include <sof/clk_gov.h>
 #include <sof/edf_schedule.h>
 #include <sof/ll_schedule.h>
 #include <platform/timer.h>
@@ -159,6 +160,7 @@ static inline struct task *edf_get_next(uint64_t current, struct task *ignore)
 			/* missed scheduling - will be rescheduled */
 			trace_edf_sch("edf_get_next(), "
 				   "missed scheduling - will be rescheduled");
+			task_stats_late(edf_task);
 
 			/* have we already tried to reschedule ? */
 			if (!reschedule) {
@@ -312,6 +314,8 @@ static void schedule_edf_task(struct task *task, uint64_t start,
 	/* calculate deadline - TODO: include MIPS */
 	edf_pdata->deadline = task->start + ticks_per_ms * deadline / 1000;
 
+	task_stats_due(task, task->start, ticks_per_ms);
+
 	/* add task to the proper list */
 	if (flags & SOF_SCHEDULE_FLAG_IDLE) {
 		list_item_append(&task->list, &sch->idle_list);
@@ -348,6 +352,9 @@ static void schedule_edf_task_complete(struct task *task)
 	 */
 	switch (task->state) {
 	case SOF_TASK_STATE_RUNNING:
+		task_stats_complete(task, platform_timer_get(platform_timer),
+				    ((struct edf_task_pdata *)
+				     edf_sch_get_pdata(task))->deadline);
 		task->state = SOF_TASK_STATE_COMPLETED;
 		break;
 	case SOF_TASK_STATE_QUEUED:
@@ -375,6 +382,7 @@ static void schedule_edf_task_running(struct task *task)
 
 	spin_lock_irq(&sch->lock, flags);
 	task->state = SOF_TASK_STATE_RUNNING;
+	task_stats_running(task, platform_timer_get(platform_timer));
 	spin_unlock_irq(&sch->lock, flags);
 }
 
@@ -382,7 +390,9 @@ static void edf_scheduler_run(void *unused)
 {
 	tracev_edf_sch("edf_scheduler_run()");
 
+	clk_gov_busy_enter();
 	sch_edf();
+	clk_gov_busy_exit();
 }
 
 /* run the scheduler */
@@ -34,6 +34,7 @@
 #include <sof/timer.h>
 #include <sof/list.h>
 #include <sof/clk.h>
+#include <sof/clk_gov.h>
 #include <sof/alloc.h>
 #include <sof/sof.h>
 #include <sof/lock.h>
@@ -213,13 +214,20 @@ static void run_ll(struct ll_schedule_data *queue, uint32_t *flags)
 
 		/* run work if its pending and remove from the queue */
 		if (ll_task->state == SOF_TASK_STATE_PENDING) {
+			task_stats_due(ll_task, ll_task->start,
+				       queue->ticks_per_msec);
+
 			/* work can run in non atomic context */
 			spin_unlock_irq(&queue->lock, *flags);
+			task_stats_running(ll_task, ll_get_timer(queue));
 			reschedule_usecs = ll_task->func(ll_task->data);
 			spin_lock_irq(&queue->lock, *flags);
 
 			/* do we need reschedule this work ? */
 			if (reschedule_usecs == 0) {
+				task_stats_complete(ll_task,
+						    ll_get_timer(queue), 0);
+
 				list_item_del(&ll_task->list);
 				atomic_sub(&ll_shared_ctx->total_num_work, 1);
 
@@ -230,6 +238,11 @@ static void run_ll(struct ll_schedule_data *queue, uint32_t *flags)
 				/* get next work timeout */
 				ll_next_timeout(queue, ll_task,
 						reschedule_usecs);
+
+				/* next run is the deadline of this one */
+				task_stats_complete(ll_task,
+						    ll_get_timer(queue),
+						    ll_task->start);
 			}
 		}
 	}
@@ -322,6 +335,8 @@ static void queue_run(void *data)
 	struct ll_schedule_data *queue = (struct ll_schedule_data *)data;
 	uint32_t flags;
 
+	clk_gov_busy_enter();
+
 	timer_disable(&queue->ts->timer);
 
 	spin_lock_irq(&queue->lock, flags);
@@ -335,6 +350,8 @@ static void queue_run(void *data)
 	queue_reschedule(queue);
 
 	spin_unlock_irq(&queue->lock, flags);
+
+	clk_gov_busy_exit();
 }
 
 /* notification of CPU frequency changes - atomic PRE and POST sequence */
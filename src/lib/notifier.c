@@ -29,22 +29,40 @@
  */
 
 #include <sof/notifier.h>
+#include <errno.h>
 #include <sof/sof.h>
 #include <sof/list.h>
 #include <sof/alloc.h>
 #include <sof/cpu.h>
 #include <sof/idc.h>
 #include <platform/idc.h>
+#include <sof/trace.h>
 
-static struct notify_data _notify_data;
+#define trace_notifier_error(__e, ...) \
+	trace_error(TRACE_CLASS_NOTIFIER, __e, ##__VA_ARGS__)
 
-void notifier_register(struct notifier *notifier)
+STATIC_ASSERT(sizeof(struct notify_payload) <= IDC_MAX_PAYLOAD_SIZE,
+	      notify_payload_too_big);
+
+/* ids with registered notifiers, one mask per core, shared by all cores */
+static uint32_t *notify_ids;
+
+int notifier_register(struct notifier *notifier)
 {
 	struct notify *notify = *arch_notify_get();
 
+	if (notifier->id >= NOTIFIER_ID_COUNT) {
+		trace_notifier_error("notifier_register() error: "
+				     "invalid id %u", notifier->id);
+		return -EINVAL;
+	}
+
 	spin_lock(&notify->lock);
-	list_item_prepend(&notifier->list, &notify->list);
+	list_item_prepend(&notifier->list, &notify->list[notifier->id]);
+	notify_ids[cpu_get_id()] |= BIT(notifier->id);
 	spin_unlock(&notify->lock);
+
+	return 0;
 }
 
 void notifier_unregister(struct notifier *notifier)
@@ -53,73 +71,137 @@ void notifier_unregister(struct notifier *notifier)
 
 	spin_lock(&notify->lock);
 	list_item_del(&notifier->list);
+	if (list_is_empty(&notify->list[notifier->id]))
+		notify_ids[cpu_get_id()] &= ~BIT(notifier->id);
 	spin_unlock(&notify->lock);
 }
 
-void notifier_notify(void)
+/* send event to notifiers registered on this core for the id */
+static void notifier_notify(enum notify_id id, uint32_t message, void *data)
 {
 	struct notify *notify = *arch_notify_get();
 	struct list_item *wlist;
 	struct notifier *n;
 
-	if (!list_is_empty(&notify->list)) {
-		dcache_invalidate_region(&_notify_data, sizeof(_notify_data));
-		dcache_invalidate_region(_notify_data.data,
-					 _notify_data.data_size);
-
-		/* iterate through notifiers and send event to
-		 * interested clients
-		 */
-		list_for_item(wlist, &notify->list) {
-			n = container_of(wlist, struct notifier, list);
-			if (n->id == _notify_data.id)
-				n->cb(_notify_data.message, n->cb_data,
-				      _notify_data.data);
-		}
+	list_for_item(wlist, &notify->list[id]) {
+		n = container_of(wlist, struct notifier, list);
+		n->cb(message, n->cb_data, data);
 	}
 }
 
-void notifier_event(struct notify_data *notify_data)
+int notifier_notify_remote(void *payload)
 {
-	struct notify *notify = *arch_notify_get();
-	struct idc_msg notify_msg = { IDC_MSG_NOTIFY, IDC_MSG_NOTIFY_EXT };
-	int i = 0;
+	struct notify_payload *event = payload;
 
-	spin_lock(&notify->lock);
+	if (event->id >= NOTIFIER_ID_COUNT)
+		return -EINVAL;
+
+	notifier_notify(event->id, event->message, event->data);
+	return 0;
+}
+
+int notifier_event(struct notify_data *notify_data)
+{
+	struct notify_payload event;
+	struct idc_msg notify_msg[PLATFORM_CORE_COUNT];
+	uint32_t targets = 0;
+	int core = cpu_get_id();
+	int ret = 0;
+	int err;
+	int i;
+
+	/* other selected targets with notifiers for the id */
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++)
+		if (i != core && (notify_data->target_core_mask & BIT(i)) &&
+		    (notify_ids[i] & BIT(notify_data->id)) &&
+		    cpu_is_core_enabled(i))
+			targets |= BIT(i);
+
+	/* other cores get their own copy of the event */
+	if (targets && notify_data->data_size > NOTIFIER_DATA_SIZE_MAX) {
+		trace_notifier_error("notifier_event() error: id %u data "
+				     "size %u", notify_data->id,
+				     notify_data->data_size);
+		return -EINVAL;
+	}
 
-	_notify_data = *notify_data;
-	dcache_writeback_region(_notify_data.data, _notify_data.data_size);
-	dcache_writeback_region(&_notify_data, sizeof(_notify_data));
+	event.id = notify_data->id;
+	event.message = notify_data->message;
+	event.data_size = notify_data->data_size;
+	if (targets)
+		memcpy(event.data, notify_data->data, event.data_size);
 
-	/* notify selected targets */
+	/* queue the event to all targets first, so they run it in parallel */
 	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
-		if (_notify_data.target_core_mask & (1 << i)) {
-			if (i == cpu_get_id()) {
-				notifier_notify();
-			} else if (cpu_is_core_enabled(i)) {
-				notify_msg.core = i;
-				idc_send_msg(&notify_msg, IDC_BLOCKING);
-			}
+		if (!(targets & BIT(i)))
+			continue;
+
+		notify_msg[i].header = IDC_MSG_NOTIFY;
+		notify_msg[i].extension = IDC_MSG_NOTIFY_EXT;
+		notify_msg[i].core = i;
+		notify_msg[i].payload = &event;
+		notify_msg[i].payload_size = sizeof(event) -
+			NOTIFIER_DATA_SIZE_MAX + event.data_size;
+
+		err = idc_send_msg(&notify_msg[i], IDC_NON_BLOCKING);
+		if (err < 0) {
+			trace_notifier_error("notifier_event() error: id %u "
+					     "core %d send %d",
+					     notify_data->id, i, err);
+			targets &= ~BIT(i);
+			ret = err;
 		}
 	}
 
-	spin_unlock(&notify->lock);
+	if (notify_data->target_core_mask & BIT(core))
+		notifier_notify(notify_data->id, notify_data->message,
+				notify_data->data);
+
+	/* synchronous events are complete once all targets ran them */
+	if (!(notify_data->flags & NOTIFIER_FLAG_SYNC))
+		return ret;
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		if (!(targets & BIT(i)))
+			continue;
+
+		err = idc_wait_msg(&notify_msg[i]);
+		if (err < 0) {
+			trace_notifier_error("notifier_event() error: id %u "
+					     "core %d wait %d",
+					     notify_data->id, i, err);
+			ret = err;
+		}
+	}
+
+	return ret;
 }
 
 void init_system_notify(struct sof *sof)
 {
 	struct notify **notify = arch_notify_get();
+	int i;
+
 	*notify = rzalloc(RZONE_SYS, SOF_MEM_CAPS_RAM, sizeof(**notify));
 
-	list_init(&(*notify)->list);
+	for (i = 0; i < NOTIFIER_ID_COUNT; i++)
+		list_init(&(*notify)->list[i]);
 	spinlock_init(&(*notify)->lock);
+
+	if (cpu_get_id() == PLATFORM_MASTER_CORE_ID)
+		notify_ids = rzalloc(RZONE_SYS | RZONE_FLAG_UNCACHED,
+				     SOF_MEM_CAPS_RAM,
+				     sizeof(*notify_ids) * PLATFORM_CORE_COUNT);
 }
 
 void free_system_notify(void)
 {
 	struct notify *notify = *arch_notify_get();
+	int i;
 
 	spin_lock(&notify->lock);
-	list_item_del(&notify->list);
+	for (i = 0; i < NOTIFIER_ID_COUNT; i++)
+		list_item_del(&notify->list[i]);
+	notify_ids[cpu_get_id()] = 0;
 	spin_unlock(&notify->lock);
 }
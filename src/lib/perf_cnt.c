@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sof/perf_cnt.h>
+#include <sof/audio/component.h>
+#include <sof/audio/pipeline.h>
+#include <sof/ipc.h>
+#include <sof/trace.h>
+#include <uapi/ipc/trace.h>
+#include <errno.h>
+
+/* trace each window as it closes */
+static bool perf_cnt_trace_on;
+
+void perf_cnt_comp_update(struct comp_dev *dev, uint32_t cycles)
+{
+	struct perf_cnt_data *pc = &dev->perf;
+
+	if (!perf_cnt_update(pc, cycles) || !perf_cnt_trace_on)
+		return;
+
+	trace_event_with_ids(TRACE_CLASS_COMP, dev->comp.pipeline_id,
+			     dev->comp.id, "perf copy min %u avg %u max %u",
+			     pc->last_min, pc->last_avg, pc->last_max);
+}
+
+void perf_cnt_pipe_update(struct pipeline *p, uint32_t cycles)
+{
+	struct perf_cnt_data *pc = &p->perf;
+
+	/* CPU clock may change at runtime, so does the budget */
+	p->perf_budget = perf_cnt_cycles_per_ms(p->ipc_pipe.core) *
+		p->ipc_pipe.period / 1000;
+	if (cycles > p->perf_budget)
+		p->perf_overruns++;
+
+	if (!perf_cnt_update(pc, cycles) || !perf_cnt_trace_on)
+		return;
+
+	trace_pipe_with_ids(p,
+			    "perf period avg %u max %u budget %u overruns %u",
+			    pc->last_avg, pc->last_max, p->perf_budget,
+			    p->perf_overruns);
+}
+
+/*
+ * Counters of components on other cores are read as they are, the values
+ * are for debug and a window may be torn.
+ */
+int perf_cnt_get(struct ipc *ipc, struct sof_ipc_perf_get *req,
+		 struct sof_ipc_perf_data *data, uint32_t size)
+{
+	struct sof_ipc_perf_elem *elem;
+	struct perf_cnt_data *pc;
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
+	uint32_t max_cnt;
+	uint32_t index = 0;
+
+	if (size < sizeof(*data))
+		return -EINVAL;
+
+	if (req->flags & SOF_IPC_PERF_FLAG_TRACE_ON)
+		perf_cnt_trace_on = true;
+	if (req->flags & SOF_IPC_PERF_FLAG_TRACE_OFF)
+		perf_cnt_trace_on = false;
+
+	max_cnt = (size - sizeof(*data)) / sizeof(*elem);
+	data->elem_cnt = 0;
+
+	list_for_item(clist, &ipc->shared_ctx->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+
+		switch (icd->type) {
+		case COMP_TYPE_COMPONENT:
+			pc = &icd->cd->perf;
+			break;
+		case COMP_TYPE_PIPELINE:
+			pc = &icd->pipeline->perf;
+			if (req->flags & SOF_IPC_PERF_FLAG_RESET)
+				icd->pipeline->perf_overruns = 0;
+			break;
+		default:
+			continue;
+		}
+
+		if (req->flags & SOF_IPC_PERF_FLAG_RESET)
+			bzero(pc, sizeof(*pc));
+
+		if (index++ < req->first_elem || data->elem_cnt == max_cnt)
+			continue;
+
+		elem = &data->elems[data->elem_cnt++];
+		bzero(elem, sizeof(*elem));
+
+		if (icd->type == COMP_TYPE_PIPELINE) {
+			elem->type = SOF_IPC_PERF_ELEM_PIPE;
+			elem->core = icd->pipeline->ipc_pipe.core;
+			elem->id = icd->pipeline->ipc_pipe.comp_id;
+			elem->pipeline_id =
+				icd->pipeline->ipc_pipe.pipeline_id;
+			elem->budget = icd->pipeline->perf_budget;
+			elem->overruns = icd->pipeline->perf_overruns;
+		} else {
+			elem->type = SOF_IPC_PERF_ELEM_COMP;
+			elem->core = icd->cd->pipeline ?
+				icd->cd->pipeline->ipc_pipe.core : 0;
+			elem->id = icd->cd->comp.id;
+			elem->pipeline_id = icd->cd->comp.pipeline_id;
+		}
+
+		elem->min = pc->last_min;
+		elem->avg = pc->last_avg;
+		elem->max = pc->last_max;
+		elem->windows = pc->windows;
+	}
+
+	data->rhdr.hdr.cmd = SOF_IPC_GLB_REPLY;
+	data->rhdr.hdr.size = sizeof(*data) + data->elem_cnt * sizeof(*elem);
+	data->rhdr.error = 0;
+	data->elem_total = index;
+	data->window = CONFIG_PERFORMANCE_COUNTERS_WINDOW;
+	data->reserved = 0;
+
+	return 0;
+}
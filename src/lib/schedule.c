@@ -32,12 +32,135 @@
 #include <sof/schedule.h>
 #include <sof/edf_schedule.h>
 #include <sof/ll_schedule.h>
+#include <sof/alloc.h>
+#include <sof/cpu.h>
+#include <sof/lock.h>
+#include <platform/platform.h>
 
 static const struct scheduler_ops *schedulers[SOF_SCHEDULE_COUNT] = {
 	&schedule_edf_ops,              /* SOF_SCHEDULE_EDF */
 	&schedule_ll_ops		/* SOF_SCHEDULE_LL */
 };
 
+#if CONFIG_SCHEDULE_HISTOGRAMS
+/* stats of all initialised tasks */
+static struct list_item task_stats_list;
+static spinlock_t task_stats_lock;
+
+static void task_stats_init(struct task *task)
+{
+	struct task_stats *stats;
+	uint32_t flags;
+
+	if (task->stats)
+		return;
+
+	/* uncached, the task may run on another core than the reader */
+	stats = rzalloc(RZONE_SYS_RUNTIME | RZONE_FLAG_UNCACHED,
+			SOF_MEM_CAPS_RAM, sizeof(*stats));
+	if (!stats) {
+		trace_schedule_error("task_stats_init() error: alloc failed");
+		return;
+	}
+
+	stats->type = task->type;
+	stats->core = task->core;
+	stats->priority = task->priority;
+	stats->func = task->func;
+	stats->data = task->data;
+
+	spin_lock_irq(&task_stats_lock, flags);
+	list_item_append(&stats->list, &task_stats_list);
+	spin_unlock_irq(&task_stats_lock, flags);
+
+	task->stats = stats;
+}
+
+static void task_stats_free(struct task *task)
+{
+	uint32_t flags;
+
+	if (!task->stats)
+		return;
+
+	spin_lock_irq(&task_stats_lock, flags);
+	list_item_del(&task->stats->list);
+	spin_unlock_irq(&task_stats_lock, flags);
+
+	rfree(task->stats);
+	task->stats = NULL;
+}
+
+static void sched_hist_get(struct sof_ipc_sched_hist *elem,
+			   const struct sched_hist *hist)
+{
+	int i;
+
+	for (i = 0; i < SCHED_HIST_BUCKETS; i++)
+		elem->count[i] = hist->count[i];
+	elem->max = hist->max;
+}
+
+int schedule_stats_get(struct sof_ipc_sched_get *req,
+		       struct sof_ipc_sched_data *data, uint32_t size)
+{
+	struct sof_ipc_sched_elem *elem;
+	struct task_stats *stats;
+	struct list_item *slist;
+	uint32_t max_cnt;
+	uint32_t index = 0;
+	uint32_t flags;
+
+	if (size < sizeof(*data))
+		return -EINVAL;
+
+	max_cnt = (size - sizeof(*data)) / sizeof(*elem);
+	data->elem_cnt = 0;
+
+	spin_lock_irq(&task_stats_lock, flags);
+
+	list_for_item(slist, &task_stats_list) {
+		stats = container_of(slist, struct task_stats, list);
+
+		if (req->flags & SOF_IPC_SCHED_FLAG_RESET) {
+			stats->runs = 0;
+			stats->misses = 0;
+			bzero(&stats->latency, sizeof(stats->latency));
+			bzero(&stats->exec, sizeof(stats->exec));
+			bzero(&stats->slack, sizeof(stats->slack));
+		}
+
+		if (index++ < req->first_elem || data->elem_cnt == max_cnt)
+			continue;
+
+		elem = &data->elems[data->elem_cnt++];
+		elem->type = stats->type;
+		elem->core = stats->core;
+		elem->priority = stats->priority;
+		elem->reserved = 0;
+		elem->func = (uintptr_t)stats->func;
+		elem->data = (uintptr_t)stats->data;
+		elem->ticks_per_msec = stats->ticks_per_msec;
+		elem->runs = stats->runs;
+		elem->misses = stats->misses;
+		sched_hist_get(&elem->latency, &stats->latency);
+		sched_hist_get(&elem->exec, &stats->exec);
+		sched_hist_get(&elem->slack, &stats->slack);
+	}
+
+	spin_unlock_irq(&task_stats_lock, flags);
+
+	data->rhdr.hdr.cmd = SOF_IPC_GLB_REPLY;
+	data->rhdr.hdr.size = sizeof(*data) + data->elem_cnt * sizeof(*elem);
+	data->rhdr.error = 0;
+	data->elem_total = index;
+	data->bucket_shift = SCHED_HIST_SHIFT;
+	data->reserved = 0;
+
+	return 0;
+}
+#endif
+
 int schedule_task_init(struct task *task, uint16_t type, uint16_t priority,
 		       uint64_t (*func)(void *data), void *data, uint16_t core,
 		       uint32_t xflags)
@@ -61,12 +184,28 @@ int schedule_task_init(struct task *task, uint16_t type, uint16_t priority,
 
 	if (task->ops->schedule_task_init)
 		ret = task->ops->schedule_task_init(task, xflags);
+
+#if CONFIG_SCHEDULE_HISTOGRAMS
+	/* only tasks freed with schedule_task_free() may own stats */
+	if (!(xflags & SOF_SCHEDULE_FLAG_STATS))
+		task->stats = NULL;
+	else if (!ret)
+		task_stats_init(task);
+#endif
 out:
 	return ret;
 }
 
 void schedule_task_free(struct task *task)
 {
+	/* task was never initialised */
+	if (!task->ops)
+		return;
+
+#if CONFIG_SCHEDULE_HISTOGRAMS
+	task_stats_free(task);
+#endif
+
 	if (task->ops->schedule_task_free)
 		task->ops->schedule_task_free(task);
 }
@@ -112,6 +251,13 @@ int scheduler_init(void)
 	/* init scheduler_data */
 	*sch = rzalloc(RZONE_SYS, SOF_MEM_CAPS_RAM, sizeof(**sch));
 
+#if CONFIG_SCHEDULE_HISTOGRAMS
+	if (cpu_get_id() == PLATFORM_MASTER_CORE_ID) {
+		list_init(&task_stats_list);
+		spinlock_init(&task_stats_lock);
+	}
+#endif
+
 	for (i = 0; i < SOF_SCHEDULE_COUNT; i++) {
 		if (schedulers[i]->scheduler_init) {
 			ret = schedulers[i]->scheduler_init();
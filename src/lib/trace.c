@@ -39,6 +39,7 @@
 #include <sof/cpu.h>
 #include <sof/preproc.h>
 #include <sof/drivers/timer.h>
+#include <uapi/ipc/trace.h>
 #include <stdint.h>
 
 struct trace {
@@ -49,6 +50,9 @@ struct trace {
 
 static struct trace *trace;
 
+/* runtime filter, shared by all cores */
+struct trace_filter *trace_filter;
+
 /* calculates total message size, both header and payload in bytes */
 #define MESSAGE_SIZE(args_num)	\
 	(sizeof(struct log_entry_header) + args_num * sizeof(uint32_t))
@@ -239,7 +243,128 @@ void trace_init(struct sof *sof)
 	trace->pos = 0;
 	spinlock_init(&trace->lock);
 
+	trace_filter = rzalloc(RZONE_SYS | RZONE_FLAG_UNCACHED,
+			       SOF_MEM_CAPS_RAM, sizeof(*trace_filter));
+	if (trace_filter)
+		memset(trace_filter->class_level, LOG_LEVEL_VERBOSE,
+		       sizeof(trace_filter->class_level));
+
 	bzero((void *)MAILBOX_TRACE_BASE, MAILBOX_TRACE_SIZE);
 	dcache_writeback_invalidate_region((void *)MAILBOX_TRACE_BASE,
 					   MAILBOX_TRACE_SIZE);
 }
+
+/* slow path of trace_filter_check(), first matching override wins */
+int trace_filter_comp_check(uint32_t level, uint32_t comp_class,
+			    uint32_t id_0, uint32_t id_1)
+{
+	struct trace_filter_comp *comp;
+	uint32_t idx = comp_class >> 24;
+	int i;
+
+	for (i = 0; i < trace_filter->comp_count; i++) {
+		comp = &trace_filter->comp[i];
+
+		if (comp->comp_class && comp->comp_class != comp_class)
+			continue;
+		if (comp->id_0 >= 0 && comp->id_0 != (id_0 & TRACE_ID_MASK))
+			continue;
+		if (comp->id_1 >= 0 && comp->id_1 != (id_1 & TRACE_ID_MASK))
+			continue;
+
+		return level <= comp->level;
+	}
+
+	return idx >= TRACE_FILTER_CLASS_COUNT ||
+	       level <= trace_filter->class_level[idx];
+}
+
+static int trace_filter_apply(const struct trace_filter_comp *filter)
+{
+	uint32_t idx = filter->comp_class >> 24;
+	struct trace_filter_comp *comp;
+	int i;
+
+	/* level only, reset whole table */
+	if (!filter->comp_class && filter->id_0 < 0 && filter->id_1 < 0) {
+		trace_filter->comp_count = 0;
+		memset(trace_filter->class_level, filter->level,
+		       sizeof(trace_filter->class_level));
+		return 0;
+	}
+
+	/* class only */
+	if (filter->id_0 < 0 && filter->id_1 < 0) {
+		if (idx >= TRACE_FILTER_CLASS_COUNT)
+			return -EINVAL;
+		trace_filter->class_level[idx] = filter->level;
+		return 0;
+	}
+
+	/* replace existing override or add a new one */
+	for (i = 0; i < trace_filter->comp_count; i++) {
+		comp = &trace_filter->comp[i];
+		if (comp->comp_class == filter->comp_class &&
+		    comp->id_0 == filter->id_0 && comp->id_1 == filter->id_1) {
+			comp->level = filter->level;
+			return 0;
+		}
+	}
+
+	if (trace_filter->comp_count == TRACE_FILTER_COMP_COUNT)
+		return -ENOMEM;
+
+	trace_filter->comp[trace_filter->comp_count] = *filter;
+	trace_filter->comp_count++;
+
+	return 0;
+}
+
+int trace_filter_update(const struct sof_ipc_trace_filter *msg)
+{
+	const struct sof_ipc_trace_filter_elem *elem;
+	struct trace_filter_comp filter;
+	int ret = 0;
+	int i;
+
+	if (!trace_filter)
+		return -ENOMEM;
+
+	filter.comp_class = 0;
+	filter.id_0 = -1;
+	filter.id_1 = -1;
+	filter.level = LOG_LEVEL_VERBOSE;
+
+	for (i = 0; i < msg->elem_cnt && !ret; i++) {
+		elem = &msg->elems[i];
+
+		switch (elem->key & SOF_IPC_TRACE_FILTER_ELEM_TYPE_MASK) {
+		case SOF_IPC_TRACE_FILTER_ELEM_SET_LEVEL:
+			filter.level = elem->value;
+			break;
+		case SOF_IPC_TRACE_FILTER_ELEM_BY_CLASS:
+			filter.comp_class = elem->value;
+			break;
+		case SOF_IPC_TRACE_FILTER_ELEM_BY_PIPE:
+			filter.id_0 = elem->value;
+			break;
+		case SOF_IPC_TRACE_FILTER_ELEM_BY_COMP:
+			filter.id_1 = elem->value;
+			break;
+		default:
+			return -EINVAL;
+		}
+
+		if (!(elem->key & SOF_IPC_TRACE_FILTER_ELEM_FIN))
+			continue;
+
+		ret = trace_filter_apply(&filter);
+
+		filter.comp_class = 0;
+		filter.id_0 = -1;
+		filter.id_1 = -1;
+		filter.level = LOG_LEVEL_VERBOSE;
+	}
+
+	return ret;
+}
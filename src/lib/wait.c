@@ -35,6 +35,7 @@
 #include <arch/wait.h>
 #include <sof/io.h>
 #include <sof/debug.h>
+#include <sof/alloc.h>
 #include <sof/wait.h>
 #include <sof/schedule.h>
 #include <sof/timer.h>
@@ -49,10 +50,29 @@
 
 #define DEFAULT_TRY_TIMES 8
 
-/* simple interrupt based wait for completion with timeout */
+static uint64_t _wait_cb(void *data)
+{
+	completion_t *wc = data;
+
+	/* read back through a volatile pointer by the waiter */
+	wc->timeout = 1;
+	return 0;
+}
+
+/*
+ * Simple interrupt based wait for completion with timeout. The timeout
+ * task only exists for the duration of the wait, polled completions do
+ * not need one.
+ */
 int wait_for_completion_timeout(completion_t *comp)
 {
 	volatile completion_t *c = (volatile completion_t *)comp;
+	int ret = 0;
+
+	/* completions often live on the stack */
+	bzero(&comp->work, sizeof(comp->work));
+	schedule_task_init(&comp->work, SOF_SCHEDULE_LL, SOF_TASK_PRI_MED,
+			   _wait_cb, comp, 0, 0);
 
 	schedule_task(&comp->work, comp->timeout, 0, 0);
 	comp->timeout = 0;
@@ -63,17 +83,18 @@ int wait_for_completion_timeout(completion_t *comp)
 
 	/* did we complete */
 	if (c->complete) {
-		/* no timeout so cancel work and return 0 */
+		/* no timeout so cancel work */
 		schedule_task_cancel(&comp->work);
-
-		return 0;
+	} else {
+		/* timeout */
+		trace_error_value(c->timeout);
+		trace_error_value(c->complete);
+		ret = -ETIME;
 	}
 
-	/* timeout */
-	trace_error_value(c->timeout);
-	trace_error_value(c->complete);
+	schedule_task_free(&comp->work);
 
-	return -ETIME;
+	return ret;
 }
 
 int poll_for_completion_delay(completion_t *comp, uint64_t us)
@@ -31,12 +31,27 @@
 #ifndef __INCLUDE_LIB_PLATFORM_HOST_CLOCK__
 #define __INCLUDE_LIB_PLATFORM_HOST_CLOCK__
 
+#include <stdint.h>
+
 #define CLK_CPU(x)	x
 #define CLK_I2S		1
 
+#define CPU_DEFAULT_IDX		1
+#define I2S_DEFAULT_IDX		0
+
 #define CLK_DEFAULT_CPU_HZ	50000000
 #define CLK_MAX_CPU_HZ		343000000
 
 #define NUM_CLOCKS	2
 
+static inline int clock_platform_set_cpu_freq(uint32_t cpu_freq_enc)
+{
+	return 0;
+}
+
+static inline int clock_platform_set_i2s_freq(uint32_t i2s_freq_enc)
+{
+	return 0;
+}
+
 #endif
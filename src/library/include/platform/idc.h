@@ -36,6 +36,11 @@ static inline int idc_send_msg(struct idc_msg *msg, uint32_t mode)
 	return 0;
 }
 
+static inline int idc_wait_msg(struct idc_msg *msg)
+{
+	return 0;
+}
+
 static inline void idc_process_msg_queue(void)
 {
 }
@@ -33,6 +33,13 @@
 
 #include <config.h>
 
+#if CONFIG_HOST_MEMORY_MODEL
+
+/* heap map of the platform selected for the host allocator model */
+#include CONFIG_HOST_MEMORY_PLATFORM_H
+
+#else
+
 #if CONFIG_HT_BAYTRAIL
 #include <baytrail/include/platform/memory.h>
 #endif
@@ -40,6 +47,9 @@
 #define HEAP_BUFFER_SIZE	(1024 * 128)
 #define SOF_STACK_SIZE		0x1000
 
+#endif
+
+/* host mailbox layout, independent of the heap map */
 #define MAILBOX_DSPBOX_BASE	0
 #define MAILBOX_DSPBOX_SIZE	0x400
 #define MAILBOX_HOSTBOX_BASE	0
@@ -32,10 +32,28 @@
 #ifndef __INCLUDE_LIB_PLATFORM_PLATFORM_H__
 #define __INCLUDE_LIB_PLATFORM_PLATFORM_H__
 
+#include <platform/memory.h>
 #include <platform/shim.h>
 #include <platform/interrupt.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
+
+/* the allocator model memory map may already define it */
+#ifndef PLATFORM_CORE_COUNT
+#define PLATFORM_CORE_COUNT	1
+#endif
+
+#define PLATFORM_MASTER_CORE_ID	0
+
+/* pipeline IRQ */
+#define PLATFORM_SCHEDULE_IRQ	IRQ_NUM_SOFTWARE5
+
+#define PLATFORM_IRQ_TASK_HIGH	IRQ_NUM_SOFTWARE4
+#define PLATFORM_IRQ_TASK_MED	IRQ_NUM_SOFTWARE3
+#define PLATFORM_IRQ_TASK_LOW	IRQ_NUM_SOFTWARE2
+
+#define PLATFORM_SCHEDULE_COST	200
 
 /*! \def PLATFORM_DEFAULT_CLOCK
  *  \brief clock source for audio pipeline
@@ -46,6 +64,14 @@
  */
 #define PLATFORM_DEFAULT_CLOCK CLK_CPU(0)
 
+/* clock source for the scheduler */
+#define PLATFORM_SCHED_CLOCK	PLATFORM_DEFAULT_CLOCK
+
+/*! \def PLATFORM_WORKQ_WINDOW
+ *  \brief work queue window in microseconds
+ */
+#define PLATFORM_WORKQ_WINDOW	2000
+
 /*! \def PLATFORM_WORKQ_DEFAULT_TIMEOUT
  *  \brief work queue default timeout in microseconds
  */
@@ -71,4 +97,9 @@ static inline void platform_panic(uint32_t p) {}
 
 extern struct timer *platform_timer;
 
+/* newlib provides the GNU name used by the schedulers */
+#ifndef ULONG_LONG_MAX
+#define ULONG_LONG_MAX	ULLONG_MAX
+#endif
+
 #endif
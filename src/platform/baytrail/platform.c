@@ -77,6 +77,7 @@ static const struct sof_ipc_fw_ready ready
 #endif
 		.tag = SOF_TAG,
 		.abi_version = SOF_ABI_VERSION,
+		.trace_format = TRACE_FORMAT,
 	},
 	.debug = DEBUG_SET_FW_READY_FLAGS
 };
@@ -38,6 +38,11 @@ static inline int idc_send_msg(struct idc_msg *msg, uint32_t mode)
 	return arch_idc_send_msg(msg, mode);
 }
 
+static inline int idc_wait_msg(struct idc_msg *msg)
+{
+	return arch_idc_wait_msg(msg);
+}
+
 static inline int idc_init(void)
 {
 	return arch_idc_init();
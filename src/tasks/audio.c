@@ -37,6 +37,7 @@
 #include <sof/interrupt.h>
 #include <sof/ipc.h>
 #include <sof/agent.h>
+#include <sof/clk_gov.h>
 #include <platform/idc.h>
 #include <platform/interrupt.h>
 #include <sof/audio/pipeline.h>
@@ -82,6 +83,7 @@ int do_task_master_core(struct sof *sof)
 		/* sleep until next IPC or DMA */
 		sa_enter_idle(sof);
 		wait_for_interrupt(0);
+		sa_exit_idle(sof);
 
 		/* now process any IPC messages to host */
 		ipc_process_msg_queue();
@@ -98,8 +100,10 @@ int do_task_slave_core(struct sof *sof)
 {
 	/* main audio IDC processing loop */
 	while (1) {
-		/* sleep until next IDC */
+		/* sleep until next IDC, no system agent on this core */
+		clk_gov_idle_enter();
 		wait_for_interrupt(0);
+		clk_gov_idle_exit();
 
 		/* schedule any idle tasks */
 		schedule();
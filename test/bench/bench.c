@@ -0,0 +1,401 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include <sched.h>
+#include <sof/list.h>
+#include <sof/lock.h>
+#include "bench.h"
+
+/* defaults cover a short LL period up to a long DMA period */
+#define BENCH_DEF_REPS		15
+#define BENCH_DEF_REP_US	1000
+
+#define BENCH_MAX_REPS		101
+
+struct bench_group {
+	const char *name;
+	void (*run)(struct bench *b);
+};
+
+static const struct bench_group groups[] = {
+	{"volume", bench_volume},
+	{"mix_n", bench_mixer},
+	{"src", bench_src},
+	{"fir_32x16", bench_fir},
+	{"iir_df2t", bench_iir},
+	{"selector", bench_selector},
+	{"math", bench_math},
+	{"buffer", bench_buffer},
+};
+
+/* buffers belong to these, the copy path checks them for DMA */
+static struct comp_dev bench_source;
+static struct comp_dev bench_sink;
+
+static uint64_t bench_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t bench_time(bench_func func, void *data, uint64_t iters)
+{
+	uint64_t start;
+	uint64_t i;
+
+	start = bench_now_ns();
+	for (i = 0; i < iters; i++)
+		func(data);
+
+	return bench_now_ns() - start;
+}
+
+static int bench_cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+/* median of sorted values */
+static double bench_median(double *v, int n)
+{
+	if (n & 1)
+		return v[n / 2];
+
+	return (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+int bench_enabled(struct bench *b, const char *kernel, const char *variant)
+{
+	char name[128];
+
+	if (!b->filter)
+		return 1;
+
+	snprintf(name, sizeof(name), "%s/%s", kernel, variant);
+	return strstr(name, b->filter) != NULL;
+}
+
+void bench_run(struct bench *b, const char *kernel, const char *variant,
+	       uint32_t channels, uint32_t frames, uint32_t samples,
+	       bench_func func, void *data)
+{
+	double ns[BENCH_MAX_REPS];
+	double dev[BENCH_MAX_REPS];
+	double median;
+	double mad;
+	uint64_t iters = 1;
+	uint64_t t;
+	int i;
+
+	if (!bench_enabled(b, kernel, variant) || !samples)
+		return;
+
+	/* warm up caches and find the iterations for one repetition */
+	func(data);
+	for (;;) {
+		t = bench_time(func, data, iters);
+		if (t >= b->rep_ns / 8 || iters >= (1ULL << 30))
+			break;
+		iters *= 2;
+	}
+	if (t)
+		iters = iters * b->rep_ns / t;
+	if (!iters)
+		iters = 1;
+
+	for (i = 0; i < b->reps; i++) {
+		t = bench_time(func, data, iters);
+		ns[i] = (double)t / ((double)iters * samples);
+	}
+
+	qsort(ns, b->reps, sizeof(ns[0]), bench_cmp_double);
+	median = bench_median(ns, b->reps);
+
+	/* median absolute deviation shows how repeatable the median is */
+	for (i = 0; i < b->reps; i++)
+		dev[i] = ns[i] > median ? ns[i] - median : median - ns[i];
+	qsort(dev, b->reps, sizeof(dev[0]), bench_cmp_double);
+	mad = median > 0 ? 100 * bench_median(dev, b->reps) / median : 0;
+
+	if (b->csv)
+		fprintf(b->out, "%s,%s,%u,%u,%.4f,%.4f,%.2f\n", kernel,
+			variant, channels, frames, median, ns[0], mad);
+	else
+		fprintf(b->out, "%-10s %-28s %3u %6u %10.3f %10.3f %6.2f\n",
+			kernel, variant, channels, frames, median, ns[0], mad);
+	fflush(b->out);
+}
+
+struct comp_buffer *bench_buffer_new(uint32_t bytes)
+{
+	struct comp_buffer *buffer;
+
+	buffer = calloc(1, sizeof(*buffer));
+	if (!buffer)
+		return NULL;
+
+	buffer->addr = calloc(1, bytes);
+	if (!buffer->addr) {
+		free(buffer);
+		return NULL;
+	}
+
+	buffer->size = bytes;
+	buffer->alloc_size = bytes;
+	buffer->r_ptr = buffer->addr;
+	buffer->w_ptr = buffer->addr;
+	buffer->end_addr = buffer->addr + bytes;
+	buffer->free = bytes;
+	buffer->source = &bench_source;
+	buffer->sink = &bench_sink;
+	list_init(&buffer->source_list);
+	list_init(&buffer->sink_list);
+	spinlock_init(&buffer->lock);
+
+	return buffer;
+}
+
+void bench_buffer_free(struct comp_buffer *buffer)
+{
+	free(buffer->addr);
+	free(buffer);
+}
+
+void bench_buffer_fill(struct comp_buffer *buffer, enum sof_ipc_frame fmt)
+{
+	int16_t *x16 = buffer->addr;
+	int32_t *x32 = buffer->addr;
+	uint32_t seed = 1;
+	uint32_t i;
+
+	/* pseudo random full scale data keeps every kernel branch busy */
+	for (i = 0; i < buffer->size / bench_fmt_bytes(fmt); i++) {
+		seed = seed * 1664525 + 1013904223;
+		switch (fmt) {
+		case SOF_IPC_FRAME_S16_LE:
+			x16[i] = seed >> 16;
+			break;
+		case SOF_IPC_FRAME_S24_4LE:
+			x32[i] = (int32_t)seed >> 8;
+			break;
+		default:
+			x32[i] = seed;
+			break;
+		}
+	}
+}
+
+struct comp_dev *bench_comp_new(uint32_t channels, uint32_t frames,
+				enum sof_ipc_frame fmt, void *data)
+{
+	struct comp_dev *dev;
+
+	dev = calloc(1, sizeof(*dev));
+	if (!dev)
+		return NULL;
+
+	dev->params.channels = channels;
+	dev->params.frame_fmt = fmt;
+	dev->frames = frames;
+	dev->frame_bytes = channels * bench_fmt_bytes(fmt);
+	list_init(&dev->bsource_list);
+	list_init(&dev->bsink_list);
+	spinlock_init(&dev->lock);
+	comp_set_drvdata(dev, data);
+
+	return dev;
+}
+
+void bench_comp_free(struct comp_dev *dev)
+{
+	free(dev);
+}
+
+const char *bench_fmt_name(enum sof_ipc_frame fmt)
+{
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		return "s16";
+	case SOF_IPC_FRAME_S24_4LE:
+		return "s24";
+	case SOF_IPC_FRAME_S32_LE:
+		return "s32";
+	case SOF_IPC_FRAME_FLOAT:
+		return "float";
+	default:
+		return "unknown";
+	}
+}
+
+uint32_t bench_fmt_bytes(enum sof_ipc_frame fmt)
+{
+	return fmt == SOF_IPC_FRAME_S16_LE ? sizeof(int16_t) : sizeof(int32_t);
+}
+
+/* comma separated list of positive values */
+static int parse_sweep(const char *arg, uint32_t *values)
+{
+	char *list = strdup(arg);
+	char *token;
+	char *saveptr = NULL;
+	int n = 0;
+
+	for (token = strtok_r(list, ",", &saveptr); token;
+	     token = strtok_r(NULL, ",", &saveptr)) {
+		if (n == BENCH_MAX_SWEEP || atoi(token) <= 0) {
+			n = -1;
+			break;
+		}
+		values[n++] = atoi(token);
+	}
+
+	free(list);
+	return n;
+}
+
+static void print_usage(char *executable)
+{
+	int i;
+
+	printf("Usage: %s [-k <filter>] [-f <frames,...>] [-c <channels,...>]",
+	       executable);
+	printf(" [-r <reps>] [-t <rep_us>] [-p <cpu>] [-C]\n");
+	printf("  -k run only kernel/variant names containing filter\n");
+	printf("  -f frames sweep, default 16,48,192\n");
+	printf("  -c channels sweep, default 1,2,4,8\n");
+	printf("  -r timed repetitions, default %d\n", BENCH_DEF_REPS);
+	printf("  -t target repetition length in us, default %d\n",
+	       BENCH_DEF_REP_US);
+	printf("  -p pin to cpu for stable numbers\n");
+	printf("  -C print CSV\n");
+	printf("Kernels:");
+	for (i = 0; i < ARRAY_SIZE(groups); i++)
+		printf(" %s", groups[i].name);
+	printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+	struct bench b = {
+		.frames = {16, 48, 192},
+		.num_frames = 3,
+		.channels = {1, 2, 4, 8},
+		.num_channels = 4,
+		.reps = BENCH_DEF_REPS,
+		.rep_ns = BENCH_DEF_REP_US * 1000ULL,
+		.out = stdout,
+	};
+	cpu_set_t cpus;
+	int option;
+	int i;
+
+	while ((option = getopt(argc, argv, "hk:f:c:r:t:p:C")) != -1) {
+		switch (option) {
+		/* kernel/variant filter */
+		case 'k':
+			b.filter = optarg;
+			break;
+
+		/* frames sweep */
+		case 'f':
+			b.num_frames = parse_sweep(optarg, b.frames);
+			break;
+
+		/* channels sweep */
+		case 'c':
+			b.num_channels = parse_sweep(optarg, b.channels);
+			break;
+
+		/* timed repetitions */
+		case 'r':
+			b.reps = atoi(optarg);
+			break;
+
+		/* repetition length */
+		case 't':
+			b.rep_ns = atoi(optarg) * 1000ULL;
+			break;
+
+		/* pin to cpu */
+		case 'p':
+			CPU_ZERO(&cpus);
+			CPU_SET(atoi(optarg), &cpus);
+			if (sched_setaffinity(0, sizeof(cpus), &cpus) < 0) {
+				fprintf(stderr, "error: can't pin to cpu %s\n",
+					optarg);
+				exit(EXIT_FAILURE);
+			}
+			break;
+
+		/* CSV output */
+		case 'C':
+			b.csv = 1;
+			break;
+
+		/* print usage */
+		case 'h':
+		default:
+			print_usage(argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	/* check args */
+	if (b.num_frames <= 0 || b.num_channels <= 0 || b.reps < 1 ||
+	    b.reps > BENCH_MAX_REPS || !b.rep_ns) {
+		print_usage(argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	/* kernels trace parameter errors only, keep the output clean */
+	test_bench_trace = 0;
+
+	if (b.csv)
+		fprintf(b.out, "kernel,variant,channels,frames,"
+			"median_ns,min_ns,mad_pct\n");
+	else
+		fprintf(b.out, "%-10s %-28s %3s %6s %10s %10s %6s\n",
+			"kernel", "variant", "ch", "frames",
+			"ns/sample", "min", "mad %");
+
+	for (i = 0; i < ARRAY_SIZE(groups); i++)
+		groups[i].run(&b);
+
+	return EXIT_SUCCESS;
+}
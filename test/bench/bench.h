@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Kernel micro-benchmarks.
+ *
+ * Each processing kernel is run in isolation on pre-filled buffers over a
+ * sweep of frames, channel counts and formats. A measurement is repeated
+ * a number of times and reported as ns per sample with the median, the
+ * minimum and the median absolute deviation, which are not disturbed by the
+ * occasional preempted repetition.
+ */
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+
+/* max number of values in frames and channels sweeps */
+#define BENCH_MAX_SWEEP		8
+
+struct bench {
+	/* sweep */
+	uint32_t frames[BENCH_MAX_SWEEP];
+	int num_frames;
+	uint32_t channels[BENCH_MAX_SWEEP];
+	int num_channels;
+
+	/* measurement */
+	int reps;		/* timed repetitions per measurement */
+	uint64_t rep_ns;	/* target duration of one repetition */
+	const char *filter;	/* only run "kernel/variant" with substring */
+
+	/* output */
+	int csv;
+	FILE *out;
+};
+
+/* one kernel invocation, processes samples samples */
+typedef void (*bench_func)(void *data);
+
+/* time func and print its ns per sample statistics */
+void bench_run(struct bench *b, const char *kernel, const char *variant,
+	       uint32_t channels, uint32_t frames, uint32_t samples,
+	       bench_func func, void *data);
+
+/* check kernel/variant against the filter before setting up a case */
+int bench_enabled(struct bench *b, const char *kernel, const char *variant);
+
+/* circular audio buffer with a dummy source and sink component */
+struct comp_buffer *bench_buffer_new(uint32_t bytes);
+
+void bench_buffer_free(struct comp_buffer *buffer);
+
+/* fill buffer with a full scale test signal in the given format */
+void bench_buffer_fill(struct comp_buffer *buffer, enum sof_ipc_frame fmt);
+
+/* component device with stream parameters set and private data */
+struct comp_dev *bench_comp_new(uint32_t channels, uint32_t frames,
+				enum sof_ipc_frame fmt, void *data);
+
+void bench_comp_free(struct comp_dev *dev);
+
+const char *bench_fmt_name(enum sof_ipc_frame fmt);
+
+uint32_t bench_fmt_bytes(enum sof_ipc_frame fmt);
+
+/* kernel groups */
+void bench_volume(struct bench *b);
+void bench_mixer(struct bench *b);
+void bench_src(struct bench *b);
+void bench_fir(struct bench *b);
+void bench_iir(struct bench *b);
+void bench_selector(struct bench *b);
+void bench_math(struct bench *b);
+void bench_buffer(struct bench *b);
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "bench.h"
+
+struct buf_case {
+	struct comp_buffer *buffer;
+	uint32_t bytes;
+};
+
+/* one period through the buffer as a component copy() would do it */
+static void buf_copy(void *data)
+{
+	struct buf_case *bc = data;
+
+	comp_update_buffer_produce(bc->buffer, bc->bytes);
+	comp_update_buffer_consume(bc->buffer, bc->bytes);
+}
+
+static void buf_case_run(struct bench *b, enum sof_ipc_frame fmt,
+			 uint32_t ch, uint32_t frames)
+{
+	struct buf_case bc;
+	const char *variant = bench_fmt_name(fmt);
+
+	if (!bench_enabled(b, "buffer", variant))
+		return;
+
+	/* double buffered period, pointers wrap every other call */
+	bc.bytes = frames * ch * bench_fmt_bytes(fmt);
+	bc.buffer = bench_buffer_new(2 * bc.bytes);
+
+	bench_run(b, "buffer", variant, ch, frames, frames * ch, buf_copy,
+		  &bc);
+
+	bench_buffer_free(bc.buffer);
+}
+
+void bench_buffer(struct bench *b)
+{
+	static const enum sof_ipc_frame fmts[] = {
+		SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S32_LE,
+	};
+	int i;
+	int c;
+	int f;
+
+	for (i = 0; i < ARRAY_SIZE(fmts); i++)
+		for (c = 0; c < b->num_channels; c++)
+			for (f = 0; f < b->num_frames; f++)
+				buf_case_run(b, fmts[i], b->channels[c],
+					     b->frames[f]);
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sof/audio/component.h>
+#include <uapi/user/eq.h>
+#include "fir_config.h"
+#include "fir.h"
+#include "bench.h"
+
+struct fir_case {
+	struct fir_state_32x16 fir[PLATFORM_MAX_CHANNELS];
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+	uint32_t frames;
+	uint32_t ch;
+	void (*filter)(struct fir_state_32x16 fir[],
+		       struct comp_buffer *source, struct comp_buffer *sink,
+		       int frames, int nch);
+};
+
+static void fir_copy(void *data)
+{
+	struct fir_case *fc = data;
+
+	fc->filter(fc->fir, fc->source, fc->sink, fc->frames, fc->ch);
+}
+
+static void fir_case_run(struct bench *b, enum sof_ipc_frame fmt, int taps,
+			 uint32_t ch, uint32_t frames)
+{
+	struct sof_eq_fir_coef_data *config;
+	struct fir_case fc;
+	char variant[32];
+	int32_t *delay;
+	int32_t *data;
+	uint32_t seed = 1;
+	int i;
+
+	snprintf(variant, sizeof(variant), "%s %d taps",
+		 bench_fmt_name(fmt), taps);
+	if (!bench_enabled(b, "fir_32x16", variant) ||
+	    ch > PLATFORM_MAX_CHANNELS)
+		return;
+
+	/* small random coefficients, the response doesn't matter here */
+	config = calloc(1, sizeof(*config) + taps * sizeof(int16_t));
+	config->length = taps;
+	config->out_shift = 0;
+	for (i = 0; i < taps; i++) {
+		seed = seed * 1664525 + 1013904223;
+		config->coef[i] = (int16_t)(seed >> 16) / taps;
+	}
+
+	delay = calloc(ch * taps, sizeof(int32_t));
+	data = delay;
+	for (i = 0; i < ch; i++) {
+		fir_init_coef(&fc.fir[i], config);
+		fir_init_delay(&fc.fir[i], &data);
+	}
+
+	fc.source = bench_buffer_new(frames * ch * bench_fmt_bytes(fmt));
+	fc.sink = bench_buffer_new(frames * ch * bench_fmt_bytes(fmt));
+	fc.frames = frames;
+	fc.ch = ch;
+	bench_buffer_fill(fc.source, fmt);
+
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		fc.filter = eq_fir_s16;
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+		fc.filter = eq_fir_s24;
+		break;
+	default:
+		fc.filter = eq_fir_s32;
+		break;
+	}
+
+	bench_run(b, "fir_32x16", variant, ch, frames, frames * ch, fir_copy,
+		  &fc);
+
+	bench_buffer_free(fc.sink);
+	bench_buffer_free(fc.source);
+	free(delay);
+	free(config);
+}
+
+/* short and maximum length EQ responses */
+void bench_fir(struct bench *b)
+{
+	static const enum sof_ipc_frame fmts[] = {
+		SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S24_4LE,
+		SOF_IPC_FRAME_S32_LE,
+	};
+	static const int taps[] = {32, SOF_EQ_FIR_MAX_LENGTH};
+	int i;
+	int t;
+	int c;
+	int f;
+
+	for (i = 0; i < ARRAY_SIZE(fmts); i++)
+		for (t = 0; t < ARRAY_SIZE(taps); t++)
+			for (c = 0; c < b->num_channels; c++)
+				for (f = 0; f < b->num_frames; f++)
+					fir_case_run(b, fmts[i], taps[t],
+						     b->channels[c],
+						     b->frames[f]);
+}
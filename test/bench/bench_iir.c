@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <uapi/user/eq.h>
+#include "iir.h"
+#include "bench.h"
+
+struct iir_case {
+	struct iir_state_df2t iir[PLATFORM_MAX_CHANNELS];
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+	uint32_t frames;
+	uint32_t ch;
+};
+
+/* same sample loop as the EQ IIR s32 copy */
+static void iir_copy(void *data)
+{
+	struct iir_case *ic = data;
+	struct iir_state_df2t *filter;
+	int32_t *x;
+	int32_t *y;
+	int idx;
+	int ch;
+	int i;
+
+	for (ch = 0; ch < ic->ch; ch++) {
+		filter = &ic->iir[ch];
+		idx = ch;
+		for (i = 0; i < ic->frames; i++) {
+			x = buffer_read_frag_s32(ic->source, idx);
+			y = buffer_write_frag_s32(ic->sink, idx);
+			*y = iir_df2t(filter, *x);
+			idx += ic->ch;
+		}
+	}
+}
+
+static void iir_case_run(struct bench *b, int biquads, uint32_t ch,
+			 uint32_t frames)
+{
+	struct sof_eq_iir_header_df2t *config;
+	struct sof_eq_iir_biquad_df2t *bq;
+	struct iir_case ic;
+	char variant[32];
+	int64_t *delay;
+	int64_t *data;
+	int i;
+
+	snprintf(variant, sizeof(variant), "s32 %d biquads", biquads);
+	if (!bench_enabled(b, "iir_df2t", variant) ||
+	    ch > PLATFORM_MAX_CHANNELS)
+		return;
+
+	/* all sections in series, each a 2nd order low pass at fs / 10 */
+	config = calloc(1, sizeof(*config) + biquads * sizeof(*bq));
+	config->num_sections = biquads;
+	config->num_sections_in_series = biquads;
+	bq = (struct sof_eq_iir_biquad_df2t *)config->biquads;
+	for (i = 0; i < biquads; i++) {
+		bq[i].a2 = -443242343;
+		bq[i].a1 = 1227265967;
+		bq[i].b2 = 72429577;
+		bq[i].b1 = 144859046;
+		bq[i].b0 = 72429577;
+		bq[i].output_shift = 0;
+		bq[i].output_gain = 16384;
+	}
+
+	delay = calloc(ch * 2 * biquads, sizeof(int64_t));
+	data = delay;
+	for (i = 0; i < ch; i++) {
+		iir_init_coef_df2t(&ic.iir[i], config);
+		iir_init_delay_df2t(&ic.iir[i], &data);
+	}
+
+	ic.source = bench_buffer_new(frames * ch * sizeof(int32_t));
+	ic.sink = bench_buffer_new(frames * ch * sizeof(int32_t));
+	ic.frames = frames;
+	ic.ch = ch;
+	bench_buffer_fill(ic.source, SOF_IPC_FRAME_S32_LE);
+
+	bench_run(b, "iir_df2t", variant, ch, frames, frames * ch, iir_copy,
+		  &ic);
+
+	bench_buffer_free(ic.sink);
+	bench_buffer_free(ic.source);
+	free(delay);
+	free(config);
+}
+
+/* a single section and the longest response the EQ accepts */
+void bench_iir(struct bench *b)
+{
+	static const int biquads[] = {1, SOF_EQ_IIR_DF2T_BIQUADS_MAX};
+	int i;
+	int c;
+	int f;
+
+	for (i = 0; i < ARRAY_SIZE(biquads); i++)
+		for (c = 0; c < b->num_channels; c++)
+			for (f = 0; f < b->num_frames; f++)
+				iir_case_run(b, biquads[i], b->channels[c],
+					     b->frames[f]);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sof/math/numbers.h>
+#include <sof/math/trig.h>
+#include "bench.h"
+
+struct math_case {
+	int32_t *x;
+	uint32_t count;
+	uint32_t result;
+};
+
+static void sin_copy(void *data)
+{
+	struct math_case *mc = data;
+	uint32_t acc = 0;
+	uint32_t i;
+
+	for (i = 0; i < mc->count; i++)
+		acc += sin_fixed(mc->x[i]);
+
+	mc->result = acc;
+}
+
+static void crc32_copy(void *data)
+{
+	struct math_case *mc = data;
+
+	mc->result = crc32(mc->x, mc->count * sizeof(int32_t));
+}
+
+/* sin_fixed() over a full turn of Q4.28 angles */
+static void math_sin_run(struct bench *b, uint32_t frames)
+{
+	struct math_case mc;
+	uint32_t i;
+
+	if (!bench_enabled(b, "math", "sin_fixed"))
+		return;
+
+	mc.count = frames;
+	mc.x = malloc(frames * sizeof(int32_t));
+	for (i = 0; i < frames; i++)
+		mc.x[i] = (int64_t)PI_MUL2_Q4_28 * i / frames;
+
+	bench_run(b, "math", "sin_fixed", 1, frames, frames, sin_copy, &mc);
+
+	free(mc.x);
+}
+
+/* crc32() over a period of s32 samples, ns per sample of 4 bytes */
+static void math_crc32_run(struct bench *b, uint32_t ch, uint32_t frames)
+{
+	struct math_case mc;
+	uint32_t i;
+
+	if (!bench_enabled(b, "math", "crc32"))
+		return;
+
+	mc.count = frames * ch;
+	mc.x = malloc(mc.count * sizeof(int32_t));
+	for (i = 0; i < mc.count; i++)
+		mc.x[i] = i * 2654435761U;
+
+	bench_run(b, "math", "crc32", ch, frames, mc.count, crc32_copy, &mc);
+
+	free(mc.x);
+}
+
+void bench_math(struct bench *b)
+{
+	int c;
+	int f;
+
+	for (f = 0; f < b->num_frames; f++)
+		math_sin_run(b, b->frames[f]);
+
+	for (c = 0; c < b->num_channels; c++)
+		for (f = 0; f < b->num_frames; f++)
+			math_crc32_run(b, b->channels[c], b->frames[f]);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sof/audio/mixer.h>
+#include "bench.h"
+
+#define MIX_MAX_SOURCES	4
+
+struct mix_case {
+	struct comp_dev *dev;
+	struct comp_buffer *sources[MIX_MAX_SOURCES];
+	struct comp_buffer *sink;
+	uint32_t num_sources;
+	void (*mix)(struct comp_dev *dev, struct comp_buffer *sink,
+		    struct comp_buffer **sources, uint32_t num_sources,
+		    uint32_t frames);
+};
+
+static void mix_copy(void *data)
+{
+	struct mix_case *mc = data;
+
+	mc->mix(mc->dev, mc->sink, mc->sources, mc->num_sources,
+		mc->dev->frames);
+}
+
+static void mix_case_run(struct bench *b, enum sof_ipc_frame fmt,
+			 uint32_t num_sources, uint32_t ch, uint32_t frames)
+{
+	struct mix_case mc;
+	char variant[32];
+	uint32_t bytes = frames * ch * bench_fmt_bytes(fmt);
+	int i;
+
+	snprintf(variant, sizeof(variant), "%s %u sources",
+		 bench_fmt_name(fmt), num_sources);
+	if (!bench_enabled(b, "mix_n", variant))
+		return;
+
+	mc.dev = bench_comp_new(ch, frames, fmt, NULL);
+	mc.sink = bench_buffer_new(bytes);
+	mc.num_sources = num_sources;
+	mc.mix = fmt == SOF_IPC_FRAME_S16_LE ? mix_n_s16 : mix_n_s32;
+	for (i = 0; i < num_sources; i++) {
+		mc.sources[i] = bench_buffer_new(bytes);
+		bench_buffer_fill(mc.sources[i], fmt);
+	}
+
+	bench_run(b, "mix_n", variant, ch, frames, frames * ch, mix_copy,
+		  &mc);
+
+	for (i = 0; i < num_sources; i++)
+		bench_buffer_free(mc.sources[i]);
+	bench_buffer_free(mc.sink);
+	bench_comp_free(mc.dev);
+}
+
+/* mixer picks the s16 kernel for s16 and the s32 one for all others */
+void bench_mixer(struct bench *b)
+{
+	static const enum sof_ipc_frame fmts[] = {
+		SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S32_LE,
+	};
+	uint32_t num_sources;
+	int i;
+	int c;
+	int f;
+
+	for (i = 0; i < ARRAY_SIZE(fmts); i++)
+		for (num_sources = 2; num_sources <= MIX_MAX_SOURCES;
+		     num_sources *= 2)
+			for (c = 0; c < b->num_channels; c++)
+				for (f = 0; f < b->num_frames; f++)
+					mix_case_run(b, fmts[i], num_sources,
+						     b->channels[c],
+						     b->frames[f]);
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "selector.h"
+#include "bench.h"
+
+struct sel_case {
+	struct comp_dev *dev;
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+};
+
+static void sel_copy(void *data)
+{
+	struct sel_case *sc = data;
+	struct comp_data *cd = comp_get_drvdata(sc->dev);
+
+	cd->sel_func(sc->dev, sc->sink, sc->source, sc->dev->frames);
+}
+
+static void sel_case_run(struct bench *b, enum sof_ipc_frame fmt,
+			 uint32_t in_ch, uint32_t out_ch, uint32_t frames)
+{
+	struct comp_data cd;
+	struct sel_case sc;
+	char variant[32];
+
+	snprintf(variant, sizeof(variant), "%s %uch->%uch",
+		 bench_fmt_name(fmt), in_ch, out_ch);
+	if (!bench_enabled(b, "selector", variant))
+		return;
+
+	memset(&cd, 0, sizeof(cd));
+	cd.source_format = fmt;
+	cd.sink_format = fmt;
+	cd.config.in_channels_count = in_ch;
+	cd.config.out_channels_count = out_ch;
+	cd.config.sel_channel = in_ch - 1;
+
+	sc.dev = bench_comp_new(in_ch, frames, fmt, &cd);
+	cd.sel_func = sel_get_processing_function(sc.dev);
+	if (!cd.sel_func) {
+		bench_comp_free(sc.dev);
+		return;
+	}
+
+	sc.source = bench_buffer_new(frames * in_ch * bench_fmt_bytes(fmt));
+	sc.sink = bench_buffer_new(frames * out_ch * bench_fmt_bytes(fmt));
+	bench_buffer_fill(sc.source, fmt);
+
+	/* samples are counted at the selector input */
+	bench_run(b, "selector", variant, in_ch, frames, frames * in_ch,
+		  sel_copy, &sc);
+
+	bench_buffer_free(sc.sink);
+	bench_buffer_free(sc.source);
+	bench_comp_free(sc.dev);
+}
+
+/* selector accepts 2 or 4 input channels, extracts one or passes through */
+void bench_selector(struct bench *b)
+{
+	static const enum sof_ipc_frame fmts[] = {
+		SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S24_4LE,
+		SOF_IPC_FRAME_S32_LE,
+	};
+	uint32_t ch;
+	int i;
+	int c;
+	int f;
+
+	for (i = 0; i < ARRAY_SIZE(fmts); i++) {
+		for (c = 0; c < b->num_channels; c++) {
+			ch = b->channels[c];
+			if (ch != SEL_SOURCE_2CH && ch != SEL_SOURCE_4CH)
+				continue;
+
+			for (f = 0; f < b->num_frames; f++) {
+				sel_case_run(b, fmts[i], ch, SEL_SINK_1CH,
+					     b->frames[f]);
+				sel_case_run(b, fmts[i], ch, ch,
+					     b->frames[f]);
+			}
+		}
+	}
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "src_config.h"
+#include "src.h"
+#include "bench.h"
+
+#if SRC_SHORT
+#include <sof/audio/coefficients/src/src_tiny_int16_define.h>
+#else
+#include <sof/audio/coefficients/src/src_std_int32_define.h>
+#endif
+
+struct src_case {
+	struct src_stage_prm prm;
+	void (*stage)(struct src_stage_prm *s);
+};
+
+static void src_stage_copy(void *data)
+{
+	struct src_case *sc = data;
+
+	sc->stage(&sc->prm);
+}
+
+static void src_case_run(struct bench *b, enum sof_ipc_frame fmt,
+			 int fs_in, int fs_out, int stage, uint32_t ch,
+			 uint32_t frames)
+{
+	struct polyphase_src src;
+	struct src_param param;
+	struct src_case sc;
+	struct comp_buffer *x;
+	struct comp_buffer *y;
+	struct src_stage *cfg;
+	char variant[32];
+	int32_t *delay_lines;
+	uint32_t bytes = bench_fmt_bytes(fmt);
+	int times;
+
+	snprintf(variant, sizeof(variant), "%s %d->%d s%d",
+		 bench_fmt_name(fmt), fs_in, fs_out, stage);
+	if (!bench_enabled(b, "src", variant))
+		return;
+
+	if (src_buffer_lengths(&param, fs_in, fs_out, ch, frames) < 0)
+		return;
+
+	delay_lines = calloc(param.src_multich, sizeof(int32_t));
+	if (src_polyphase_init(&src, &param, delay_lines) < stage) {
+		free(delay_lines);
+		return;
+	}
+
+	/* as many stage blocks as fit in the period, at least one */
+	cfg = stage == 1 ? src.stage1 : src.stage2;
+	times = frames / cfg->blk_in;
+	if (!times)
+		times = 1;
+
+	x = bench_buffer_new(times * cfg->blk_in * ch * bytes);
+	y = bench_buffer_new(times * cfg->blk_out * ch * bytes);
+	bench_buffer_fill(x, fmt);
+
+	sc.stage = fmt == SOF_IPC_FRAME_S16_LE ?
+		src_polyphase_stage_cir_s16 : src_polyphase_stage_cir;
+	sc.prm.nch = ch;
+	sc.prm.times = times;
+	sc.prm.x_rptr = x->addr;
+	sc.prm.x_end_addr = x->end_addr;
+	sc.prm.x_size = x->size;
+	sc.prm.y_wptr = y->addr;
+	sc.prm.y_addr = y->addr;
+	sc.prm.y_end_addr = y->end_addr;
+	sc.prm.y_size = y->size;
+	sc.prm.shift = fmt == SOF_IPC_FRAME_S24_4LE ? 8 : 0;
+	sc.prm.state = stage == 1 ? &src.state1 : &src.state2;
+	sc.prm.stage = cfg;
+
+	/* samples are counted at the stage output */
+	bench_run(b, "src", variant, ch, times * cfg->blk_in,
+		  times * cfg->blk_out * ch, src_stage_copy, &sc);
+
+	bench_buffer_free(y);
+	bench_buffer_free(x);
+	free(delay_lines);
+}
+
+static void src_stage_sweep(struct bench *b, int fs_in, int fs_out,
+			    int stage)
+{
+	static const enum sof_ipc_frame fmts[] = {
+		SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S24_4LE,
+		SOF_IPC_FRAME_S32_LE,
+	};
+	int i;
+	int c;
+	int f;
+
+	for (i = 0; i < ARRAY_SIZE(fmts); i++)
+		for (c = 0; c < b->num_channels; c++)
+			for (f = 0; f < b->num_frames; f++)
+				src_case_run(b, fmts[i], fs_in, fs_out, stage,
+					     b->channels[c], b->frames[f]);
+}
+
+/*
+ * Each stage filter is shared by several conversions, so it is measured
+ * once with the first conversion that uses it.
+ */
+void bench_src(struct bench *b)
+{
+	struct src_stage *seen[2 * NUM_IN_FS * NUM_OUT_FS];
+	struct polyphase_src src;
+	struct src_param param;
+	struct src_stage *cfg;
+	int32_t *delay_lines;
+	int num_seen = 0;
+	int stages;
+	int stage;
+	int in;
+	int out;
+	int i;
+
+	for (out = 0; out < NUM_OUT_FS; out++) {
+		for (in = 0; in < NUM_IN_FS; in++) {
+			if (src_in_fs[in] == src_out_fs[out] ||
+			    src_buffer_lengths(&param, src_in_fs[in],
+					       src_out_fs[out], 1, 1) < 0)
+				continue;
+
+			delay_lines = calloc(param.src_multich,
+					     sizeof(int32_t));
+			stages = src_polyphase_init(&src, &param,
+						    delay_lines);
+			free(delay_lines);
+
+			for (stage = 1; stage <= stages; stage++) {
+				cfg = stage == 1 ? src.stage1 : src.stage2;
+				for (i = 0; i < num_seen; i++)
+					if (seen[i] == cfg)
+						break;
+				if (i < num_seen)
+					continue;
+
+				seen[num_seen++] = cfg;
+				src_stage_sweep(b, src_in_fs[in],
+						src_out_fs[out], stage);
+			}
+		}
+	}
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "volume.h"
+#include "bench.h"
+
+struct vol_case {
+	struct comp_dev *dev;
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+};
+
+static void vol_copy(void *data)
+{
+	struct vol_case *vc = data;
+	struct comp_data *cd = comp_get_drvdata(vc->dev);
+
+	cd->scale_vol(vc->dev, vc->sink, vc->source, vc->dev->frames);
+}
+
+static void vol_case_run(struct bench *b, const char *variant,
+			 const struct comp_func_map *map, uint32_t ch,
+			 uint32_t frames)
+{
+	struct comp_data cd;
+	struct vol_case vc;
+	int i;
+
+	memset(&cd, 0, sizeof(cd));
+	cd.source_format = map->source;
+	cd.sink_format = map->sink;
+	cd.scale_vol = map->func;
+	for (i = 0; i < SOF_IPC_MAX_CHANNELS; i++)
+		cd.volume[i] = VOL_ZERO_DB / 2;
+
+	vc.dev = bench_comp_new(ch, frames, cd.sink_format, &cd);
+	vc.source = bench_buffer_new(frames * ch *
+				     bench_fmt_bytes(cd.source_format));
+	vc.sink = bench_buffer_new(frames * ch *
+				   bench_fmt_bytes(cd.sink_format));
+	bench_buffer_fill(vc.source, cd.source_format);
+
+	bench_run(b, "volume", variant, ch, frames, frames * ch, vol_copy,
+		  &vc);
+
+	bench_buffer_free(vc.sink);
+	bench_buffer_free(vc.source);
+	bench_comp_free(vc.dev);
+}
+
+/* every source and sink format pair with a dedicated kernel */
+void bench_volume(struct bench *b)
+{
+	char variant[32];
+	int i;
+	int c;
+	int f;
+
+	for (i = 0; i < func_count; i++) {
+		snprintf(variant, sizeof(variant), "%s->%s",
+			 bench_fmt_name(func_map[i].source),
+			 bench_fmt_name(func_map[i].sink));
+		if (!bench_enabled(b, "volume", variant))
+			continue;
+
+		for (c = 0; c < b->num_channels; c++)
+			for (f = 0; f < b->num_frames; f++)
+				vol_case_run(b, variant, &func_map[i],
+					     b->channels[c], b->frames[f]);
+	}
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sof/audio/ima_adpcm.h>
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <cmocka.h>
+
+#define TEST_FRAMES	64
+#define TEST_CHANNELS	2
+#define TEST_BLOCKS	32
+#define TEST_SAMPLES	(TEST_FRAMES * TEST_CHANNELS)
+
+static void test_pcm(int16_t *pcm, int block)
+{
+	int n;
+	int i;
+
+	for (i = 0; i < TEST_FRAMES; i++) {
+		n = block * TEST_FRAMES + i;
+		pcm[i * TEST_CHANNELS] = 8000 * sin(n * 0.1723);
+		pcm[i * TEST_CHANNELS + 1] = 12000 * sin(n * 0.0521);
+	}
+}
+
+static void test_audio_ima_adpcm_silence(void **state)
+{
+	struct ima_adpcm_state enc[TEST_CHANNELS];
+	uint8_t block[IMA_ADPCM_BLOCK_SIZE(TEST_FRAMES, TEST_CHANNELS)];
+	int16_t pcm[TEST_SAMPLES];
+	int16_t out[TEST_SAMPLES];
+
+	(void)state;
+
+	memset(enc, 0, sizeof(enc));
+	memset(pcm, 0, sizeof(pcm));
+
+	ima_adpcm_encode_block(enc, pcm, block, TEST_FRAMES, TEST_CHANNELS);
+	ima_adpcm_decode_block(block, out, TEST_FRAMES, TEST_CHANNELS);
+
+	assert_int_equal(sizeof(block), 72);
+	assert_memory_equal(pcm, out, sizeof(pcm));
+}
+
+static void test_audio_ima_adpcm_snr(void **state)
+{
+	struct ima_adpcm_state enc[TEST_CHANNELS];
+	uint8_t block[IMA_ADPCM_BLOCK_SIZE(TEST_FRAMES, TEST_CHANNELS)];
+	int16_t pcm[TEST_SAMPLES];
+	int16_t out[TEST_SAMPLES];
+	double signal = 0;
+	double noise = 0;
+	int b;
+	int i;
+
+	(void)state;
+
+	memset(enc, 0, sizeof(enc));
+
+	for (b = 0; b < TEST_BLOCKS; b++) {
+		test_pcm(pcm, b);
+		ima_adpcm_encode_block(enc, pcm, block, TEST_FRAMES,
+				       TEST_CHANNELS);
+		ima_adpcm_decode_block(block, out, TEST_FRAMES,
+				       TEST_CHANNELS);
+
+		/* skip the initial adaptation */
+		if (b < 4)
+			continue;
+
+		for (i = 0; i < TEST_SAMPLES; i++) {
+			signal += (double)pcm[i] * pcm[i];
+			noise += (double)(pcm[i] - out[i]) * (pcm[i] - out[i]);
+		}
+	}
+
+	assert_true(10 * log10(signal / noise) > 25);
+}
+
+static void test_audio_ima_adpcm_block_is_standalone(void **state)
+{
+	struct ima_adpcm_state enc[TEST_CHANNELS];
+	uint8_t block[TEST_BLOCKS][IMA_ADPCM_BLOCK_SIZE(TEST_FRAMES,
+							TEST_CHANNELS)];
+	int16_t pcm[TEST_SAMPLES];
+	int16_t out[TEST_SAMPLES];
+	int16_t ref[TEST_SAMPLES];
+	int b;
+
+	(void)state;
+
+	memset(enc, 0, sizeof(enc));
+
+	for (b = 0; b < TEST_BLOCKS; b++) {
+		test_pcm(pcm, b);
+		ima_adpcm_encode_block(enc, pcm, block[b], TEST_FRAMES,
+				       TEST_CHANNELS);
+	}
+
+	/* decoding may start from any block, e.g. after history wrap */
+	ima_adpcm_decode_block(block[TEST_BLOCKS / 2], ref, TEST_FRAMES,
+			       TEST_CHANNELS);
+	for (b = 0; b < TEST_BLOCKS; b++)
+		ima_adpcm_decode_block(block[b], out, TEST_FRAMES,
+				       TEST_CHANNELS);
+	ima_adpcm_decode_block(block[TEST_BLOCKS / 2], out, TEST_FRAMES,
+			       TEST_CHANNELS);
+
+	assert_memory_equal(ref, out, sizeof(out));
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_audio_ima_adpcm_silence),
+		cmocka_unit_test(test_audio_ima_adpcm_snr),
+		cmocka_unit_test(test_audio_ima_adpcm_block_is_standalone),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
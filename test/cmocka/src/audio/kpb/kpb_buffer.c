@@ -56,16 +56,23 @@ struct comp_data {
 	uint32_t kpb_no_of_clients; /**< number of registered clients */
 	struct kpb_client clients[KPB_MAX_NO_OF_CLIENTS];
 	struct notifier kpb_events; /**< KPB events object */
-	struct task draining_task;
+	struct task draining_task[KPB_MAX_NO_OF_CLIENTS]; /**< per client */
 	uint32_t source_period_bytes; /**< source number of period bytes */
 	uint32_t sink_period_bytes; /**< sink number of period bytes */
 	struct sof_kpb_config config;   /**< component configuration data */
 	struct comp_buffer *rt_sink; /**< real time sink (channel selector ) */
-	struct comp_buffer *cli_sink; /**< draining sink (client) */
+	/**< default draining sinks (clients) */
+	struct comp_buffer *cli_sinks[KPB_MAX_NO_OF_CLIENTS];
 	struct hb *history_buffer;
 	bool is_internal_buffer_full;
 	size_t buffered_data;
-	struct dd draining_task_data;
+	struct dd draining_task_data[KPB_MAX_NO_OF_CLIENTS]; /**< per client */
+	spinlock_t lock; /**< protects draining data shared with copy */
+	size_t hb_block_size; /**< encoded history block size, 0 for PCM */
+	/**< history encoder state, per channel */
+	struct ima_adpcm_state enc_state[KPB_MAX_SUPPORTED_CHANNELS];
+	int16_t enc_pcm[KPB_ADPCM_BLOCK_SAMPLES]; /**< block being encoded */
+	uint32_t enc_samples; /**< samples collected in enc_pcm */
 };
 
 enum kpb_test_buff_type {
@@ -96,6 +103,7 @@ struct sof_ipc_comp_kpb_mock {
 	uint32_t history_depth; /**< time of buffering in milliseconds */
 	uint32_t sampling_freq; /**< frequency in hertz */
 	uint32_t sampling_width; /**< number of bits */
+	uint32_t codec; /**< history encoding */
 };
 
 /* Dummy component driver & device */
@@ -183,13 +191,18 @@ static struct comp_buffer *mock_comp_buffer(void **state,
 	case KPB_SOURCE_BUFFER:
 		buffer->avail = test_case_data->period_bytes;
 		buffer->r_ptr = source_data;
+		buffer->addr = source_data;
 		break;
 	case KPB_SINK_BUFFER:
 		buffer->free = test_case_data->period_bytes;
 		buffer->w_ptr = sink_data;
+		buffer->addr = sink_data;
 		break;
 	}
 
+	buffer->size = test_case_data->history_buffer_size;
+	buffer->end_addr = (char *)buffer->addr + buffer->size;
+
 	buffer->cb = NULL;
 
 	return buffer;
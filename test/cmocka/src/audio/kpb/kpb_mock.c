@@ -41,8 +41,9 @@ int comp_set_state(struct comp_dev *dev, int cmd)
 	return 0;
 }
 
-void notifier_register(struct notifier *notifier)
+int notifier_register(struct notifier *notifier)
 {
+	return 0;
 }
 
 int schedule_task_init(struct task *task, uint16_t type, uint16_t priority,
@@ -56,3 +57,12 @@ void schedule_task(struct task *task, uint64_t start, uint64_t deadline,
 		   uint32_t flags)
 {
 }
+
+void schedule_task_free(struct task *task)
+{
+}
+
+int schedule_task_cancel(struct task *task)
+{
+	return 0;
+}
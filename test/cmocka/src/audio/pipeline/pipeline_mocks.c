@@ -106,7 +106,7 @@ int arch_cpu_is_core_enabled(int id)
 
 void cpu_power_down_core(void) { }
 
-void notifier_notify(void) { }
+int notifier_notify_remote(void *payload) { return 0; }
 
 struct ipc_comp_dev *ipc_get_comp(struct ipc *ipc, uint32_t id)
 {
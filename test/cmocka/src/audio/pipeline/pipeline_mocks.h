@@ -46,7 +46,7 @@ void cpu_power_down_core(void);
 
 struct ipc_comp_dev *ipc_get_comp(struct ipc *ipc, uint32_t id);
 
-void notifier_notify(void);
+int notifier_notify_remote(void *payload);
 
 struct pipeline_new_setup_data {
 	struct sof_ipc_pipe_new ipc_data;
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sof/audio/vad.h>
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+
+#define TEST_FRAMES	48
+#define TEST_CHANNELS	2
+#define TEST_SAMPLES	(TEST_FRAMES * TEST_CHANNELS)
+
+static int16_t test_pcm[TEST_SAMPLES];
+static struct comp_buffer test_source;
+static int test_events;
+static uint32_t test_message;
+
+int notifier_event(struct notify_data *notify_data)
+{
+	test_events++;
+	test_message = notify_data->message;
+
+	return 0;
+}
+
+static int setup(void **state)
+{
+	(void)state;
+
+	memset(test_pcm, 0, sizeof(test_pcm));
+	memset(&test_source, 0, sizeof(test_source));
+
+	test_source.addr = test_pcm;
+	test_source.r_ptr = test_pcm;
+	test_source.end_addr = test_pcm + TEST_SAMPLES;
+	test_source.size = sizeof(test_pcm);
+
+	test_events = 0;
+	test_message = 0;
+
+	return 0;
+}
+
+static void test_fill(int16_t left, int16_t right)
+{
+	int i;
+
+	for (i = 0; i < TEST_FRAMES; i++) {
+		test_pcm[i * TEST_CHANNELS] = i & 1 ? -left : left;
+		test_pcm[i * TEST_CHANNELS + 1] = i & 1 ? -right : right;
+	}
+}
+
+static void test_vad_init(struct vad *vad, uint16_t mode, uint32_t hangover)
+{
+	struct vad_config config = {
+		.shift = 3,
+		.threshold = 1000,
+		.decimation = 1,
+		.mode = mode,
+		.hangover = hangover,
+	};
+
+	vad_init(vad, &config, 1);
+}
+
+static void test_audio_vad_silence(void **state)
+{
+	struct vad vad;
+	int i;
+
+	(void)state;
+
+	test_vad_init(&vad, VAD_CHANNELS_MAX, 0);
+
+	for (i = 0; i < 10; i++)
+		assert_false(vad_process(&vad, &test_source, TEST_FRAMES,
+					 TEST_CHANNELS));
+
+	assert_int_equal(vad.activation, 0);
+	assert_int_equal(test_events, 0);
+}
+
+static void test_audio_vad_channels_max(void **state)
+{
+	struct vad vad;
+
+	(void)state;
+
+	/* single loud channel is enough */
+	test_vad_init(&vad, VAD_CHANNELS_MAX, 0);
+	test_fill(0, 1500);
+
+	assert_true(vad_process(&vad, &test_source, TEST_FRAMES,
+				TEST_CHANNELS));
+	assert_int_equal(vad.activation, 1500);
+	assert_int_equal(test_events, 1);
+	assert_int_equal(test_message, 1);
+}
+
+static void test_audio_vad_channels_avg(void **state)
+{
+	struct vad vad;
+
+	(void)state;
+
+	/* single loud channel is averaged below threshold */
+	test_vad_init(&vad, VAD_CHANNELS_AVG, 0);
+	test_fill(0, 1500);
+
+	assert_false(vad_process(&vad, &test_source, TEST_FRAMES,
+				 TEST_CHANNELS));
+	assert_int_equal(vad.activation, 750);
+	assert_int_equal(test_events, 0);
+}
+
+static void test_audio_vad_decimation(void **state)
+{
+	struct vad vad;
+	struct vad_config config = {
+		.shift = 3,
+		.threshold = 1000,
+		.decimation = 2,
+		.mode = VAD_CHANNELS_MAX,
+	};
+
+	(void)state;
+
+	/* only even frames are looked at */
+	vad_init(&vad, &config, 1);
+	test_fill(2000, 2000);
+	test_pcm[TEST_CHANNELS] = INT16_MAX;
+
+	vad_process(&vad, &test_source, TEST_FRAMES, TEST_CHANNELS);
+	assert_int_equal(vad.activation, 2000);
+}
+
+static void test_audio_vad_hangover(void **state)
+{
+	struct vad vad;
+
+	(void)state;
+
+	test_vad_init(&vad, VAD_CHANNELS_MAX, 2 * TEST_FRAMES);
+	test_fill(2000, 2000);
+	assert_true(vad_process(&vad, &test_source, TEST_FRAMES,
+				TEST_CHANNELS));
+
+	/* stays active for hangover frames after level drops */
+	test_fill(0, 0);
+	assert_true(vad_process(&vad, &test_source, TEST_FRAMES,
+				TEST_CHANNELS));
+	assert_true(vad_process(&vad, &test_source, TEST_FRAMES,
+				TEST_CHANNELS));
+	assert_false(vad_process(&vad, &test_source, TEST_FRAMES,
+				 TEST_CHANNELS));
+
+	assert_int_equal(test_events, 2);
+	assert_int_equal(test_message, 0);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup(test_audio_vad_silence, setup),
+		cmocka_unit_test_setup(test_audio_vad_channels_max, setup),
+		cmocka_unit_test_setup(test_audio_vad_channels_avg, setup),
+		cmocka_unit_test_setup(test_audio_vad_decimation, setup),
+		cmocka_unit_test_setup(test_audio_vad_hangover, setup),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include <sof/dma.h>
+#include <sof/dw-dma.h>
+#include <platform/dw-dma.h>
+#include <platform/platform.h>
+
+#define TEST_PERIOD_BYTES	192
+#define TEST_PERIODS		4
+#define TEST_BUFFER_BYTES	(TEST_PERIOD_BYTES * TEST_PERIODS)
+#define TEST_FIFO		0x1000
+
+/* register file of the DMA controller */
+static uint32_t dw_regs[(DW_FIFO_PART1_HI + 4) / sizeof(uint32_t)];
+
+static uint8_t buffer[2 * TEST_BUFFER_BYTES];
+
+static struct dw_drv_plat_data dw_plat_data;
+
+struct test_data {
+	struct dma dma;
+	struct dma_sg_config config;
+	struct dma_sg_elem elems[TEST_PERIODS];
+	int chan;
+};
+
+static uint32_t dw_reg(uint32_t reg)
+{
+	return dw_regs[reg / sizeof(uint32_t)];
+}
+
+static void dw_reg_set(uint32_t reg, uint32_t value)
+{
+	dw_regs[reg / sizeof(uint32_t)] = value;
+}
+
+/* copy path only follows positions, like dai in irq mode */
+static void test_dma_cb(void *data, uint32_t type, struct dma_sg_elem *next)
+{
+	next->size = DMA_RELOAD_IGNORE;
+}
+
+static int setup(void **state)
+{
+	struct test_data *td = calloc(1, sizeof(*td));
+	int i;
+
+	memset(dw_regs, 0, sizeof(dw_regs));
+
+	td->dma.plat_data.base = (uint32_t)dw_regs;
+	td->dma.plat_data.channels = DW_MAX_CHAN;
+	td->dma.plat_data.drv_plat_data = &dw_plat_data;
+	td->dma.ops = &dw_dma_ops;
+
+	assert_int_equal(dma_probe(&td->dma), 0);
+
+	td->chan = dma_channel_get(&td->dma, 0);
+	assert_int_equal(td->chan, 0);
+
+	/* playback of a contiguous buffer, period per elem */
+	for (i = 0; i < TEST_PERIODS; i++) {
+		td->elems[i].src = (uint32_t)buffer + i * TEST_PERIOD_BYTES;
+		td->elems[i].dest = TEST_FIFO;
+		td->elems[i].size = TEST_PERIOD_BYTES;
+	}
+
+	td->config.direction = DMA_DIR_MEM_TO_DEV;
+	td->config.src_width = sizeof(uint32_t);
+	td->config.dest_width = sizeof(uint32_t);
+	td->config.cyclic = 1;
+	td->config.irq_periods = 2;
+	td->config.elem_array.count = TEST_PERIODS;
+	td->config.elem_array.elems = td->elems;
+
+	dma_set_cb(&td->dma, td->chan, DMA_CB_TYPE_COPY, test_dma_cb, NULL);
+
+	*state = td;
+
+	return 0;
+}
+
+static int teardown(void **state)
+{
+	struct test_data *td = *state;
+
+	dma_channel_put(&td->dma, td->chan);
+	dma_remove(&td->dma);
+	free(td);
+
+	return 0;
+}
+
+static void test_drivers_dw_dma_irq_periods_invalid(void **state)
+{
+	struct test_data *td = *state;
+
+	/* irq periods have to divide the chain */
+	td->config.elem_array.count = 3;
+
+	assert_int_equal(dma_set_config(&td->dma, td->chan, &td->config),
+			 -EINVAL);
+}
+
+static void test_drivers_dw_dma_irq_periods_chain(void **state)
+{
+	struct test_data *td = *state;
+#if CONFIG_HW_LLI
+	struct dw_lli *lli;
+	int i;
+#endif
+
+	assert_int_equal(dma_set_config(&td->dma, td->chan, &td->config), 0);
+	assert_int_equal(dma_start(&td->dma, td->chan), 0);
+
+	assert_int_equal(dw_reg(DW_SAR(td->chan)),
+			 (uint32_t)buffer | PLATFORM_HOST_DMA_MASK);
+	assert_int_equal(dw_reg(DW_DAR(td->chan)), TEST_FIFO);
+
+#if CONFIG_HW_LLI
+	/* circular chain of all periods, interrupt on every 2nd one */
+	lli = (struct dw_lli *)dw_reg(DW_LLP(td->chan));
+	assert_non_null(lli);
+
+	for (i = 0; i < TEST_PERIODS; i++) {
+		assert_int_equal(lli[i].ctrl_hi & DW_CTLH_BLOCK_TS_MASK,
+				 TEST_PERIOD_BYTES);
+		assert_int_equal(lli[i].ctrl_lo & DW_CTLL_INT_EN, i % 2);
+	}
+
+	assert_int_equal(lli[TEST_PERIODS - 1].llp, (uint32_t)lli);
+#else
+	/* two periods are transferred by a single block */
+	assert_int_equal(dw_reg(DW_CTRL_HIGH(td->chan)) &
+			 DW_CTLH_BLOCK_TS_MASK, 2 * TEST_PERIOD_BYTES);
+	assert_int_equal(dw_reg(DW_CTRL_LOW(td->chan)) & DW_CTLL_INT_EN,
+			 DW_CTLL_INT_EN);
+#endif
+}
+
+static void test_drivers_dw_dma_irq_periods_not_contiguous(void **state)
+{
+	struct test_data *td = *state;
+
+	/* second period is elsewhere, so it can't extend the first */
+	td->elems[1].src = (uint32_t)buffer + TEST_BUFFER_BYTES;
+
+	assert_int_equal(dma_set_config(&td->dma, td->chan, &td->config), 0);
+	assert_int_equal(dma_start(&td->dma, td->chan), 0);
+
+	assert_int_equal(dw_reg(DW_CTRL_HIGH(td->chan)) &
+			 DW_CTLH_BLOCK_TS_MASK, TEST_PERIOD_BYTES);
+}
+
+static void test_drivers_dw_dma_position(void **state)
+{
+	struct test_data *td = *state;
+	uint32_t start;
+	uint32_t avail_bytes = 0;
+	uint32_t free_bytes = 0;
+
+	assert_int_equal(dma_set_config(&td->dma, td->chan, &td->config), 0);
+	assert_int_equal(dma_start(&td->dma, td->chan), 0);
+
+	start = dw_reg(DW_SAR(td->chan));
+
+	/* engine has read 3 periods */
+	dw_reg_set(DW_SAR(td->chan), start + 3 * TEST_PERIOD_BYTES);
+	dma_get_data_size(&td->dma, td->chan, &avail_bytes,
+			  &free_bytes);
+	assert_int_equal(free_bytes, 3 * TEST_PERIOD_BYTES);
+
+	/* copy path refills one of them */
+	dma_copy(&td->dma, td->chan, TEST_PERIOD_BYTES, 0);
+	dma_get_data_size(&td->dma, td->chan, &avail_bytes,
+			  &free_bytes);
+	assert_int_equal(free_bytes, 2 * TEST_PERIOD_BYTES);
+
+	/* read position wraps */
+	dw_reg_set(DW_SAR(td->chan), start + 64);
+	dma_get_data_size(&td->dma, td->chan, &avail_bytes,
+			  &free_bytes);
+	assert_int_equal(free_bytes,
+			 TEST_BUFFER_BYTES - TEST_PERIOD_BYTES + 64);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown
+			(test_drivers_dw_dma_irq_periods_invalid,
+			 setup, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_drivers_dw_dma_irq_periods_chain,
+			 setup, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_drivers_dw_dma_irq_periods_not_contiguous,
+			 setup, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_drivers_dw_dma_position,
+			 setup, teardown),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,303 @@
+/*
+ * Compact trace round trip test, records encoded like the firmware does
+ * are decoded by the logger and compared field by field.
+ *
+ * Copyright (c) 2019, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sof/trace_compact.h>
+#include <uapi/abi.h>
+#include "convert.h"
+
+#define TEST_BASE_ADDRESS	0x9e000000
+#define TEST_RECORDS		4096
+#define TEST_CORES		4
+#define TEST_SYNC		64	/* absolute timestamp every n records */
+#define TRACE_CLASS_SHIFT	24
+
+/* same layout as the entries in the firmware log entries section */
+struct test_entry_header {
+	uint32_t level;
+	uint32_t component_class;
+	uint32_t has_ids;
+	uint32_t params_num;
+	uint32_t line_idx;
+	uint32_t file_name_len;
+	uint32_t text_len;
+};
+
+struct test_entry {
+	uint32_t offset;
+	uint32_t level;
+	uint32_t has_ids;
+	uint32_t params_num;
+	const char *text;
+};
+
+/* last one is beyond the 16 bit index, so it needs TRACE_COMPACT_ADDR */
+static const struct test_entry test_entries[] = {
+	{ 0x00000, 1, 0, 0, "no params" },
+	{ 0x00040, 2, 1, 1, "one param %d" },
+	{ 0x00080, 3, 1, 2, "two params %d %d" },
+	{ 0x000c0, 4, 0, 4, "four params %d %d %d %d" },
+	{ 0x40000, 1, 1, 3, "far entry %d %d %d" },
+};
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+#define TEST_ENTRIES ARRAY_SIZE(test_entries)
+#define TEST_DATA_LENGTH 0x40040
+
+static uint32_t test_seed = 1;
+
+static uint32_t test_rand(void)
+{
+	test_seed = test_seed * 1103515245 + 12345;
+	return test_seed >> 8;
+}
+
+static int write_dictionary(FILE *fd)
+{
+	static const char file_name[] = "compact_test.c";
+	struct snd_sof_logs_header snd;
+	struct test_entry_header header;
+	uint8_t *data;
+	uint32_t i;
+	int ret = 0;
+
+	data = calloc(1, TEST_DATA_LENGTH);
+	if (!data)
+		return -ENOMEM;
+
+	for (i = 0; i < TEST_ENTRIES; i++) {
+		uint8_t *entry = data + test_entries[i].offset;
+
+		memset(&header, 0, sizeof(header));
+		header.level = test_entries[i].level;
+		header.component_class = (i + 1) << TRACE_CLASS_SHIFT;
+		header.has_ids = test_entries[i].has_ids;
+		header.params_num = test_entries[i].params_num;
+		header.line_idx = i;
+		header.file_name_len = sizeof(file_name);
+		header.text_len = strlen(test_entries[i].text) + 1;
+		memcpy(entry, &header, sizeof(header));
+		memcpy(entry + sizeof(header), file_name, sizeof(file_name));
+		strcpy((char *)entry + sizeof(header) + sizeof(file_name),
+		       test_entries[i].text);
+	}
+
+	memset(&snd, 0, sizeof(snd));
+	memcpy(snd.sig, SND_SOF_LOGS_SIG, SND_SOF_LOGS_SIG_SIZE);
+	snd.base_address = TEST_BASE_ADDRESS;
+	snd.data_length = TEST_DATA_LENGTH;
+	snd.data_offset = sizeof(snd);
+	snd.version.abi_version = SOF_ABI_VERSION;
+	snd.version.trace_format = SOF_IPC_TRACE_FORMAT_COMPACT;
+
+	if (fwrite(&snd, sizeof(snd), 1, fd) != 1 ||
+	    fwrite(data, TEST_DATA_LENGTH, 1, fd) != 1)
+		ret = -EIO;
+
+	free(data);
+	return ret;
+}
+
+/* encode the records as the DMA trace would, keep what we expect back */
+static int write_stream(FILE *fd, struct convert_bin_record *expect)
+{
+	uint32_t record[(sizeof(struct log_entry_header) +
+			 sizeof(uint32_t) * TRACE_MAX_PARAMS_COUNT) /
+			sizeof(uint32_t)];
+	uint64_t timestamps[TEST_CORES] = { 0 };
+	uint64_t last[TEST_CORES] = { 0 };
+	uint32_t records[TEST_CORES] = { 0 };
+	uint8_t dst[TRACE_COMPACT_MAX_SIZE];
+	struct log_entry_header header;
+	const struct test_entry *entry;
+	uint32_t core;
+	uint32_t size;
+	uint32_t i;
+	uint32_t j;
+
+	for (i = 0; i < TEST_RECORDS; i++) {
+		entry = &test_entries[test_rand() % TEST_ENTRIES];
+		core = test_rand() % TEST_CORES;
+
+		/* mostly short deltas, a few long ones and a step back */
+		switch (test_rand() % 16) {
+		case 0:
+			timestamps[core] += (uint64_t)test_rand() << 20;
+			break;
+		case 1:
+			timestamps[core] -= timestamps[core] / 4;
+			break;
+		default:
+			timestamps[core] += test_rand() % 2000;
+			break;
+		}
+
+		memset(&header, 0, sizeof(header));
+		header.core_id = core;
+		header.timestamp = timestamps[core];
+		header.log_entry_address = TEST_BASE_ADDRESS + entry->offset;
+		header.id_0 = TRACE_COMPACT_NO_ID;
+		header.id_1 = TRACE_COMPACT_NO_ID;
+		if (entry->has_ids) {
+			header.id_0 = test_rand() % TRACE_COMPACT_NO_ID;
+			header.id_1 = test_rand() % TRACE_COMPACT_NO_ID;
+		}
+		memcpy(record, &header, sizeof(header));
+
+		memset(&expect[i], 0, sizeof(expect[i]));
+		for (j = 0; j < entry->params_num; j++) {
+			/* small, negative and full range values */
+			switch (test_rand() % 3) {
+			case 0:
+				expect[i].params[j] = test_rand() % 100;
+				break;
+			case 1:
+				expect[i].params[j] = -(test_rand() % 100);
+				break;
+			default:
+				expect[i].params[j] = test_rand() << 8 ^
+						      test_rand();
+				break;
+			}
+			record[sizeof(header) / sizeof(uint32_t) + j] =
+				expect[i].params[j];
+		}
+
+		size = trace_compact_encode(record, sizeof(header) +
+					    entry->params_num *
+					    sizeof(uint32_t), last[core],
+					    !(records[core] % TEST_SYNC),
+					    TEST_BASE_ADDRESS, dst);
+		if (size % sizeof(uint32_t) || size > sizeof(dst)) {
+			fprintf(stderr, "error: record %u is %u bytes\n", i,
+				size);
+			return -EINVAL;
+		}
+		if (fwrite(dst, size, 1, fd) != 1)
+			return -EIO;
+
+		last[core] = timestamps[core];
+		records[core]++;
+
+		expect[i].timestamp = header.timestamp;
+		expect[i].entry_address = header.log_entry_address;
+		expect[i].component_class = (entry - test_entries + 1) <<
+					    TRACE_CLASS_SHIFT;
+		expect[i].id_0 = header.id_0;
+		expect[i].id_1 = header.id_1;
+		expect[i].core_id = core;
+		expect[i].level = entry->level;
+		expect[i].has_ids = entry->has_ids;
+		expect[i].params_num = entry->params_num;
+	}
+
+	return 0;
+}
+
+static int check_output(FILE *fd, const struct convert_bin_record *expect)
+{
+	struct convert_bin_record rec;
+	uint32_t i;
+
+	rewind(fd);
+	for (i = 0; i < TEST_RECORDS; i++) {
+		if (fread(&rec, sizeof(rec), 1, fd) != 1) {
+			fprintf(stderr, "error: %u of %u records decoded\n", i,
+				TEST_RECORDS);
+			return -EINVAL;
+		}
+		if (memcmp(&rec, &expect[i], sizeof(rec))) {
+			fprintf(stderr,
+				"error: record %u is ts %lu entry 0x%x, not ts %lu entry 0x%x\n",
+				i, (unsigned long)rec.timestamp,
+				rec.entry_address,
+				(unsigned long)expect[i].timestamp,
+				expect[i].entry_address);
+			return -EINVAL;
+		}
+	}
+
+	if (fread(&rec, sizeof(rec), 1, fd)) {
+		fprintf(stderr, "error: extra records decoded\n");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	struct convert_bin_record *expect;
+	struct convert_config config;
+	int ret;
+
+	expect = calloc(TEST_RECORDS, sizeof(*expect));
+	if (!expect)
+		return 1;
+
+	memset(&config, 0, sizeof(config));
+	config.clock = 1.0;
+	config.serial_fd = -EINVAL;
+	config.format = CONVERT_FORMAT_BIN;
+	config.jobs = 1;
+	config.filter.id_0 = -1;
+	config.filter.id_1 = -1;
+	config.ldc_file = "dictionary";
+	config.in_file = "stream";
+
+	config.ldc_fd = tmpfile();
+	config.in_fd = tmpfile();
+	config.out_fd = tmpfile();
+	if (!config.ldc_fd || !config.in_fd || !config.out_fd) {
+		fprintf(stderr, "error: can't create temporary files\n");
+		ret = -EIO;
+		goto out;
+	}
+
+	ret = write_dictionary(config.ldc_fd);
+	if (!ret)
+		ret = write_stream(config.in_fd, expect);
+	if (ret)
+		goto out;
+
+	rewind(config.ldc_fd);
+	rewind(config.in_fd);
+	ret = convert(&config);
+	if (ret) {
+		fprintf(stderr, "error: convert failed %d\n", ret);
+		goto out;
+	}
+
+	fflush(config.out_fd);
+	ret = check_output(config.out_fd, expect);
+
+out:
+	if (config.ldc_fd)
+		fclose(config.ldc_fd);
+	if (config.in_fd)
+		fclose(config.in_fd);
+	if (config.out_fd)
+		fclose(config.out_fd);
+	free(expect);
+
+	if (!ret)
+		printf("%u compact records decoded\n", TEST_RECORDS);
+	return ret ? 1 : 0;
+}
@@ -16,18 +16,37 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <strings.h>
 #include <errno.h>
 #include <unistd.h>
 #include <math.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <zlib.h>
 #include "convert.h"
 
 #define CEIL(a, b) ((a+b-1)/b)
 
-#define TRACE_MAX_PARAMS_COUNT		4
 #define TRACE_MAX_TEXT_LEN		1024
 #define TRACE_MAX_FILENAME_LEN		128
 #define TRACE_MAX_IDS_STR		10
 #define TRACE_IDS_MASK			((1 << TRACE_ID_LENGTH) - 1)
+#define TRACE_CLASS_SHIFT		24
+#define TRACE_CLASS_COUNT		32
+
+/* log entries are 4 byte aligned in .static_log_entries section */
+#define LDC_ENTRY_ALIGN			4
+#define LDC_NAME_HASH_SIZE		256
+
+/* output buffer used when nobody is watching the output live */
+#define LDC_OUT_BUF_SIZE		(1024 * 1024)
+
+/* input buffer of compact record decoder */
+#define LDC_COMPACT_BUF_SIZE		(64 * 1024)
+
+/* input split for parallel decode, must be a multiple of 4 */
+#define DECODE_CHUNK_SIZE		(4 * 1024 * 1024)
 
 struct ldc_entry_header {
 	uint32_t level;
@@ -39,11 +58,45 @@ struct ldc_entry_header {
 	uint32_t text_len;
 };
 
+/* pre-parsed dictionary entry, strings point into the dictionary */
 struct ldc_entry {
 	struct ldc_entry_header header;
-	char *file_name;
-	char *text;
-	uint32_t *params;
+	const char *file_name;
+	const char *text;
+	const char *comp_name;
+	char *fmt;
+};
+
+/* interned source file name, shared by all entries from one file */
+struct ldc_name {
+	const char *raw;
+	const char *name;
+	struct ldc_name *next;
+};
+
+/*
+ * The whole ldc file is mapped (or read) once. Entries are parsed on first
+ * use and cached in an array indexed by their offset in the entries section,
+ * so decoding a log record is a table lookup. v2 dictionaries keep entries
+ * as records plus a string table, record_index maps offsets to records.
+ */
+struct ldc_dict {
+	const uint8_t *map;
+	size_t map_size;
+	int mapped;
+	const uint8_t *data;
+	uint32_t base_address;
+	uint32_t data_length;
+	const struct snd_sof_logs_entry *records;	/* v2 only */
+	uint32_t *record_index;		/* record number + 1 by offset */
+	const char *strings;
+	uint32_t strings_size;
+	uint8_t *payload;		/* decompressed v2 payload */
+	struct ldc_entry **index;
+	struct ldc_name *names[LDC_NAME_HASH_SIZE];
+	int raw_output;
+	int use_colors;
+	pthread_mutex_t lock;	/* parallel decode fills index */
 };
 
 static double to_usecs(uint64_t time, double clk)
@@ -65,7 +118,6 @@ static inline void print_table_header(FILE *out_fd)
 		"DELTA",
 		"FILE_NAME",
 		"CONTENT");
-	fflush(out_fd);
 }
 
 #define CASE(x) \
@@ -127,155 +179,551 @@ static char *format_file_name(char *file_name_raw, int full_name)
 
 static void print_entry_params(FILE *out_fd,
 	const struct log_entry_header *dma_log, const struct ldc_entry *entry,
-	uint64_t last_timestamp, double clock, int use_colors, int raw_output)
-{	
+	const uint32_t *params, uint64_t last_timestamp, double clock,
+	int use_colors, int raw_output)
+{
 	char ids[TRACE_MAX_IDS_STR];
 	float dt = to_usecs(dma_log->timestamp - last_timestamp, clock);
-	const char *entry_fmt = raw_output ?
-		"%s%u %u %s%s%s %.6f %.6f (%s:%u) " :
-		"%s%5u %6u %12s%s %-7s %16.6f %16.6f %20s:%-4u\t";
 
 	if (dt < 0 || dt > 1000.0 * 1000.0 * 1000.0)
 		dt = NAN;
-	
+
 	if (entry->header.has_ids)
 		sprintf(ids, "%d.%d", (dma_log->id_0 & TRACE_IDS_MASK),
 			(dma_log->id_1 & TRACE_IDS_MASK));
-	fprintf(out_fd, entry_fmt,
+
+	/* entry->fmt holds the line prefix, the entry text and the newline */
+	fprintf(out_fd, entry->fmt,
 		entry->header.level == use_colors ?
 			(LOG_LEVEL_CRITICAL ? KRED : KNRM) : "",
 		dma_log->core_id,
 		entry->header.level,
-		get_component_name(entry->header.component_class),
+		entry->comp_name,
 		raw_output && entry->header.has_ids ? "-" : "",
 		entry->header.has_ids ? ids : "",
 		to_usecs(dma_log->timestamp, clock),
 		dt,
-		format_file_name(entry->file_name, raw_output),
-		entry->header.line_idx);
+		entry->file_name,
+		entry->header.line_idx,
+		params[0], params[1], params[2], params[3]);
+}
 
-	switch (entry->header.params_num) {
-	case 0:
-		fprintf(out_fd, "%s", entry->text);
-		break;
-	case 1:
-		fprintf(out_fd, entry->text, entry->params[0]);
-		break;
-	case 2:
-		fprintf(out_fd, entry->text, entry->params[0], entry->params[1]);
-		break;
-	case 3:
-		fprintf(out_fd, entry->text, entry->params[0], entry->params[1],
-			entry->params[2]);
-		break;
-	case 4:
-		fprintf(out_fd, entry->text, entry->params[0], entry->params[1],
-			entry->params[2], entry->params[3]);
-		break;
+static void print_entry_csv(FILE *out_fd,
+	const struct log_entry_header *dma_log, const struct ldc_entry *entry,
+	const uint32_t *params, double clock)
+{
+	uint32_t i;
+
+	if (entry->header.has_ids)
+		fprintf(out_fd, "%.6f,%u,%u,%s,%u,%u,0x%08x,%u",
+			to_usecs(dma_log->timestamp, clock), dma_log->core_id,
+			entry->header.level, entry->comp_name,
+			dma_log->id_0 & TRACE_IDS_MASK,
+			dma_log->id_1 & TRACE_IDS_MASK,
+			dma_log->log_entry_address, entry->header.params_num);
+	else
+		fprintf(out_fd, "%.6f,%u,%u,%s,,,0x%08x,%u",
+			to_usecs(dma_log->timestamp, clock), dma_log->core_id,
+			entry->header.level, entry->comp_name,
+			dma_log->log_entry_address, entry->header.params_num);
+
+	for (i = 0; i < TRACE_MAX_PARAMS_COUNT; i++) {
+		if (i < entry->header.params_num)
+			fprintf(out_fd, ",%u", params[i]);
+		else
+			fputc(',', out_fd);
 	}
-	fprintf(out_fd, "%s\n", use_colors ? KNRM : "");
-	fflush(out_fd);
+	fputc('\n', out_fd);
 }
 
-static int fetch_entry(const struct convert_config *config,
-	uint32_t base_address, uint32_t data_offset,
-	const struct log_entry_header *dma_log, uint64_t *last_timestamp)
+static void print_entry_bin(FILE *out_fd,
+	const struct log_entry_header *dma_log, const struct ldc_entry *entry,
+	const uint32_t *params)
 {
-	struct ldc_entry entry;
-	uint32_t entry_offset;
+	struct convert_bin_record rec;
 
-	int ret;
+	memset(&rec, 0, sizeof(rec));
+	rec.timestamp = dma_log->timestamp;
+	rec.entry_address = dma_log->log_entry_address;
+	rec.component_class = entry->header.component_class;
+	rec.id_0 = dma_log->id_0 & TRACE_IDS_MASK;
+	rec.id_1 = dma_log->id_1 & TRACE_IDS_MASK;
+	rec.core_id = dma_log->core_id;
+	rec.level = entry->header.level;
+	rec.has_ids = entry->header.has_ids;
+	rec.params_num = entry->header.params_num;
+	memcpy(rec.params, params, sizeof(uint32_t) * rec.params_num);
 
-	entry.file_name = NULL;
-	entry.text = NULL;
-	entry.params = NULL;
+	fwrite(&rec, sizeof(rec), 1, out_fd);
+}
 
-	/* evaluate entry offset in input file */
-	entry_offset = dma_log->log_entry_address - base_address;
+/* returns nonzero when record passes the filter */
+static int filter_match(const struct convert_filter *filter,
+	const struct log_entry_header *dma_log, const struct ldc_entry *entry,
+	double clock)
+{
+	uint32_t class_idx = entry->header.component_class >> TRACE_CLASS_SHIFT;
+	double t;
 
-	/* set file position to beginning of processed entry */
-	fseek(config->ldc_fd, entry_offset + data_offset, SEEK_SET);
+	if (filter->core_mask &&
+	    (dma_log->core_id >= 32 ||
+	     !(filter->core_mask & (1u << dma_log->core_id))))
+		return 0;
 
-	/* fetching elf header params */
-	ret = fread(&entry.header, sizeof(entry.header), 1, config->ldc_fd);
-	if (!ret) {
-		ret = -ferror(config->ldc_fd);
-		goto out;
+	if (filter->level && entry->header.level > filter->level)
+		return 0;
+
+	if (filter->class_mask &&
+	    (class_idx >= TRACE_CLASS_COUNT ||
+	     !(filter->class_mask & (1u << class_idx))))
+		return 0;
+
+	if (filter->id_0 >= 0 || filter->id_1 >= 0) {
+		if (!entry->header.has_ids)
+			return 0;
+		if (filter->id_0 >= 0 &&
+		    (dma_log->id_0 & TRACE_IDS_MASK) != filter->id_0)
+			return 0;
+		if (filter->id_1 >= 0 &&
+		    (dma_log->id_1 & TRACE_IDS_MASK) != filter->id_1)
+			return 0;
 	}
-	if (entry.header.file_name_len > TRACE_MAX_FILENAME_LEN) {
-		fprintf(stderr, "Error: Invalid filename length or ldc file does not match firmware\n");
-		ret = -EINVAL;
-		goto out;
+
+	if (filter->time_from > 0 || filter->time_to > 0) {
+		t = to_usecs(dma_log->timestamp, clock);
+		if (t < filter->time_from)
+			return 0;
+		if (filter->time_to > 0 && t > filter->time_to)
+			return 0;
 	}
-	entry.file_name = (char *)malloc(entry.header.file_name_len);
 
-	if (!entry.file_name) {
-		fprintf(stderr, "error: can't allocate %d byte for "
-			"entry.file_name\n", entry.header.file_name_len);
-		ret = -ENOMEM;
-		goto out;
+	return 1;
+}
+
+/*
+ * Build the whole output line format of an entry once, so each record is
+ * printed with a single fprintf(). Entries without params print their text
+ * verbatim, hence '%' has to be escaped there.
+ */
+static char *build_entry_fmt(const char *text, uint32_t params_num,
+	int use_colors, int raw_output)
+{
+	const char *entry_fmt = raw_output ?
+		"%s%u %u %s%s%s %.6f %.6f (%s:%u) " :
+		"%s%5u %6u %12s%s %-7s %16.6f %16.6f %20s:%-4u\t";
+	const char *end = use_colors ? KNRM "\n" : "\n";
+	char *fmt;
+	char *c;
+
+	fmt = malloc(strlen(entry_fmt) + 2 * strlen(text) + strlen(end) + 1);
+	if (!fmt)
+		return NULL;
+
+	strcpy(fmt, entry_fmt);
+	c = fmt + strlen(fmt);
+	for (; *text; text++) {
+		if (*text == '%' && !params_num)
+			*c++ = '%';
+		*c++ = *text;
 	}
+	strcpy(c, end);
 
-	ret = fread(entry.file_name, sizeof(char), entry.header.file_name_len,
-		config->ldc_fd);
-	if (ret != entry.header.file_name_len) {
-		ret = -ferror(config->ldc_fd);
-		goto out;
+	return fmt;
+}
+
+static unsigned int name_hash(const char *s)
+{
+	unsigned int hash = 2166136261u;
+
+	while (*s)
+		hash = (hash ^ (uint8_t)*s++) * 16777619u;
+	return hash % LDC_NAME_HASH_SIZE;
+}
+
+/* return formatted file name, shared between all entries of the same file */
+static const char *intern_file_name(struct ldc_dict *dict, const char *raw)
+{
+	unsigned int hash = name_hash(raw);
+	struct ldc_name *n;
+
+	for (n = dict->names[hash]; n; n = n->next)
+		if (!strcmp(n->raw, raw))
+			return n->name;
+
+	n = malloc(sizeof(*n));
+	if (!n) {
+		fprintf(stderr, "error: can't allocate file name\n");
+		return NULL;
 	}
+	n->raw = raw;
+	n->name = format_file_name((char *)raw, dict->raw_output);
+	n->next = dict->names[hash];
+	dict->names[hash] = n;
+	return n->name;
+}
 
-	/* fetching text */
-	if (entry.header.text_len > TRACE_MAX_TEXT_LEN) {
-		fprintf(stderr, "Error: Invalid text length. \n");
-		ret = -EINVAL;
-		goto out;
+static int dict_load_v2(struct ldc_dict *dict,
+	const struct convert_config *config,
+	const struct snd_sof_logs_header *snd)
+{
+	struct snd_sof_logs_header_v2 hdr;
+	const uint8_t *payload;
+	uLongf size;
+	uint32_t i;
+
+	if (dict->map_size < sizeof(*snd) + sizeof(hdr))
+		goto truncated;
+	memcpy(&hdr, dict->map + sizeof(*snd), sizeof(hdr));
+
+	if ((uint64_t)snd->data_offset + hdr.stored_size > dict->map_size)
+		goto truncated;
+	payload = dict->map + snd->data_offset;
+
+	if ((uint64_t)hdr.entry_count * sizeof(*dict->records) +
+	    hdr.strings_size != hdr.payload_size || !hdr.strings_size) {
+		fprintf(stderr, "Error: ldc file %s is corrupted\n",
+			config->ldc_file);
+		return -EINVAL;
 	}
-	entry.text = (char *)malloc(entry.header.text_len);
-	if (entry.text == NULL) {
-		fprintf(stderr, "error: can't allocate %d byte for "
-			"entry.text\n", entry.header.text_len);
-		ret = -ENOMEM;
-		goto out;
+
+	if (hdr.flags & SND_SOF_LOGS_FLAG_ZLIB) {
+		dict->payload = malloc(hdr.payload_size);
+		if (!dict->payload) {
+			fprintf(stderr, "error: can't allocate %u bytes\n",
+				hdr.payload_size);
+			return -ENOMEM;
+		}
+
+		size = hdr.payload_size;
+		if (uncompress(dict->payload, &size, payload,
+			       hdr.stored_size) != Z_OK ||
+		    size != hdr.payload_size) {
+			fprintf(stderr, "Error: can't decompress %s\n",
+				config->ldc_file);
+			return -EINVAL;
+		}
+		payload = dict->payload;
+	} else if (hdr.stored_size != hdr.payload_size) {
+		goto truncated;
 	}
-	ret = fread(entry.text, sizeof(char), entry.header.text_len, config->ldc_fd);
-	if (ret != entry.header.text_len) {
-		ret = -ferror(config->ldc_fd);
-		goto out;
+
+	dict->records = (const struct snd_sof_logs_entry *)payload;
+	dict->strings = (const char *)(dict->records + hdr.entry_count);
+	dict->strings_size = hdr.strings_size;
+
+	/* every string offset within the table is then terminated */
+	if (dict->strings[dict->strings_size - 1]) {
+		fprintf(stderr, "Error: ldc file %s is corrupted\n",
+			config->ldc_file);
+		return -EINVAL;
 	}
 
-	/* fetching entry params from dma dump */
-	if (entry.header.params_num > TRACE_MAX_PARAMS_COUNT) {
-		fprintf(stderr, "Error: Invalid number of parameters. \n");
-		ret = -EINVAL;
-		goto out;
+	dict->record_index = calloc(dict->data_length / LDC_ENTRY_ALIGN + 1,
+				    sizeof(*dict->record_index));
+	if (!dict->record_index) {
+		fprintf(stderr, "error: can't allocate record index\n");
+		return -ENOMEM;
 	}
-	entry.params = (uint32_t *)malloc(sizeof(uint32_t) *
-		entry.header.params_num);
-	if (entry.params == NULL) {
-		fprintf(stderr, "error: can't allocate %d byte for "
-			"entry.params\n", (int)(sizeof(uint32_t) *
-			entry.header.params_num));
-		ret = -ENOMEM;
-		goto out;
+
+	for (i = 0; i < hdr.entry_count; i++) {
+		if (dict->records[i].offset % LDC_ENTRY_ALIGN ||
+		    dict->records[i].offset >= dict->data_length)
+			continue;
+		dict->record_index[dict->records[i].offset /
+				   LDC_ENTRY_ALIGN] = i + 1;
 	}
 
-	if (config->serial_fd < 0) {
-		ret = fread(entry.params, sizeof(uint32_t),
-			    entry.header.params_num, config->in_fd);
-		if (ret != entry.header.params_num) {
-			ret = -ferror(config->in_fd);
-			goto out;
+	return 0;
+
+truncated:
+	fprintf(stderr, "Error: ldc file %s is truncated\n", config->ldc_file);
+	return -EINVAL;
+}
+
+static int dict_load(struct ldc_dict *dict, const struct convert_config *config,
+	const struct snd_sof_logs_header *snd)
+{
+	int fd = fileno(config->ldc_fd);
+	struct stat st;
+	uint8_t *buf;
+	size_t count;
+	int ret;
+
+	memset(dict, 0, sizeof(*dict));
+	dict->base_address = snd->base_address;
+	dict->data_length = snd->data_length;
+	dict->raw_output = config->raw_output;
+	dict->use_colors = config->use_colors;
+	pthread_mutex_init(&dict->lock, NULL);
+
+	if (fstat(fd, &st) || st.st_size < sizeof(*snd)) {
+		fprintf(stderr, "error: can't stat %s\n", config->ldc_file);
+		return -EINVAL;
+	}
+	dict->map_size = st.st_size;
+
+	buf = mmap(NULL, dict->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (buf != MAP_FAILED) {
+		dict->mapped = 1;
+	} else {
+		/* not mappable, read the whole file in one go */
+		buf = malloc(dict->map_size);
+		if (!buf) {
+			fprintf(stderr, "error: can't allocate %zu bytes\n",
+				dict->map_size);
+			return -ENOMEM;
+		}
+		rewind(config->ldc_fd);
+		count = fread(buf, 1, dict->map_size, config->ldc_fd);
+		if (count != dict->map_size) {
+			free(buf);
+			return -EIO;
+		}
+	}
+	dict->map = buf;
+
+	if (!strncmp((const char *)snd->sig, SND_SOF_LOGS_SIG_V2,
+		     SND_SOF_LOGS_SIG_SIZE)) {
+		ret = dict_load_v2(dict, config, snd);
+		if (ret < 0)
+			return ret;
+	} else if ((uint64_t)snd->data_offset + snd->data_length >
+		   dict->map_size) {
+		fprintf(stderr, "Error: ldc file %s is truncated\n",
+			config->ldc_file);
+		return -EINVAL;
+	} else {
+		dict->data = dict->map + snd->data_offset;
+	}
+
+	dict->index = calloc(dict->data_length / LDC_ENTRY_ALIGN + 1,
+			     sizeof(*dict->index));
+	if (!dict->index) {
+		fprintf(stderr, "error: can't allocate entry index\n");
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static void dict_free(struct ldc_dict *dict)
+{
+	struct ldc_name *n;
+	uint32_t i;
+
+	if (dict->index) {
+		for (i = 0; i <= dict->data_length / LDC_ENTRY_ALIGN; i++) {
+			if (!dict->index[i])
+				continue;
+			free(dict->index[i]->fmt);
+			free(dict->index[i]);
+		}
+		free(dict->index);
+	}
+
+	for (i = 0; i < LDC_NAME_HASH_SIZE; i++) {
+		while (dict->names[i]) {
+			n = dict->names[i];
+			dict->names[i] = n->next;
+			free(n);
 		}
+	}
+
+	free(dict->record_index);
+	free(dict->payload);
+
+	if (dict->mapped)
+		munmap((void *)dict->map, dict->map_size);
+	else
+		free((void *)dict->map);
+
+	pthread_mutex_destroy(&dict->lock);
+}
+
+/*
+ * Parse entry at given offset in the entries section. Invalid entries are
+ * not reported here, parallel decode may look them up from records which
+ * turn out to be misaligned.
+ */
+static struct ldc_entry *dict_entry_create(struct ldc_dict *dict,
+	const struct ldc_entry_header *header, const char *file_name,
+	const char *text)
+{
+	struct ldc_entry *entry;
+
+	entry = malloc(sizeof(*entry));
+	if (!entry) {
+		fprintf(stderr, "error: can't allocate entry\n");
+		return NULL;
+	}
+	entry->header = *header;
+	entry->text = text;
+	entry->comp_name = get_component_name(header->component_class);
+	entry->file_name = intern_file_name(dict, file_name);
+	entry->fmt = build_entry_fmt(text, header->params_num,
+				     dict->use_colors, dict->raw_output);
+	if (!entry->file_name || !entry->fmt) {
+		fprintf(stderr, "error: can't allocate entry format\n");
+		free(entry->fmt);
+		free(entry);
+		return NULL;
+	}
+
+	return entry;
+}
+
+/* v2 entry, built from its record and the string table */
+static struct ldc_entry *dict_parse_v2(struct ldc_dict *dict, uint32_t offset)
+{
+	const struct snd_sof_logs_entry *record;
+	struct ldc_entry_header header;
+	uint32_t idx = dict->record_index[offset / LDC_ENTRY_ALIGN];
+
+	if (!idx)
+		return NULL;
+	record = &dict->records[idx - 1];
+
+	if (record->file_name >= dict->strings_size ||
+	    record->text >= dict->strings_size ||
+	    record->params_num > TRACE_MAX_PARAMS_COUNT)
+		return NULL;
+
+	header.level = record->level;
+	header.component_class = record->component_class;
+	header.has_ids = record->has_ids;
+	header.params_num = record->params_num;
+	header.line_idx = record->line_idx;
+	header.file_name_len = strlen(dict->strings + record->file_name) + 1;
+	header.text_len = strlen(dict->strings + record->text) + 1;
+
+	return dict_entry_create(dict, &header,
+				 dict->strings + record->file_name,
+				 dict->strings + record->text);
+}
+
+static struct ldc_entry *dict_parse(struct ldc_dict *dict, uint32_t offset)
+{
+	const struct ldc_entry_header *header;
+	const char *file_name;
+	const char *text;
+
+	if (dict->records)
+		return dict_parse_v2(dict, offset);
+
+	if ((uint64_t)offset + sizeof(*header) > dict->data_length)
+		return NULL;
+	header = (const struct ldc_entry_header *)(dict->data + offset);
+
+	if (header->file_name_len > TRACE_MAX_FILENAME_LEN ||
+	    header->text_len > TRACE_MAX_TEXT_LEN ||
+	    (uint64_t)offset + sizeof(*header) + header->file_name_len +
+	    header->text_len > dict->data_length ||
+	    header->params_num > TRACE_MAX_PARAMS_COUNT)
+		return NULL;
+
+	file_name = (const char *)(header + 1);
+	text = file_name + header->file_name_len;
+
+	/* strings must be terminated within the entry */
+	if (!header->file_name_len || !header->text_len ||
+	    file_name[header->file_name_len - 1] ||
+	    text[header->text_len - 1])
+		return NULL;
+
+	return dict_entry_create(dict, header, file_name, text);
+}
+
+static const struct ldc_entry *dict_lookup(struct ldc_dict *dict,
+	uint32_t address)
+{
+	uint32_t offset = address - dict->base_address;
+	struct ldc_entry **slot;
+	struct ldc_entry *entry;
+
+	if (offset % LDC_ENTRY_ALIGN || offset >= dict->data_length)
+		return NULL;
+
+	slot = &dict->index[offset / LDC_ENTRY_ALIGN];
+	entry = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+	if (entry)
+		return entry;
+
+	/* first use, decoder threads may race to parse it */
+	pthread_mutex_lock(&dict->lock);
+	if (!*slot)
+		__atomic_store_n(slot, dict_parse(dict, offset),
+				 __ATOMIC_RELEASE);
+	entry = *slot;
+	pthread_mutex_unlock(&dict->lock);
+
+	return entry;
+}
+
+static void print_entry(const struct convert_config *config, FILE *out_fd,
+	const struct log_entry_header *dma_log, const struct ldc_entry *entry,
+	const uint32_t *params, uint64_t *last_timestamp)
+{
+	switch (config->format) {
+	case CONVERT_FORMAT_CSV:
+		print_entry_csv(out_fd, dma_log, entry, params, config->clock);
+		break;
+	case CONVERT_FORMAT_BIN:
+		print_entry_bin(out_fd, dma_log, entry, params);
+		break;
+	default:
+		/* delta is relative to the previous record shown */
+		print_entry_params(out_fd, dma_log, entry, params,
+				   *last_timestamp, config->clock,
+				   config->use_colors, config->raw_output);
+		*last_timestamp = dma_log->timestamp;
+		break;
+	}
+}
+
+/* checking if trace address is located in entry section in elf file */
+static int record_valid(const struct snd_sof_logs_header *snd,
+	const struct log_entry_header *dma_log)
+{
+	return dma_log->log_entry_address >= snd->base_address &&
+	       dma_log->log_entry_address <= snd->base_address +
+					     snd->data_length;
+}
+
+static void entry_error(const struct log_entry_header *dma_log)
+{
+	fprintf(stderr, "Error: Invalid log entry 0x%x, wrong ldc file?\n",
+		dma_log->log_entry_address);
+}
+
+static int fetch_entry(const struct convert_config *config,
+	struct ldc_dict *dict, const struct log_entry_header *dma_log,
+	uint64_t *last_timestamp)
+{
+	const struct ldc_entry *entry;
+	uint32_t params[TRACE_MAX_PARAMS_COUNT] = { 0 };
+	int ret;
+
+	entry = dict_lookup(dict, dma_log->log_entry_address);
+	if (!entry) {
+		entry_error(dma_log);
+		return -EINVAL;
+	}
+
+	/* fetching entry params from dma dump */
+	if (config->serial_fd < 0) {
+		ret = fread(params, sizeof(uint32_t),
+			    entry->header.params_num, config->in_fd);
+		if (ret != entry->header.params_num)
+			return -ferror(config->in_fd);
 	} else {
-		size_t size = sizeof(uint32_t) * entry.header.params_num;
+		size_t size = sizeof(uint32_t) * entry->header.params_num;
 		uint8_t *n;
 
-		for (n = (uint8_t *)entry.params; size;
+		for (n = (uint8_t *)params; size;
 		     n += ret, size -= ret) {
 			ret = read(config->serial_fd, n, size);
-			if (ret < 0) {
-				ret = -errno;
-				goto out;
-			}
+			if (ret < 0)
+				return -errno;
 			if (ret != size)
 				fprintf(stderr,
 					"Partial read of %u bytes of %lu.\n",
@@ -283,26 +731,17 @@ static int fetch_entry(const struct convert_config *config,
 		}
 	}
 
-	/* printing entry content */
-	print_entry_params(config->out_fd, dma_log, &entry, *last_timestamp,
-			   config->clock, config->use_colors, config->raw_output);
-	*last_timestamp = dma_log->timestamp;
-
-	/* set f_ldc file position to the beginning */
-	rewind(config->ldc_fd);
-
-	ret = 0;
-out:
-	/* free alocated memory */
-	free(entry.params);
-	free(entry.text);
-	free(entry.file_name);
+	if (!filter_match(&config->filter, dma_log, entry, config->clock))
+		return 0;
 
-	return ret;
+	print_entry(config, config->out_fd, dma_log, entry, params,
+		    last_timestamp);
+	return 0;
 }
 
 static int serial_read(const struct convert_config *config,
-	struct snd_sof_logs_header *snd, uint64_t *last_timestamp)
+	struct snd_sof_logs_header *snd, struct ldc_dict *dict,
+	uint64_t *last_timestamp)
 {
 	struct log_entry_header dma_log;
 	size_t len;
@@ -322,8 +761,7 @@ static int serial_read(const struct convert_config *config,
 	}
 
 	/* Skip all trace_point() values, although this test isn't 100% reliable */
-	while ((dma_log.log_entry_address < snd->base_address) ||
-	       dma_log.log_entry_address > snd->base_address + snd->data_length) {
+	while (!record_valid(snd, &dma_log)) {
 		/*
 		 * 8 characters and a '\n' come from the serial port, append a
 		 * '\0'
@@ -349,24 +787,24 @@ static int serial_read(const struct convert_config *config,
 	}
 
 	/* fetching entry from elf dump */
-	return fetch_entry(config, snd->base_address, snd->data_offset,
-			   &dma_log, last_timestamp);
+	ret = fetch_entry(config, dict, &dma_log, last_timestamp);
+
+	/* serial output is watched live */
+	fflush(config->out_fd);
+	return ret;
 }
 
 static int logger_read(const struct convert_config *config,
-	struct snd_sof_logs_header *snd)
+	struct snd_sof_logs_header *snd, struct ldc_dict *dict)
 {
 	struct log_entry_header dma_log;
 	int ret = 0;
 	uint64_t last_timestamp = 0;
 
-	if (!config->raw_output)
-		print_table_header(config->out_fd);
-
 	if (config->serial_fd >= 0)
 		/* Wait for CTRL-C */
 		for (;;) {
-			ret = serial_read(config, snd, &last_timestamp);
+			ret = serial_read(config, snd, dict, &last_timestamp);
 			if (ret < 0)
 				return ret;
 		}
@@ -376,6 +814,8 @@ static int logger_read(const struct convert_config *config,
 		ret = fread(&dma_log, sizeof(dma_log), 1, config->in_fd);
 		if (!ret) {
 			if (config->trace && !ferror(config->in_fd)) {
+				/* trace is watched live, flush while waiting */
+				fflush(config->out_fd);
 				freopen(NULL, "r", config->in_fd);
 				continue;
 			}
@@ -383,11 +823,7 @@ static int logger_read(const struct convert_config *config,
 			return -ferror(config->in_fd);
 		}
 
-		/* checking if received trace address is located in
-		 * entry section in elf file.
-		 */
-		if ((dma_log.log_entry_address < snd->base_address) ||
-			dma_log.log_entry_address > snd->base_address + snd->data_length) {
+		if (!record_valid(snd, &dma_log)) {
 			/* in case the address is not correct input fd should be
 			 * move forward by one DWORD, not entire struct dma_log
 			 */
@@ -396,17 +832,451 @@ static int logger_read(const struct convert_config *config,
 		}
 
 		/* fetching entry from elf dump */
-		ret = fetch_entry(config, snd->base_address, snd->data_offset,
-				  &dma_log, &last_timestamp);
+		ret = fetch_entry(config, dict, &dma_log, &last_timestamp);
+		if (ret)
+			break;
+	}
+
+	return ret;
+}
+
+/* returns 1 when value was read, 0 when buf ends before it */
+static int get_varint(const uint8_t *buf, size_t size, size_t *pos,
+	uint64_t *value)
+{
+	unsigned int shift = 0;
+	uint8_t byte;
+
+	*value = 0;
+	do {
+		if (*pos >= size)
+			return 0;
+		if (shift > 63)
+			return -EINVAL;
+		byte = buf[(*pos)++];
+		*value |= (uint64_t)(byte & 0x7f) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+
+	return 1;
+}
+
+/*
+ * Decode compact record at the start of buf, see TRACE_COMPACT_START.
+ * Returns record size, 0 when buf ends before the record does or -EINVAL
+ * when buf doesn't start with a valid record. timestamps holds the last
+ * timestamp of each core and is only updated by valid records.
+ */
+static int compact_decode(struct ldc_dict *dict, uint64_t *timestamps,
+	const uint8_t *buf, size_t size, struct log_entry_header *dma_log,
+	const struct ldc_entry **entry, uint32_t *params)
+{
+	uint32_t core = buf[0] & TRACE_COMPACT_CORE_MASK;
+	uint8_t flags = buf[0];
+	uint64_t timestamp;
+	uint64_t id_0 = TRACE_COMPACT_NO_ID;
+	uint64_t id_1 = TRACE_COMPACT_NO_ID;
+	uint64_t value;
+	uint32_t address;
+	size_t pos = 1;
+	uint32_t i;
+	int ret;
+
+	if (!(flags & TRACE_COMPACT_START))
+		return -EINVAL;
+
+	ret = get_varint(buf, size, &pos, &timestamp);
+	if (ret <= 0)
+		return ret;
+	if (!(flags & TRACE_COMPACT_ABS_TS))
+		timestamp += timestamps[core];
+
+	if (flags & TRACE_COMPACT_ADDR) {
+		if (pos + 4 > size)
+			return 0;
+		address = buf[pos] | buf[pos + 1] << 8 | buf[pos + 2] << 16 |
+			  (uint32_t)buf[pos + 3] << 24;
+		pos += 4;
+	} else {
+		if (pos + 2 > size)
+			return 0;
+		address = dict->base_address +
+			  (buf[pos] | buf[pos + 1] << 8) * LDC_ENTRY_ALIGN;
+		pos += 2;
+	}
+
+	*entry = dict_lookup(dict, address);
+	if (!*entry)
+		return -EINVAL;
+
+	if (flags & TRACE_COMPACT_IDS) {
+		ret = get_varint(buf, size, &pos, &id_0);
+		if (ret > 0)
+			ret = get_varint(buf, size, &pos, &id_1);
+		if (ret <= 0)
+			return ret;
+		if (id_0 > TRACE_IDS_MASK || id_1 > TRACE_IDS_MASK)
+			return -EINVAL;
+	}
+
+	memset(params, 0, sizeof(uint32_t) * TRACE_MAX_PARAMS_COUNT);
+	for (i = 0; i < (*entry)->header.params_num; i++) {
+		ret = get_varint(buf, size, &pos, &value);
+		if (ret <= 0)
+			return ret;
+		if (value > UINT32_MAX)
+			return -EINVAL;
+		/* undo zigzag */
+		params[i] = (value >> 1) ^ -(uint32_t)(value & 1);
+	}
+
+	memset(dma_log, 0, sizeof(*dma_log));
+	dma_log->id_0 = id_0;
+	dma_log->id_1 = id_1;
+	dma_log->core_id = core;
+	dma_log->timestamp = timestamp;
+	dma_log->log_entry_address = address;
+	timestamps[core] = timestamp;
+
+	return pos;
+}
+
+/*
+ * Read compact records. Records vary in size and are only padded to whole
+ * words, so input is read into a buffer and padding or garbage is skipped
+ * byte by byte until a valid record shows up.
+ */
+static int logger_read_compact(const struct convert_config *config,
+	struct ldc_dict *dict)
+{
+	uint64_t timestamps[TRACE_COMPACT_CORE_MASK + 1] = { 0 };
+	uint32_t params[TRACE_MAX_PARAMS_COUNT];
+	struct log_entry_header dma_log;
+	const struct ldc_entry *entry;
+	uint8_t buf[LDC_COMPACT_BUF_SIZE];
+	uint64_t last_timestamp = 0;
+	size_t len = 0;
+	size_t pos = 0;
+	size_t count;
+	int ret;
+
+	for (;;) {
+		ret = pos < len ? compact_decode(dict, timestamps, buf + pos,
+						 len - pos, &dma_log, &entry,
+						 params) : 0;
+		if (ret < 0) {
+			pos++;
+			continue;
+		}
+		if (ret > 0) {
+			pos += ret;
+			if (filter_match(&config->filter, &dma_log, entry,
+					 config->clock))
+				print_entry(config, config->out_fd, &dma_log,
+					    entry, params, &last_timestamp);
+			continue;
+		}
+
+		/* partial record, keep it and read more */
+		memmove(buf, buf + pos, len - pos);
+		len -= pos;
+		pos = 0;
+
+		count = fread(buf + len, 1, sizeof(buf) - len, config->in_fd);
+		if (!count) {
+			if (config->trace && !ferror(config->in_fd)) {
+				/* trace is watched live, flush while waiting */
+				fflush(config->out_fd);
+				freopen(NULL, "r", config->in_fd);
+				continue;
+			}
+
+			return -ferror(config->in_fd);
+		}
+		len += count;
+	}
+}
+
+/*
+ * Parallel offline decode. The input file is mapped and split into chunks.
+ * Each chunk is resynchronized the same way logger_read() does it, by
+ * skipping dwords until the entry address is valid, and decoded into its
+ * own memory stream. Chunks are then written out in order.
+ *
+ * A chunk owns all records starting before its end. A chunk lined up with
+ * the sequential decode when the previous chunk ended at or before its first
+ * record, otherwise it is decoded again from where the previous one ended.
+ * The first record shown of each chunk is kept undecoded, so its delta can
+ * be computed against the last record of the previous chunk.
+ */
+struct decode_chunk {
+	size_t first;		/* first valid record or end */
+	size_t end;		/* first record boundary past the chunk */
+	int ret;
+	int done;
+	int has_first;
+	struct log_entry_header error_log;
+	struct log_entry_header first_log;
+	const struct ldc_entry *first_entry;
+	uint32_t first_params[TRACE_MAX_PARAMS_COUNT];
+	uint64_t last_timestamp;
+	char *out;
+	size_t out_size;
+};
+
+struct decode_ctx {
+	const struct convert_config *config;
+	const struct snd_sof_logs_header *snd;
+	struct ldc_dict *dict;
+	const uint8_t *in;
+	size_t in_size;
+	struct decode_chunk *chunks;
+	unsigned int chunk_count;
+	unsigned int next;	/* next chunk to decode */
+	unsigned int merged;	/* chunks already written out */
+	unsigned int window;	/* max chunks decoded ahead of merge */
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+};
+
+static void decode_range(struct decode_ctx *ctx, struct decode_chunk *chunk,
+	size_t pos, size_t stop)
+{
+	const struct convert_config *config = ctx->config;
+	struct log_entry_header dma_log;
+	const struct ldc_entry *entry;
+	uint32_t params[TRACE_MAX_PARAMS_COUNT];
+	size_t size;
+	FILE *out;
+
+	chunk->first = SIZE_MAX;
+	chunk->has_first = 0;
+	chunk->ret = 0;
+
+	out = open_memstream(&chunk->out, &chunk->out_size);
+	if (!out) {
+		chunk->ret = -ENOMEM;
+		chunk->end = pos;
+		return;
+	}
+
+	while (pos < stop) {
+		if (pos + sizeof(dma_log) > ctx->in_size) {
+			pos = ctx->in_size;
+			break;
+		}
+		memcpy(&dma_log, ctx->in + pos, sizeof(dma_log));
+
+		if (!record_valid(ctx->snd, &dma_log)) {
+			pos += sizeof(uint32_t);
+			continue;
+		}
+		if (chunk->first == SIZE_MAX)
+			chunk->first = pos;
+
+		entry = dict_lookup(ctx->dict, dma_log.log_entry_address);
+		if (!entry) {
+			chunk->error_log = dma_log;
+			chunk->ret = -EINVAL;
+			break;
+		}
+
+		/* truncated record ends the dump */
+		size = sizeof(uint32_t) * entry->header.params_num;
+		if (pos + sizeof(dma_log) + size > ctx->in_size) {
+			pos = ctx->in_size;
+			break;
+		}
+		memset(params, 0, sizeof(params));
+		memcpy(params, ctx->in + pos + sizeof(dma_log), size);
+		pos += sizeof(dma_log) + size;
+
+		if (!filter_match(&config->filter, &dma_log, entry,
+				  config->clock))
+			continue;
+
+		if (!chunk->has_first) {
+			chunk->has_first = 1;
+			chunk->first_log = dma_log;
+			chunk->first_entry = entry;
+			memcpy(chunk->first_params, params, sizeof(params));
+			chunk->last_timestamp = dma_log.timestamp;
+			continue;
+		}
+
+		print_entry(config, out, &dma_log, entry, params,
+			    &chunk->last_timestamp);
+	}
+
+	if (chunk->first == SIZE_MAX)
+		chunk->first = pos;
+	chunk->end = pos;
+
+	fclose(out);
+}
+
+static size_t chunk_start(const struct decode_ctx *ctx, unsigned int i)
+{
+	return (size_t)i * DECODE_CHUNK_SIZE;
+}
+
+static size_t chunk_stop(const struct decode_ctx *ctx, unsigned int i)
+{
+	size_t stop = chunk_start(ctx, i + 1);
+
+	return stop < ctx->in_size ? stop : ctx->in_size;
+}
+
+static void *decode_worker(void *data)
+{
+	struct decode_ctx *ctx = data;
+	struct decode_chunk *chunk;
+	unsigned int i;
+
+	pthread_mutex_lock(&ctx->lock);
+	for (;;) {
+		/* don't run too far ahead of the writer */
+		while (ctx->next < ctx->chunk_count &&
+		       ctx->next >= ctx->merged + ctx->window)
+			pthread_cond_wait(&ctx->cond, &ctx->lock);
+		if (ctx->next >= ctx->chunk_count)
+			break;
+
+		i = ctx->next++;
+		chunk = &ctx->chunks[i];
+		pthread_mutex_unlock(&ctx->lock);
+
+		decode_range(ctx, chunk, chunk_start(ctx, i),
+			     chunk_stop(ctx, i));
+
+		pthread_mutex_lock(&ctx->lock);
+		chunk->done = 1;
+		pthread_cond_broadcast(&ctx->cond);
+	}
+	pthread_mutex_unlock(&ctx->lock);
+
+	return NULL;
+}
+
+static int merge_chunks(struct decode_ctx *ctx)
+{
+	const struct convert_config *config = ctx->config;
+	struct decode_chunk *chunk;
+	uint64_t last_timestamp = 0;
+	size_t end = 0;
+	unsigned int i;
+	int ret = 0;
+
+	for (i = 0; i < ctx->chunk_count && !ret; i++) {
+		chunk = &ctx->chunks[i];
+
+		pthread_mutex_lock(&ctx->lock);
+		while (!chunk->done)
+			pthread_cond_wait(&ctx->cond, &ctx->lock);
+		pthread_mutex_unlock(&ctx->lock);
+
+		/* resynchronized at a different record, decode it again */
+		if (end > chunk->first) {
+			free(chunk->out);
+			decode_range(ctx, chunk, end, chunk_stop(ctx, i));
+		}
+		end = chunk->end;
+		ret = chunk->ret;
+
+		if (chunk->has_first) {
+			print_entry(config, config->out_fd, &chunk->first_log,
+				    chunk->first_entry, chunk->first_params,
+				    &last_timestamp);
+			last_timestamp = chunk->last_timestamp;
+		}
+		fwrite(chunk->out, 1, chunk->out_size, config->out_fd);
+		free(chunk->out);
+		chunk->out = NULL;
+
+		if (ret == -EINVAL)
+			entry_error(&chunk->error_log);
+
+		pthread_mutex_lock(&ctx->lock);
+		ctx->merged++;
 		if (ret)
+			ctx->next = ctx->chunk_count;
+		pthread_cond_broadcast(&ctx->cond);
+		pthread_mutex_unlock(&ctx->lock);
+	}
+
+	return ret;
+}
+
+/* returns 1 when input can't be mapped and has to be read sequentially */
+static int logger_read_parallel(const struct convert_config *config,
+	struct snd_sof_logs_header *snd, struct ldc_dict *dict)
+{
+	struct decode_ctx ctx;
+	pthread_t *threads;
+	struct stat st;
+	void *in;
+	unsigned int i;
+	int ret;
+
+	if (fstat(fileno(config->in_fd), &st) || !S_ISREG(st.st_mode) ||
+	    !st.st_size)
+		return 1;
+
+	in = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+		  fileno(config->in_fd), 0);
+	if (in == MAP_FAILED)
+		return 1;
+
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.config = config;
+	ctx.snd = snd;
+	ctx.dict = dict;
+	ctx.in = in;
+	ctx.in_size = st.st_size;
+	ctx.chunk_count = CEIL(ctx.in_size, DECODE_CHUNK_SIZE);
+	ctx.window = 2 * config->jobs;
+	pthread_mutex_init(&ctx.lock, NULL);
+	pthread_cond_init(&ctx.cond, NULL);
+
+	ctx.chunks = calloc(ctx.chunk_count, sizeof(*ctx.chunks));
+	threads = calloc(config->jobs, sizeof(*threads));
+	if (!ctx.chunks || !threads) {
+		fprintf(stderr, "error: can't allocate decode chunks\n");
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	for (i = 0; i < config->jobs; i++) {
+		ret = pthread_create(&threads[i], NULL, decode_worker, &ctx);
+		if (ret) {
+			fprintf(stderr, "error: can't create thread %d\n", ret);
+			ret = -ret;
 			break;
+		}
 	}
 
+	/* with no workers at all the writer would wait forever */
+	if (i)
+		ret = merge_chunks(&ctx);
+
+	while (i--)
+		pthread_join(threads[i], NULL);
+
+	for (i = 0; i < ctx.chunk_count; i++)
+		free(ctx.chunks[i].out);
+
+out:
+	free(threads);
+	free(ctx.chunks);
+	pthread_cond_destroy(&ctx.cond);
+	pthread_mutex_destroy(&ctx.lock);
+	munmap(in, st.st_size);
 	return ret;
 }
 
 int convert(const struct convert_config *config) {
 	struct snd_sof_logs_header snd;
+	struct ldc_dict dict;
 	int count, ret = 0;
 
 	count = fread(&snd, sizeof(snd), 1, config->ldc_fd);
@@ -415,7 +1285,10 @@ int convert(const struct convert_config *config) {
 		return -ferror(config->ldc_fd);
 	}
 
-	if (strncmp((char *) snd.sig, SND_SOF_LOGS_SIG, SND_SOF_LOGS_SIG_SIZE)) {
+	if (strncmp((char *)snd.sig, SND_SOF_LOGS_SIG,
+		    SND_SOF_LOGS_SIG_SIZE) &&
+	    strncmp((char *)snd.sig, SND_SOF_LOGS_SIG_V2,
+		    SND_SOF_LOGS_SIG_SIZE)) {
 		fprintf(stderr, "Error: Invalid ldc file signature. \n");
 		return -EINVAL;
 	}
@@ -471,5 +1344,227 @@ int convert(const struct convert_config *config) {
 				SOF_ABI_VERSION_PATCH(snd.version.abi_version));
 		return -EINVAL;
 	}
-	return logger_read(config, &snd);
+
+	ret = dict_load(&dict, config, &snd);
+	if (ret == 0) {
+		/* buffer the output unless somebody watches it live */
+		if (!config->trace && config->serial_fd < 0 &&
+		    !isatty(fileno(config->out_fd)))
+			setvbuf(config->out_fd, NULL, _IOFBF, LDC_OUT_BUF_SIZE);
+
+		if (config->format == CONVERT_FORMAT_CSV)
+			fprintf(config->out_fd, "timestamp,core,level,class,"
+				"id_0,id_1,address,params_num,p0,p1,p2,p3\n");
+		else if (config->format == CONVERT_FORMAT_TEXT &&
+			 !config->raw_output)
+			print_table_header(config->out_fd);
+
+		/* offline dumps can be decoded in parallel */
+		ret = 1;
+		if (snd.version.trace_format == SOF_IPC_TRACE_FORMAT_COMPACT &&
+		    !config->etrace && config->serial_fd < 0)
+			ret = logger_read_compact(config, &dict);
+		else if (config->jobs > 1 && !config->trace &&
+			 !config->input_std && config->serial_fd < 0)
+			ret = logger_read_parallel(config, &snd, &dict);
+		if (ret > 0)
+			ret = logger_read(config, &snd, &dict);
+		fflush(config->out_fd);
+	}
+
+	dict_free(&dict);
+	return ret;
+}
+
+static int parse_class(const char *name, uint32_t *class_idx)
+{
+	uint32_t i;
+
+	for (i = 1; i < TRACE_CLASS_COUNT; i++) {
+		if (!strcasecmp(name,
+				get_component_name(i << TRACE_CLASS_SHIFT))) {
+			*class_idx = i;
+			return 0;
+		}
+	}
+
+	return -EINVAL;
+}
+
+static int parse_id(const char *s, int *id)
+{
+	char *end;
+
+	if (!strcmp(s, "*")) {
+		*id = -1;
+		return 0;
+	}
+	*id = strtol(s, &end, 0);
+	return *end || *id < 0 || *id > TRACE_IDS_MASK ? -EINVAL : 0;
+}
+
+/*
+ * Parse filter spec: comma separated list of core=N, level=N, class=NAME,
+ * ids=ID_0.ID_1 (either may be '*'), from=us and to=us. core and class can
+ * be given several times and are ORed, different keys are ANDed.
+ */
+int convert_filter_parse(struct convert_filter *filter, const char *spec)
+{
+	char *buf, *tok, *val, *dot, *save = NULL;
+	uint32_t n;
+	int ret = 0;
+
+	buf = strdup(spec);
+	if (!buf)
+		return -ENOMEM;
+
+	for (tok = strtok_r(buf, ",", &save); tok && !ret;
+	     tok = strtok_r(NULL, ",", &save)) {
+		val = strchr(tok, '=');
+		if (!val) {
+			ret = -EINVAL;
+			break;
+		}
+		*val++ = '\0';
+
+		if (!strcmp(tok, "core")) {
+			n = strtoul(val, NULL, 0);
+			if (n >= 32)
+				ret = -EINVAL;
+			else
+				filter->core_mask |= 1u << n;
+		} else if (!strcmp(tok, "level")) {
+			filter->level = strtoul(val, NULL, 0);
+		} else if (!strcmp(tok, "class")) {
+			ret = parse_class(val, &n);
+			if (!ret)
+				filter->class_mask |= 1u << n;
+		} else if (!strcmp(tok, "ids")) {
+			dot = strchr(val, '.');
+			if (!dot) {
+				ret = -EINVAL;
+				break;
+			}
+			*dot++ = '\0';
+			ret = parse_id(val, &filter->id_0);
+			if (!ret)
+				ret = parse_id(dot, &filter->id_1);
+		} else if (!strcmp(tok, "from")) {
+			filter->time_from = atof(val);
+		} else if (!strcmp(tok, "to")) {
+			filter->time_to = atof(val);
+		} else {
+			ret = -EINVAL;
+		}
+
+		if (ret)
+			fprintf(stderr, "error: invalid filter %s=%s\n",
+				tok, val);
+	}
+
+	free(buf);
+	return ret;
+}
+
+#define FILTER_BY_CLASS	SOF_IPC_TRACE_FILTER_ELEM_BY_CLASS
+#define FILTER_BY_PIPE	SOF_IPC_TRACE_FILTER_ELEM_BY_PIPE
+#define FILTER_BY_COMP	SOF_IPC_TRACE_FILTER_ELEM_BY_COMP
+
+static void add_elem(struct sof_ipc_trace_filter_elem *elems, int *count,
+		     uint32_t key, uint32_t value)
+{
+	elems[*count].key = key;
+	elems[*count].value = value;
+	(*count)++;
+}
+
+/*
+ * Parse firmware trace filter spec: ';' separated list of filters, each a
+ * comma separated list of level=N, class=NAME and ids=ID_0.ID_1 (either may
+ * be '*'). Returns number of elems written or negative error code.
+ */
+int convert_trace_filter_parse(const char *spec,
+			       struct sof_ipc_trace_filter_elem *elems,
+			       int max_elems)
+{
+	char *buf, *filter, *tok, *val, *dot, *fsave = NULL, *save = NULL;
+	const char *bad = NULL;
+	uint32_t n;
+	int id_0, id_1;
+	int level;
+	int count = 0;
+	int ret = 0;
+
+	buf = strdup(spec);
+	if (!buf)
+		return -ENOMEM;
+
+	for (filter = strtok_r(buf, ";", &fsave); filter && !ret;
+	     filter = strtok_r(NULL, ";", &fsave)) {
+		bad = filter;
+		if (count >= max_elems) {
+			ret = -E2BIG;
+			break;
+		}
+
+		/* level defaults to verbose, so every filter has one elem */
+		level = count;
+		add_elem(elems, &count, SOF_IPC_TRACE_FILTER_ELEM_SET_LEVEL,
+			 LOG_LEVEL_VERBOSE);
+
+		for (tok = strtok_r(filter, ",", &save); tok && !ret;
+		     tok = strtok_r(NULL, ",", &save)) {
+			bad = tok;
+			val = strchr(tok, '=');
+			if (!val) {
+				ret = -EINVAL;
+				break;
+			}
+			*val++ = '\0';
+
+			if (count + 2 > max_elems) {
+				ret = -E2BIG;
+				break;
+			}
+
+			if (!strcmp(tok, "level")) {
+				elems[level].value = strtoul(val, NULL, 0);
+			} else if (!strcmp(tok, "class")) {
+				ret = parse_class(val, &n);
+				if (ret)
+					break;
+				add_elem(elems, &count, FILTER_BY_CLASS,
+					 n << TRACE_CLASS_SHIFT);
+			} else if (!strcmp(tok, "ids")) {
+				dot = strchr(val, '.');
+				if (!dot) {
+					ret = -EINVAL;
+					break;
+				}
+				*dot++ = '\0';
+				ret = parse_id(val, &id_0);
+				if (!ret)
+					ret = parse_id(dot, &id_1);
+				if (ret)
+					break;
+				if (id_0 >= 0)
+					add_elem(elems, &count, FILTER_BY_PIPE,
+						 id_0);
+				if (id_1 >= 0)
+					add_elem(elems, &count, FILTER_BY_COMP,
+						 id_1);
+			} else {
+				ret = -EINVAL;
+			}
+		}
+
+		if (ret)
+			fprintf(stderr, "error: invalid trace filter %s\n",
+				bad);
+
+		elems[count - 1].key |= SOF_IPC_TRACE_FILTER_ELEM_FIN;
+	}
+
+	free(buf);
+	return ret ? ret : count;
 }
@@ -15,11 +15,56 @@
 #include <stdio.h>
 #include <uapi/user/trace.h>
 #include <uapi/ipc/info.h>
+#include <uapi/ipc/trace.h>
 #include <rimage/file_format.h>
 
 #define KNRM	"\x1B[0m"
 #define KRED	"\x1B[31m"
 
+#define TRACE_MAX_PARAMS_COUNT		4
+
+/* upper limit of offline decode threads */
+#define CONVERT_MAX_JOBS		256
+
+/* output stream formats */
+enum convert_format {
+	CONVERT_FORMAT_TEXT = 0,	/* formatted log lines */
+	CONVERT_FORMAT_CSV,		/* comma separated line per record */
+	CONVERT_FORMAT_BIN,		/* struct convert_bin_record stream */
+};
+
+/*
+ * Record level filter, applied before anything gets formatted.
+ * Zero / negative values mean "don't filter".
+ */
+struct convert_filter {
+	uint32_t core_mask;	/* bit per core */
+	uint32_t level;		/* max log level shown */
+	uint32_t class_mask;	/* bit per (TRACE_CLASS_x >> 24) */
+	int id_0;		/* e.g. pipeline id */
+	int id_1;		/* e.g. component id */
+	double time_from;	/* window start in us */
+	double time_to;		/* window end in us */
+};
+
+/*
+ * Binary output record, native endian, all fields are taken from the dma
+ * trace record and its ldc entry without formatting. Naturally aligned,
+ * 40 bytes.
+ */
+struct convert_bin_record {
+	uint64_t timestamp;		/* in dsp ticks */
+	uint32_t entry_address;		/* address of log entry in ELF */
+	uint32_t component_class;	/* TRACE_CLASS_x */
+	uint16_t id_0;
+	uint16_t id_1;
+	uint8_t core_id;
+	uint8_t level;
+	uint8_t has_ids;
+	uint8_t params_num;
+	uint32_t params[TRACE_MAX_PARAMS_COUNT];	/* unused ones are 0 */
+};
+
 struct convert_config {
 	const char *out_file;
 	const char *in_file;
@@ -36,6 +81,14 @@ struct convert_config {
 	int use_colors;
 	int serial_fd;
 	int raw_output;
+	enum convert_format format;
+	struct convert_filter filter;
+	unsigned int jobs;	/* offline decode threads */
+	int etrace;		/* mailbox trace, never compact */
 };
 
 int convert(const struct convert_config *config);
+int convert_filter_parse(struct convert_filter *filter, const char *spec);
+int convert_trace_filter_parse(const char *spec,
+			       struct sof_ipc_trace_filter_elem *elems,
+			       int max_elems);
@@ -27,6 +27,8 @@
 
 #define ARRAY_SIZE(x) (sizeof(x)/sizeof(x[0]))
 
+#define TRACE_FILTER_ELEMS_MAX	64
+
 static const char *debugfs[] = {
 	"dmac0", "dmac1", "ssp0", "ssp1",
 	"ssp2", "iram", "dram", "shim",
@@ -47,6 +49,15 @@ static void usage(void)
 	fprintf(stdout, "%s:\t -t\t\t\tDisplay trace data\n", APP_NAME);
 	fprintf(stdout, "%s:\t -u baud\t\tInput data from a UART\n", APP_NAME);
 	fprintf(stdout, "%s:\t -r less formatted output for chained log processors\n", APP_NAME);
+	fprintf(stdout, "%s:\t -f filter\t\tShow matching records\n",
+		APP_NAME);
+	fprintf(stdout, "\t\t\t\t\te.g. core=0,class=SRC,ids=1.*,to=1e6\n");
+	fprintf(stdout, "%s:\t -F text|csv|bin\tOutput format\n", APP_NAME);
+	fprintf(stdout, "%s:\t -j jobs\t\tParallel decode, 0 for all CPUs\n",
+		APP_NAME);
+	fprintf(stdout, "%s:\t -T filter\t\tSet firmware trace filter\n",
+		APP_NAME);
+	fprintf(stdout, "\t\t\t\t\te.g. \"level=1;level=2,class=SRC\"\n");
 	exit(0);
 }
 
@@ -107,6 +118,36 @@ static int snapshot(const char *name)
 	return 0;
 }
 
+/* push runtime trace filter to firmware, driver sends it over IPC */
+static int trace_filter_push(const char *spec)
+{
+	const char *path = "/sys/kernel/debug/sof/filter";
+	struct sof_ipc_trace_filter_elem elems[TRACE_FILTER_ELEMS_MAX];
+	FILE *fd;
+	size_t size;
+	int count;
+
+	count = convert_trace_filter_parse(spec, elems, ARRAY_SIZE(elems));
+	if (count < 0)
+		return count;
+
+	fd = fopen(path, "wb");
+	if (!fd) {
+		fprintf(stderr, "error: unable to open %s for writing %d\n",
+			path, errno);
+		return -errno;
+	}
+
+	size = count * sizeof(elems[0]);
+	if (fwrite(elems, 1, size, fd) != size) {
+		fprintf(stderr, "error: unable to write %s %d\n", path, errno);
+		fclose(fd);
+		return -EIO;
+	}
+
+	return fclose(fd) ? -errno : 0;
+}
+
 static int configure_uart(const char *file, unsigned int baud)
 {
 	struct termios tio = {};
@@ -133,6 +174,9 @@ int main(int argc, char *argv[])
 	struct convert_config config;
 	unsigned int baud = 0;
 	const char *snapshot_file = 0;
+	const char *trace_filter = NULL;
+	char *end;
+	long jobs;
 	int opt, ret = 0;
 
 	config.trace = 0;
@@ -151,8 +195,15 @@ int main(int argc, char *argv[])
 	config.use_colors = 1;
 	config.serial_fd = -EINVAL;
 	config.raw_output = 0;
-
-	while ((opt = getopt(argc, argv, "ho:i:l:ps:c:u:tev:r")) != -1) {
+	config.format = CONVERT_FORMAT_TEXT;
+	config.jobs = 1;
+	config.etrace = 0;
+	memset(&config.filter, 0, sizeof(config.filter));
+	config.filter.id_0 = -1;
+	config.filter.id_1 = -1;
+
+	while ((opt = getopt(argc, argv,
+			     "ho:i:l:ps:c:u:tev:rf:F:j:T:")) != -1) {
 		switch (opt) {
 		case 'o':
 			config.out_file = optarg;
@@ -193,6 +244,37 @@ int main(int argc, char *argv[])
 			config.version_fw = 1;
 			config.version_file = optarg;
 			break;
+		case 'f':
+			if (convert_filter_parse(&config.filter, optarg))
+				usage();
+			break;
+		case 'F':
+			if (!strcmp(optarg, "csv"))
+				config.format = CONVERT_FORMAT_CSV;
+			else if (!strcmp(optarg, "bin"))
+				config.format = CONVERT_FORMAT_BIN;
+			else if (!strcmp(optarg, "text"))
+				config.format = CONVERT_FORMAT_TEXT;
+			else
+				usage();
+			break;
+		case 'j':
+			errno = 0;
+			jobs = strtol(optarg, &end, 0);
+			if (errno || end == optarg || *end || jobs < 0 ||
+			    jobs > CONVERT_MAX_JOBS) {
+				fprintf(stderr, "error: invalid job count %s\n",
+					optarg);
+				ret = EINVAL;
+				goto out;
+			}
+			if (!jobs)
+				jobs = sysconf(_SC_NPROCESSORS_ONLN);
+			config.jobs = jobs;
+			break;
+		case 'T':
+			trace_filter = optarg;
+			break;
 		case 'h':
 		default: /* '?' */
 			usage();
@@ -202,6 +284,9 @@ int main(int argc, char *argv[])
 	if (snapshot_file)
 		return baud ? EINVAL : -snapshot(snapshot_file);
 
+	if (trace_filter)
+		return -trace_filter_push(trace_filter);
+
 	if (!config.ldc_file) {
 		fprintf(stderr, "error: Missing ldc file\n");
 		usage();
@@ -226,7 +311,7 @@ int main(int argc, char *argv[])
 	}
 
 	if (config.out_file) {
-		config.out_fd = fopen(config.out_file, "w");
+		config.out_fd = fopen(config.out_file, "wb");
 		if (!config.out_fd) {
 			fprintf(stderr, "error: Unable to open out file %s\n",
 				config.out_file);
@@ -242,8 +327,10 @@ int main(int argc, char *argv[])
 		config.in_file = "/sys/kernel/debug/sof/trace";
 
 	/* default option with no infile is to dump errors/debug data */
-	if (!config.in_file)
+	if (!config.in_file) {
 		config.in_file = "/sys/kernel/debug/sof/etrace";
+		config.etrace = !config.input_std;
+	}
 
 	if (config.input_std) {
 		config.in_fd = stdin;
@@ -262,7 +349,8 @@ int main(int argc, char *argv[])
 			goto out;
 		}
 	}
-	if (isatty(fileno(config.out_fd)) != 1)
+	if (isatty(fileno(config.out_fd)) != 1 ||
+	    config.format != CONVERT_FORMAT_TEXT)
 		config.use_colors = 0;
 
 	ret = -convert(&config);